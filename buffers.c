@@ -0,0 +1,200 @@
+/**
+ * @file       buffers.c
+ * @brief      Implementação do pool de buffers do tamanho de um bloco.
+ *
+ * @author     Allan Custódio Diniz Marques (L33tSh4rk)
+ *
+ * Os buffers são criados em pedaços de BUFFERS_POR_PEDACO e nunca voltam ao sistema
+ * antes do encerramento. Os livres formam uma lista encadeada guardada dentro deles
+ * mesmos (o primeiro ponteiro de cada buffer livre aponta para o próximo), de modo
+ * que obter e devolver custam algumas instruções. Um mutex protege a lista, já que
+ * os buffers podem ser pedidos por várias threads.
+ *
+ * Data de criação: 16 de outubro de 2026
+ * Data de atualização: 16 de outubro de 2026
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "buffers.h"
+
+/*
+ * Nó da lista de livres, sobreposto ao conteúdo de um buffer livre.
+ */
+typedef struct buffer_livre {
+    struct buffer_livre* proximo;
+} buffer_livre;
+
+static uint32_t tamanho_buffer = 0;         // 0 = pool não inicializado
+static char** pedacos = NULL;               // Pedaços alocados, cada um com BUFFERS_POR_PEDACO buffers
+static uint32_t num_pedacos = 0;
+static uint32_t capacidade_pedacos = 0;
+static buffer_livre* livres = NULL;
+static uint32_t em_uso = 0;
+static estatisticas_buffers estatisticas;
+static pthread_mutex_t trava_pool = PTHREAD_MUTEX_INITIALIZER;
+
+
+/*
+ * =================================================================================
+ * Ciclo de Vida
+ * =================================================================================
+ */
+
+/**
+ * @brief Prepara o pool para buffers de `tamanho_bloco` bytes. Nenhum buffer é criado ainda.
+ * @return 0 em sucesso, -1 se o tamanho for inválido.
+ */
+int buffers_inicializar(uint32_t tamanho_bloco) {
+    if (tamanho_bloco < sizeof(buffer_livre)) {
+        fprintf(stderr, "Erro (buffers_inicializar): Tamanho de bloco inválido (%u).\n", tamanho_bloco);
+        return -1;
+    }
+    buffers_finalizar();
+    tamanho_buffer = tamanho_bloco;
+    return 0;
+}
+
+/**
+ * @brief Devolve ao pool todos os buffers ainda emprestados. Chamada ao fim de cada comando.
+ *
+ * Em operação normal nada está emprestado nesse ponto; o que estiver foi esquecido
+ * por algum caminho de erro e é contado em `recuperados`. Só pode ser chamada quando
+ * nenhuma outra thread estiver usando buffers do pool.
+ */
+void buffers_reiniciar(void) {
+    pthread_mutex_lock(&trava_pool);
+    if (em_uso == 0) {
+        pthread_mutex_unlock(&trava_pool);
+        return;
+    }
+
+    estatisticas.recuperados += em_uso;
+    livres = NULL;
+    for (uint32_t p = 0; p < num_pedacos; ++p) {
+        for (uint32_t i = 0; i < BUFFERS_POR_PEDACO; ++i) {
+            buffer_livre* no = (buffer_livre*)(pedacos[p] + (size_t)i * tamanho_buffer);
+            no->proximo = livres;
+            livres = no;
+        }
+    }
+    em_uso = 0;
+    pthread_mutex_unlock(&trava_pool);
+}
+
+/**
+ * @brief Libera toda a memória do pool. Buffers emprestados deixam de ser válidos.
+ */
+void buffers_finalizar(void) {
+    for (uint32_t p = 0; p < num_pedacos; ++p) free(pedacos[p]);
+    free(pedacos);
+    pedacos = NULL;
+    num_pedacos = capacidade_pedacos = 0;
+    livres = NULL;
+    em_uso = 0;
+    estatisticas.total = 0;
+}
+
+
+/*
+ * =================================================================================
+ * Empréstimo de Buffers
+ * =================================================================================
+ */
+
+/**
+ * @brief (Função Auxiliar Estática) Cria mais um pedaço de buffers e os põe na lista de livres.
+ * @return 0 em sucesso, -1 sem memória.
+ */
+static int novo_pedaco(void) {
+    if (num_pedacos == capacidade_pedacos) {
+        uint32_t nova_capacidade = capacidade_pedacos ? capacidade_pedacos * 2 : 8;
+        char** novo = realloc(pedacos, (size_t)nova_capacidade * sizeof(char*));
+        if (!novo) return -1;
+        pedacos = novo;
+        capacidade_pedacos = nova_capacidade;
+    }
+
+    char* pedaco = malloc((size_t)BUFFERS_POR_PEDACO * tamanho_buffer);
+    if (!pedaco) return -1;
+    pedacos[num_pedacos++] = pedaco;
+    estatisticas.alocacoes_sistema++;
+    estatisticas.total += BUFFERS_POR_PEDACO;
+
+    for (uint32_t i = 0; i < BUFFERS_POR_PEDACO; ++i) {
+        buffer_livre* no = (buffer_livre*)(pedaco + (size_t)i * tamanho_buffer);
+        no->proximo = livres;
+        livres = no;
+    }
+    return 0;
+}
+
+/**
+ * @brief Empresta um buffer de um bloco (conteúdo indefinido).
+ *
+ * Deve ser devolvido com `buffer_bloco_devolver`; de todo modo, volta ao pool no
+ * fim do comando.
+ *
+ * @return O buffer, ou NULL se o pool não estiver inicializado ou faltar memória.
+ */
+void* buffer_bloco_obter(void) {
+    if (tamanho_buffer == 0) return NULL;
+
+    pthread_mutex_lock(&trava_pool);
+    if (!livres && novo_pedaco() != 0) {
+        pthread_mutex_unlock(&trava_pool);
+        perror("Erro (buffer_bloco_obter): Falha ao alocar buffers");
+        return NULL;
+    }
+
+    buffer_livre* no = livres;
+    livres = no->proximo;
+    em_uso++;
+    if (em_uso > estatisticas.em_uso_maximo) estatisticas.em_uso_maximo = em_uso;
+    estatisticas.pedidos++;
+    pthread_mutex_unlock(&trava_pool);
+    return no;
+}
+
+/**
+ * @brief Empresta um buffer de um bloco já zerado.
+ */
+void* buffer_bloco_obter_zerado(void) {
+    void* buffer = buffer_bloco_obter();
+    if (buffer) memset(buffer, 0, tamanho_buffer);
+    return buffer;
+}
+
+/**
+ * @brief Devolve ao pool um buffer obtido com `buffer_bloco_obter`. Aceita NULL.
+ */
+void buffer_bloco_devolver(void* buffer) {
+    if (!buffer) return;
+    buffer_livre* no = buffer;
+    pthread_mutex_lock(&trava_pool);
+    no->proximo = livres;
+    livres = no;
+    if (em_uso > 0) em_uso--;
+    pthread_mutex_unlock(&trava_pool);
+}
+
+
+/*
+ * =================================================================================
+ * Instrumentação
+ * =================================================================================
+ */
+
+/**
+ * @brief Copia os contadores atuais do pool.
+ */
+void buffers_obter_estatisticas(estatisticas_buffers* est) {
+    if (!est) return;
+    pthread_mutex_lock(&trava_pool);
+    *est = estatisticas;
+    pthread_mutex_unlock(&trava_pool);
+}
@@ -0,0 +1,54 @@
+/**
+ * @file       buffers.h
+ * @brief      Declaração do pool de buffers do tamanho de um bloco, usados como rascunho pelos comandos.
+ *
+ *  @author     Allan Custódio Diniz Marques (L33tSh4rk)
+ *
+ * Quase toda operação sobre a imagem precisa de um ou dois buffers de um bloco por
+ * chamada (ler um bloco de diretório, uma tabela de ponteiros, um trecho da tabela
+ * de inodes). Em vez de malloc/free a cada chamada, esses buffers saem de um pool:
+ * `buffer_bloco_obter` tira um da lista de livres e `buffer_bloco_devolver` o põe de
+ * volta, sem chamadas ao alocador do sistema depois que o pool aquece.
+ *
+ * O laço principal do shell chama `buffers_reiniciar` ao fim de cada comando, o que
+ * recupera qualquer buffer que um caminho de erro tenha deixado de devolver. Por isso
+ * nada que precise sobreviver ao comando (caches, bitmaps) pode usar o pool.
+ *
+ * Data de criação: 16 de outubro de 2026
+ * Data de atualização: 16 de outubro de 2026
+ *
+ */
+
+#ifndef EXT2_BUFFERS_H
+#define EXT2_BUFFERS_H
+
+#include <stdint.h>
+
+// Buffers criados de uma vez quando o pool fica sem livres.
+#define BUFFERS_POR_PEDACO 16
+
+/*
+ * Contadores do pool (comando 'stats').
+ */
+typedef struct {
+    uint64_t pedidos;               // Chamadas a buffer_bloco_obter atendidas
+    uint64_t alocacoes_sistema;     // Pedaços pedidos ao malloc (cada um com BUFFERS_POR_PEDACO buffers)
+    uint64_t recuperados;           // Buffers não devolvidos, recuperados no fim de um comando
+    uint32_t em_uso_maximo;         // Maior número de buffers em uso ao mesmo tempo
+    uint32_t total;                 // Buffers existentes no pool
+} estatisticas_buffers;
+
+/* Ciclo de vida */
+int buffers_inicializar(uint32_t tamanho_bloco);
+void buffers_reiniciar(void);
+void buffers_finalizar(void);
+
+/* Empréstimo de buffers */
+void* buffer_bloco_obter(void);
+void* buffer_bloco_obter_zerado(void);
+void buffer_bloco_devolver(void* buffer);
+
+/* Instrumentação */
+void buffers_obter_estatisticas(estatisticas_buffers* est);
+
+#endif // EXT2_BUFFERS_H
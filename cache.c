@@ -0,0 +1,1354 @@
+/**
+ * @file       cache.c
+ * @brief      Implementação dos caches de blocos, inodes, entradas de diretório e bitmaps do shell.
+ *
+ * @author     Allan Custódio Diniz Marques (L33tSh4rk)
+ *
+ * Todas as chamadas a ler_bloco/escrever_bloco passam por aqui quando o cache está
+ * ativo. As entradas ficam numa tabela hash (busca por número de bloco) e numa lista
+ * duplamente encadeada em ordem de uso (LRU). Blocos escritos são apenas marcados como
+ * sujos e só chegam à imagem quando são despejados ou numa sincronização explícita.
+ *
+ * O cache de inodes segue a mesma estrutura (hash + LRU), com contagem de referências
+ * para fixar inodes muito usados (raiz e diretório atual) e escrita write-through ou
+ * write-back, conforme escolhido na inicialização.
+ *
+ * O cache de entradas de diretório ("dentries") é uma tabela de mapeamento direto
+ * (pai, nome) -> inode. Resultados negativos (nome inexistente) também são guardados,
+ * com inode 0. As funções que alteram diretórios atualizam ou invalidam as entradas.
+ *
+ * O cache de bitmaps guarda, por grupo, o bitmap de blocos e o de inodes. Eles são
+ * carregados na primeira alocação/liberação do grupo, alterados só em memória e
+ * gravados (um bloco por bitmap sujo) ao fim de cada comando, no 'sync' e na saída.
+ *
+ * Cada cache tem um mutex próprio, de modo que as funções de acesso podem ser
+ * chamadas por várias threads. As de ciclo de vida (inicializar/finalizar) não
+ * travam: são chamadas só na partida e no encerramento do shell. O conteúdo dos
+ * bitmaps devolvidos por `cache_bitmaps_obter` é protegido pela trava do grupo
+ * (travas.h), que os alocadores seguram enquanto os alteram.
+ *
+ * Data de criação: 16 de outubro de 2026
+ * Data de atualização: 16 de outubro de 2026
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "headers.h"
+#include "cache.h"
+#include "io.h"
+
+// Índice usado como "ponteiro nulo" nas listas encadeadas por índice.
+#define SEM_ENTRADA (-1)
+
+/*
+ * Uma entrada do cache. Os dados do bloco ficam no vetor `dados_cache`,
+ * na posição (índice da entrada * tamanho do bloco).
+ */
+typedef struct {
+    uint32_t num_bloco;             // Bloco armazenado nesta entrada
+    int32_t  anterior;              // Vizinho mais recente na lista LRU
+    int32_t  proximo;               // Vizinho menos recente na lista LRU
+    int32_t  proximo_hash;          // Próxima entrada no mesmo balde da tabela hash
+    uint8_t  valido;                // 1 se a entrada contém um bloco
+    uint8_t  sujo;                  // 1 se o bloco foi alterado e ainda não foi gravado
+    uint8_t  lendo;                 // 1 enquanto uma thread lê o bloco do disco (ainda não válido)
+} entrada_cache;
+
+// Estado global do cache (o shell trabalha com uma única imagem por processo).
+static entrada_cache* entradas = NULL;
+static unsigned char* dados_cache = NULL;
+static int32_t* tabela_hash = NULL;
+static uint32_t mascara_hash = 0;
+static uint32_t capacidade_cache = 0;
+static uint32_t tamanho_bloco_cache = 0;
+static int32_t lru_cabeca = SEM_ENTRADA;   // Entrada usada mais recentemente
+static int32_t lru_cauda = SEM_ENTRADA;    // Entrada usada há mais tempo (vítima)
+static estatisticas_cache_blocos estatisticas;
+static uint64_t geracao_blocos = 0;  // Incrementada a cada escrita ou descarte de bloco
+static pthread_mutex_t trava_blocos = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t leitura_concluida = PTHREAD_COND_INITIALIZER; // Sinalizada quando uma entrada deixa de estar 'lendo'
+
+
+/*
+ * =================================================================================
+ * Funções Auxiliares (lista LRU e tabela hash)
+ * =================================================================================
+ */
+
+static inline unsigned char* dados_da_entrada(int32_t idx) {
+    return dados_cache + (size_t)idx * tamanho_bloco_cache;
+}
+
+static inline uint32_t balde_do_bloco(uint32_t num_bloco) {
+    // Hash multiplicativo de Knuth: espalha bem números de bloco consecutivos.
+    return (num_bloco * 2654435761u) & mascara_hash;
+}
+
+static void lru_remover(int32_t idx) {
+    entrada_cache* e = &entradas[idx];
+    if (e->anterior != SEM_ENTRADA) entradas[e->anterior].proximo = e->proximo;
+    else lru_cabeca = e->proximo;
+    if (e->proximo != SEM_ENTRADA) entradas[e->proximo].anterior = e->anterior;
+    else lru_cauda = e->anterior;
+    e->anterior = e->proximo = SEM_ENTRADA;
+}
+
+static void lru_inserir_na_frente(int32_t idx) {
+    entrada_cache* e = &entradas[idx];
+    e->anterior = SEM_ENTRADA;
+    e->proximo = lru_cabeca;
+    if (lru_cabeca != SEM_ENTRADA) entradas[lru_cabeca].anterior = idx;
+    lru_cabeca = idx;
+    if (lru_cauda == SEM_ENTRADA) lru_cauda = idx;
+}
+
+static void lru_inserir_no_fim(int32_t idx) {
+    entrada_cache* e = &entradas[idx];
+    e->proximo = SEM_ENTRADA;
+    e->anterior = lru_cauda;
+    if (lru_cauda != SEM_ENTRADA) entradas[lru_cauda].proximo = idx;
+    lru_cauda = idx;
+    if (lru_cabeca == SEM_ENTRADA) lru_cabeca = idx;
+}
+
+static int32_t hash_buscar(uint32_t num_bloco) {
+    int32_t idx = tabela_hash[balde_do_bloco(num_bloco)];
+    while (idx != SEM_ENTRADA) {
+        if (entradas[idx].num_bloco == num_bloco) return idx;
+        idx = entradas[idx].proximo_hash;
+    }
+    return SEM_ENTRADA;
+}
+
+static void hash_inserir(int32_t idx) {
+    uint32_t balde = balde_do_bloco(entradas[idx].num_bloco);
+    entradas[idx].proximo_hash = tabela_hash[balde];
+    tabela_hash[balde] = idx;
+}
+
+static void hash_remover(int32_t idx) {
+    uint32_t balde = balde_do_bloco(entradas[idx].num_bloco);
+    int32_t* elo = &tabela_hash[balde];
+    while (*elo != SEM_ENTRADA) {
+        if (*elo == idx) {
+            *elo = entradas[idx].proximo_hash;
+            break;
+        }
+        elo = &entradas[*elo].proximo_hash;
+    }
+    entradas[idx].proximo_hash = SEM_ENTRADA;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Grava uma entrada suja no disco e a marca como limpa.
+ * @return 0 em sucesso, -1 em erro.
+ */
+static int gravar_entrada(int fd, const superbloco* sb, int32_t idx) {
+    entrada_cache* e = &entradas[idx];
+    if (!e->valido || !e->sujo) return 0;
+
+    if (escrever_bloco_disco(fd, sb, e->num_bloco, dados_da_entrada(idx)) != 0) {
+        fprintf(stderr, "Erro (cache): Falha ao gravar o bloco %u no disco.\n", e->num_bloco);
+        return -1;
+    }
+    e->sujo = 0;
+    estatisticas.blocos_gravados++;
+    return 0;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Procura o bloco na tabela hash, esperando (com a trava
+ * liberada) enquanto outra thread ainda o lê do disco.
+ * @return O índice da entrada válida, ou SEM_ENTRADA se o bloco não está no cache.
+ */
+static int32_t hash_buscar_esperando(uint32_t num_bloco) {
+    int32_t idx;
+    while ((idx = hash_buscar(num_bloco)) != SEM_ENTRADA && entradas[idx].lendo) {
+        pthread_cond_wait(&leitura_concluida, &trava_blocos);
+    }
+    return idx;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Obtém uma entrada livre para o bloco, despejando a menos recente.
+ *
+ * Se a vítima estiver suja, ela é gravada antes de ser reaproveitada. Entradas que
+ * estão sendo lidas do disco por outra thread nunca são escolhidas.
+ *
+ * @return O índice da entrada (já na frente da LRU e na tabela hash), ou SEM_ENTRADA em erro
+ *         ou se todas as entradas estiverem sendo lidas.
+ */
+static int32_t obter_entrada_para(int fd, const superbloco* sb, uint32_t num_bloco) {
+    int32_t idx = lru_cauda;
+    while (idx != SEM_ENTRADA && entradas[idx].lendo) idx = entradas[idx].anterior;
+    if (idx == SEM_ENTRADA) return SEM_ENTRADA;
+
+    if (entradas[idx].valido) {
+        if (gravar_entrada(fd, sb, idx) != 0) return SEM_ENTRADA;
+        hash_remover(idx);
+        entradas[idx].valido = 0;
+        estatisticas.despejos++;
+    }
+
+    lru_remover(idx);
+    entradas[idx].num_bloco = num_bloco;
+    entradas[idx].sujo = 0;
+    hash_inserir(idx);
+    lru_inserir_na_frente(idx);
+    return idx;
+}
+
+
+/*
+ * =================================================================================
+ * Ciclo de Vida
+ * =================================================================================
+ */
+
+/**
+ * @brief Cria o cache de blocos com a capacidade pedida.
+ *
+ * Uma capacidade 0 mantém o cache desativado: ler_bloco/escrever_bloco passam a
+ * acessar o disco diretamente, como antes.
+ *
+ * @param capacidade Número máximo de blocos mantidos em memória.
+ * @param tamanho_bloco O tamanho do bloco do sistema de arquivos.
+ * @return 0 em sucesso, -1 em erro de alocação.
+ */
+int cache_blocos_inicializar(uint32_t capacidade, uint32_t tamanho_bloco) {
+    cache_blocos_finalizar();
+    if (capacidade == 0) return 0;
+
+    // A tabela hash tem o dobro de baldes da capacidade, arredondado para potência de 2.
+    uint32_t num_baldes = 1;
+    while (num_baldes < capacidade * 2) num_baldes <<= 1;
+
+    entradas = malloc((size_t)capacidade * sizeof(entrada_cache));
+    dados_cache = malloc((size_t)capacidade * tamanho_bloco);
+    tabela_hash = malloc((size_t)num_baldes * sizeof(int32_t));
+    if (!entradas || !dados_cache || !tabela_hash) {
+        perror("Erro (cache_blocos_inicializar): Falha ao alocar memória para o cache");
+        free(entradas); free(dados_cache); free(tabela_hash);
+        entradas = NULL; dados_cache = NULL; tabela_hash = NULL;
+        return -1;
+    }
+
+    capacidade_cache = capacidade;
+    tamanho_bloco_cache = tamanho_bloco;
+    mascara_hash = num_baldes - 1;
+    for (uint32_t i = 0; i < num_baldes; ++i) tabela_hash[i] = SEM_ENTRADA;
+
+    // Todas as entradas começam inválidas e encadeadas na LRU.
+    lru_cabeca = lru_cauda = SEM_ENTRADA;
+    for (uint32_t i = 0; i < capacidade; ++i) {
+        entradas[i].valido = 0;
+        entradas[i].sujo = 0;
+        entradas[i].lendo = 0;
+        entradas[i].proximo_hash = SEM_ENTRADA;
+        lru_inserir_na_frente((int32_t)i);
+    }
+
+    memset(&estatisticas, 0, sizeof(estatisticas));
+    return 0;
+}
+
+/**
+ * @brief Informa se o cache de blocos está em uso.
+ */
+int cache_blocos_ativo(void) {
+    return capacidade_cache > 0;
+}
+
+/**
+ * @brief Libera a memória do cache. Blocos sujos NÃO são gravados; chame
+ * `cache_blocos_sincronizar` antes.
+ */
+void cache_blocos_finalizar(void) {
+    free(entradas);
+    free(dados_cache);
+    free(tabela_hash);
+    entradas = NULL;
+    dados_cache = NULL;
+    tabela_hash = NULL;
+    capacidade_cache = 0;
+    lru_cabeca = lru_cauda = SEM_ENTRADA;
+}
+
+
+/*
+ * =================================================================================
+ * Acesso a Blocos
+ * =================================================================================
+ */
+
+/**
+ * @brief Lê um bloco através do cache, buscando no disco apenas em caso de falta.
+ *
+ * Na falta, a entrada é reservada (marcada como 'lendo') e o disco é lido com o cache
+ * destravado, para que faltas de várias threads aconteçam ao mesmo tempo. Quem pedir
+ * o mesmo bloco nesse meio tempo espera a leitura terminar, em vez de lê-lo de novo.
+ *
+ * @param fd O descritor de arquivo da imagem.
+ * @param sb O superbloco.
+ * @param num_bloco O número do bloco (já validado por ler_bloco).
+ * @param buffer Buffer de destino com pelo menos um bloco de tamanho.
+ * @return 0 em sucesso, -1 em erro.
+ */
+int cache_blocos_ler(int fd, const superbloco* sb, uint32_t num_bloco, void* buffer) {
+    pthread_mutex_lock(&trava_blocos);
+    int32_t idx = hash_buscar_esperando(num_bloco);
+    if (idx != SEM_ENTRADA) {
+        estatisticas.acertos++;
+        lru_remover(idx);
+        lru_inserir_na_frente(idx);
+        memcpy(buffer, dados_da_entrada(idx), tamanho_bloco_cache);
+        pthread_mutex_unlock(&trava_blocos);
+        return 0;
+    }
+
+    estatisticas.faltas++;
+    idx = obter_entrada_para(fd, sb, num_bloco);
+    if (idx == SEM_ENTRADA) {
+        // Não foi possível liberar espaço; lê direto do disco sem armazenar.
+        pthread_mutex_unlock(&trava_blocos);
+        return ler_bloco_disco(fd, sb, num_bloco, buffer);
+    }
+
+    // Enquanto 'lendo', a entrada não é despejada nem alterada por outra thread, então
+    // os seus dados podem ser preenchidos sem a trava.
+    entradas[idx].lendo = 1;
+    pthread_mutex_unlock(&trava_blocos);
+    int status = ler_bloco_disco(fd, sb, num_bloco, dados_da_entrada(idx));
+    if (status == 0) memcpy(buffer, dados_da_entrada(idx), tamanho_bloco_cache);
+
+    pthread_mutex_lock(&trava_blocos);
+    entradas[idx].lendo = 0;
+    if (status == 0) {
+        entradas[idx].valido = 1;
+    } else {
+        // Desfaz a entrada para não deixar lixo no cache; ela volta a ser a próxima vítima.
+        hash_remover(idx);
+        lru_remover(idx);
+        lru_inserir_no_fim(idx);
+        entradas[idx].valido = 0;
+    }
+    pthread_cond_broadcast(&leitura_concluida);
+    pthread_mutex_unlock(&trava_blocos);
+    return status;
+}
+
+/**
+ * @brief Escreve um bloco no cache, adiando a gravação no disco (write-back).
+ *
+ * @param fd O descritor de arquivo da imagem.
+ * @param sb O superbloco.
+ * @param num_bloco O número do bloco (já validado por escrever_bloco).
+ * @param buffer Os dados do bloco inteiro.
+ * @return 0 em sucesso, -1 em erro.
+ */
+int cache_blocos_escrever(int fd, const superbloco* sb, uint32_t num_bloco, const void* buffer) {
+    pthread_mutex_lock(&trava_blocos);
+    // Uma leitura em andamento sobrescreveria os dados novos com os antigos do disco.
+    int32_t idx = hash_buscar_esperando(num_bloco);
+    if (idx != SEM_ENTRADA) {
+        estatisticas.acertos++;
+        lru_remover(idx);
+        lru_inserir_na_frente(idx);
+    } else {
+        // Escrita de bloco inteiro: não é preciso ler o conteúdo antigo do disco.
+        idx = obter_entrada_para(fd, sb, num_bloco);
+        if (idx == SEM_ENTRADA) {
+            int status = escrever_bloco_disco(fd, sb, num_bloco, buffer);
+            geracao_blocos++;
+            pthread_mutex_unlock(&trava_blocos);
+            return status;
+        }
+        entradas[idx].valido = 1;
+    }
+
+    memcpy(dados_da_entrada(idx), buffer, tamanho_bloco_cache);
+    entradas[idx].sujo = 1;
+    geracao_blocos++;
+    pthread_mutex_unlock(&trava_blocos);
+    return 0;
+}
+
+/**
+ * @brief Devolve a geração atual das escritas de blocos, a ser passada a `cache_blocos_preencher`.
+ */
+uint64_t cache_blocos_geracao(void) {
+    pthread_mutex_lock(&trava_blocos);
+    uint64_t geracao = geracao_blocos;
+    pthread_mutex_unlock(&trava_blocos);
+    return geracao;
+}
+
+/**
+ * @brief Guarda no cache, como limpo, um bloco que o chamador acabou de ler do disco.
+ *
+ * Usada por ler_blocos, que lê de uma vez (por fora do cache) os blocos que faltam.
+ * Se o bloco já estiver no cache, a cópia do cache prevalece (pode estar suja) e é
+ * copiada para `buffer`. Se algum bloco foi escrito desde `geracao` (obtida antes da
+ * leitura) e este não está no cache, a cópia lida pode ser anterior à escrita: nada
+ * é guardado e o chamador deve ler o bloco de novo.
+ *
+ * @param fd O descritor de arquivo da imagem.
+ * @param sb O superbloco.
+ * @param num_bloco O número do bloco.
+ * @param buffer O conteúdo do bloco, tal como foi lido do disco.
+ * @param geracao O valor de `cache_blocos_geracao()` antes da leitura.
+ * @return 0 em sucesso, 1 se o bloco precisa ser lido de novo, -1 se não houver entrada disponível.
+ */
+int cache_blocos_preencher(int fd, const superbloco* sb, uint32_t num_bloco, void* buffer, uint64_t geracao) {
+    if (!cache_blocos_ativo()) return 0;
+
+    int status = 0;
+    pthread_mutex_lock(&trava_blocos);
+    int32_t idx = hash_buscar_esperando(num_bloco);
+    if (idx != SEM_ENTRADA) {
+        memcpy(buffer, dados_da_entrada(idx), tamanho_bloco_cache);
+    } else if (geracao != geracao_blocos) {
+        status = 1;
+    } else {
+        estatisticas.faltas++;
+        int32_t idx = obter_entrada_para(fd, sb, num_bloco);
+        if (idx == SEM_ENTRADA) {
+            status = -1;
+        } else {
+            memcpy(dados_da_entrada(idx), buffer, tamanho_bloco_cache);
+            entradas[idx].valido = 1;
+        }
+    }
+    pthread_mutex_unlock(&trava_blocos);
+    return status;
+}
+
+/**
+ * @brief Indica se o bloco está no cache (sem alterar a ordem LRU nem os contadores).
+ *
+ * @param num_bloco O número do bloco.
+ * @return 1 se o bloco está no cache, 0 caso contrário (ou se o cache estiver desativado).
+ */
+int cache_blocos_contem(uint32_t num_bloco) {
+    if (!cache_blocos_ativo()) return 0;
+
+    pthread_mutex_lock(&trava_blocos);
+    int contem = hash_buscar(num_bloco) != SEM_ENTRADA;
+    pthread_mutex_unlock(&trava_blocos);
+    return contem;
+}
+
+/**
+ * @brief Descarta do cache (sem gravar) os blocos [num_bloco, num_bloco + quantidade).
+ *
+ * Usada antes de escrever uma sequência de blocos direto na imagem, por fora do
+ * cache: uma cópia antiga (talvez suja) de um desses blocos sobrescreveria os dados
+ * novos no próximo despejo ou sincronização.
+ *
+ * @param num_bloco O primeiro bloco da sequência.
+ * @param quantidade Quantidade de blocos.
+ */
+void cache_blocos_descartar(uint32_t num_bloco, uint32_t quantidade) {
+    if (!cache_blocos_ativo()) return;
+
+    pthread_mutex_lock(&trava_blocos);
+    for (uint32_t i = 0; i < quantidade; ++i) {
+        int32_t idx = hash_buscar_esperando(num_bloco + i);
+        if (idx == SEM_ENTRADA) continue;
+        hash_remover(idx);
+        lru_remover(idx);
+        lru_inserir_no_fim(idx);    // Entrada livre: é a próxima a ser reaproveitada
+        entradas[idx].valido = 0;
+        entradas[idx].sujo = 0;
+    }
+    geracao_blocos++;
+    pthread_mutex_unlock(&trava_blocos);
+}
+
+
+/*
+ * =================================================================================
+ * Sincronização e Instrumentação
+ * =================================================================================
+ */
+
+static int comparar_por_num_bloco(const void* a, const void* b) {
+    uint32_t ba = entradas[*(const int32_t*)a].num_bloco;
+    uint32_t bb = entradas[*(const int32_t*)b].num_bloco;
+    return (ba > bb) - (ba < bb);
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Conclusão da gravação de um bloco sujo em lote.
+ */
+static void ao_gravar_entrada(io_pedido* pedido, void* contexto) {
+    (void)contexto;
+    entrada_cache* e = &entradas[pedido->marcador];
+    if (pedido->resultado != (ssize_t)pedido->tamanho) {
+        fprintf(stderr, "Erro (cache): Falha ao gravar o bloco %u no disco.\n", e->num_bloco);
+        return;
+    }
+    e->sujo = 0;
+    estatisticas.blocos_gravados++;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Corpo de `cache_blocos_sincronizar`, com o cache já travado.
+ */
+static int sincronizar_blocos_sem_trava(int fd, const superbloco* sb) {
+    int32_t* sujos = malloc((size_t)capacidade_cache * sizeof(int32_t));
+    if (!sujos) {
+        perror("Erro (cache_blocos_sincronizar): Falha ao alocar memória");
+        return -1;
+    }
+
+    uint32_t num_sujos = 0;
+    for (uint32_t i = 0; i < capacidade_cache; ++i) {
+        if (entradas[i].valido && entradas[i].sujo) sujos[num_sujos++] = (int32_t)i;
+    }
+    if (num_sujos == 0) {
+        free(sujos);
+        return 0;
+    }
+    qsort(sujos, num_sujos, sizeof(int32_t), comparar_por_num_bloco);
+
+    int status = 0;
+    io_pedido* pedidos = malloc((size_t)num_sujos * sizeof(io_pedido));
+    if (!pedidos) {
+        // Sem memória para o lote: grava um bloco por vez.
+        for (uint32_t i = 0; i < num_sujos; ++i) {
+            if (gravar_entrada(fd, sb, sujos[i]) != 0) status = -1;
+        }
+    } else {
+        for (uint32_t i = 0; i < num_sujos; ++i) {
+            pedidos[i].escrita = 1;
+            pedidos[i].buffer = dados_da_entrada(sujos[i]);
+            pedidos[i].tamanho = tamanho_bloco_cache;
+            pedidos[i].offset = (off_t)entradas[sujos[i]].num_bloco * tamanho_bloco_cache;
+            pedidos[i].marcador = (uint32_t)sujos[i];
+        }
+        status = io_lote_executar(fd, pedidos, num_sujos, ao_gravar_entrada, NULL);
+        free(pedidos);
+    }
+
+    free(sujos);
+    return (status == 0) ? (int)num_sujos : -1;
+}
+
+/**
+ * @brief Grava no disco todos os blocos sujos do cache.
+ *
+ * Os blocos são ordenados por número e enviados juntos como um único lote de
+ * escritas (io_lote_executar), o que transforma as escritas adiadas em um acesso
+ * praticamente sequencial à imagem e, com io_uring, mantém várias delas em voo.
+ *
+ * @return O número de blocos gravados, ou -1 se alguma gravação falhar.
+ */
+int cache_blocos_sincronizar(int fd, const superbloco* sb) {
+    if (!cache_blocos_ativo()) return 0;
+
+    pthread_mutex_lock(&trava_blocos);
+    int resultado = sincronizar_blocos_sem_trava(fd, sb);
+    pthread_mutex_unlock(&trava_blocos);
+    return resultado;
+}
+
+/**
+ * @brief Grava no disco só os blocos sujos do intervalo [primeiro, primeiro + quantidade).
+ *
+ * Chamada antes de leituras que vão direto à imagem (sequências longas, cópia no
+ * kernel), que precisam ver os dados mais novos desses blocos. Os demais blocos
+ * sujos continuam adiados, e os gravados continuam no cache, agora limpos.
+ *
+ * @return O número de blocos gravados, ou -1 se alguma gravação falhar.
+ */
+int cache_blocos_sincronizar_intervalo(int fd, const superbloco* sb, uint32_t primeiro, uint32_t quantidade) {
+    if (!cache_blocos_ativo() || quantidade == 0) return 0;
+
+    int gravados = 0, status = 0;
+    pthread_mutex_lock(&trava_blocos);
+    if (quantidade <= capacidade_cache) {
+        for (uint32_t i = 0; i < quantidade; ++i) {
+            int32_t idx = hash_buscar(primeiro + i);
+            if (idx == SEM_ENTRADA || !entradas[idx].valido || !entradas[idx].sujo) continue;
+            if (gravar_entrada(fd, sb, idx) != 0) status = -1;
+            else gravados++;
+        }
+    } else {
+        // Intervalo maior que o cache: sai mais barato olhar cada entrada uma vez.
+        for (uint32_t i = 0; i < capacidade_cache; ++i) {
+            if (!entradas[i].valido || !entradas[i].sujo || entradas[i].num_bloco - primeiro >= quantidade) continue;
+            if (gravar_entrada(fd, sb, (int32_t)i) != 0) status = -1;
+            else gravados++;
+        }
+    }
+    pthread_mutex_unlock(&trava_blocos);
+    return (status == 0) ? gravados : -1;
+}
+
+/**
+ * @brief Copia os contadores atuais do cache de blocos.
+ */
+void cache_blocos_obter_estatisticas(estatisticas_cache_blocos* est) {
+    if (!est) return;
+    pthread_mutex_lock(&trava_blocos);
+    *est = estatisticas;
+    pthread_mutex_unlock(&trava_blocos);
+}
+
+
+/*
+ * =================================================================================
+ * Cache de Inodes
+ * =================================================================================
+ */
+
+/*
+ * Uma entrada do cache de inodes. Entradas com `referencias` > 0 estão fixadas e
+ * nunca são escolhidas como vítima pelo LRU.
+ */
+typedef struct {
+    inode    dados;                 // Cópia decodificada do inode
+    uint32_t inode_num;             // Número do inode armazenado
+    uint32_t referencias;           // Contagem de fixações (cache_inodes_fixar)
+    int32_t  anterior;              // Vizinho mais recente na lista LRU
+    int32_t  proximo;               // Vizinho menos recente na lista LRU
+    int32_t  proximo_hash;          // Próxima entrada no mesmo balde
+    uint8_t  valido;
+    uint8_t  sujo;                  // Alterado e ainda não gravado (só em write-back)
+} entrada_inode;
+
+static entrada_inode* inodes_cache = NULL;
+static int32_t* hash_inodes = NULL;
+static uint32_t mascara_hash_inodes = 0;
+static uint32_t capacidade_inodes = 0;
+static int modo_write_back_inodes = 0;
+static int32_t lru_inodes_cabeca = SEM_ENTRADA;
+static int32_t lru_inodes_cauda = SEM_ENTRADA;
+static estatisticas_cache_inodes estatisticas_inodes;
+static pthread_mutex_t trava_inodes = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t geracao_inodes = 0;  // Incrementada a cada inode guardado por uma escrita
+
+static inline uint32_t balde_do_inode(uint32_t inode_num) {
+    return (inode_num * 2654435761u) & mascara_hash_inodes;
+}
+
+static void lru_inodes_remover(int32_t idx) {
+    entrada_inode* e = &inodes_cache[idx];
+    if (e->anterior != SEM_ENTRADA) inodes_cache[e->anterior].proximo = e->proximo;
+    else lru_inodes_cabeca = e->proximo;
+    if (e->proximo != SEM_ENTRADA) inodes_cache[e->proximo].anterior = e->anterior;
+    else lru_inodes_cauda = e->anterior;
+    e->anterior = e->proximo = SEM_ENTRADA;
+}
+
+static void lru_inodes_inserir_na_frente(int32_t idx) {
+    entrada_inode* e = &inodes_cache[idx];
+    e->anterior = SEM_ENTRADA;
+    e->proximo = lru_inodes_cabeca;
+    if (lru_inodes_cabeca != SEM_ENTRADA) inodes_cache[lru_inodes_cabeca].anterior = idx;
+    lru_inodes_cabeca = idx;
+    if (lru_inodes_cauda == SEM_ENTRADA) lru_inodes_cauda = idx;
+}
+
+static int32_t hash_inodes_buscar(uint32_t inode_num) {
+    int32_t idx = hash_inodes[balde_do_inode(inode_num)];
+    while (idx != SEM_ENTRADA) {
+        if (inodes_cache[idx].inode_num == inode_num) return idx;
+        idx = inodes_cache[idx].proximo_hash;
+    }
+    return SEM_ENTRADA;
+}
+
+static void hash_inodes_remover(int32_t idx) {
+    int32_t* elo = &hash_inodes[balde_do_inode(inodes_cache[idx].inode_num)];
+    while (*elo != SEM_ENTRADA) {
+        if (*elo == idx) {
+            *elo = inodes_cache[idx].proximo_hash;
+            break;
+        }
+        elo = &inodes_cache[*elo].proximo_hash;
+    }
+    inodes_cache[idx].proximo_hash = SEM_ENTRADA;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Grava um inode sujo no disco e o marca como limpo.
+ * @return 0 em sucesso, -1 em erro.
+ */
+static int gravar_inode(int fd, const superbloco* sb, const group_desc* gdt, int32_t idx) {
+    entrada_inode* e = &inodes_cache[idx];
+    if (!e->valido || !e->sujo) return 0;
+
+    if (escrever_inode_disco(fd, sb, gdt, e->inode_num, &e->dados) != 0) {
+        fprintf(stderr, "Erro (cache): Falha ao gravar o inode %u no disco.\n", e->inode_num);
+        return -1;
+    }
+    e->sujo = 0;
+    estatisticas_inodes.inodes_gravados++;
+    return 0;
+}
+
+/**
+ * @brief Cria o cache de inodes.
+ *
+ * @param capacidade Número máximo de inodes em memória (0 desativa o cache).
+ * @param write_back Se diferente de 0, escrever_inode apenas marca o inode como sujo e
+ * a gravação acontece no despejo ou no 'sync'. Caso contrário, é write-through.
+ * @return 0 em sucesso, -1 em erro de alocação.
+ */
+int cache_inodes_inicializar(uint32_t capacidade, int write_back) {
+    cache_inodes_finalizar();
+    if (capacidade == 0) return 0;
+
+    uint32_t num_baldes = 1;
+    while (num_baldes < capacidade * 2) num_baldes <<= 1;
+
+    inodes_cache = malloc((size_t)capacidade * sizeof(entrada_inode));
+    hash_inodes = malloc((size_t)num_baldes * sizeof(int32_t));
+    if (!inodes_cache || !hash_inodes) {
+        perror("Erro (cache_inodes_inicializar): Falha ao alocar memória para o cache");
+        free(inodes_cache); free(hash_inodes);
+        inodes_cache = NULL; hash_inodes = NULL;
+        return -1;
+    }
+
+    capacidade_inodes = capacidade;
+    modo_write_back_inodes = write_back;
+    mascara_hash_inodes = num_baldes - 1;
+    for (uint32_t i = 0; i < num_baldes; ++i) hash_inodes[i] = SEM_ENTRADA;
+
+    lru_inodes_cabeca = lru_inodes_cauda = SEM_ENTRADA;
+    for (uint32_t i = 0; i < capacidade; ++i) {
+        inodes_cache[i].valido = 0;
+        inodes_cache[i].sujo = 0;
+        inodes_cache[i].referencias = 0;
+        inodes_cache[i].proximo_hash = SEM_ENTRADA;
+        lru_inodes_inserir_na_frente((int32_t)i);
+    }
+
+    memset(&estatisticas_inodes, 0, sizeof(estatisticas_inodes));
+    return 0;
+}
+
+/**
+ * @brief Informa se o cache de inodes está em uso.
+ */
+int cache_inodes_ativo(void) {
+    return capacidade_inodes > 0;
+}
+
+/**
+ * @brief Informa se o cache de inodes está em modo write-back.
+ */
+int cache_inodes_write_back(void) {
+    return cache_inodes_ativo() && modo_write_back_inodes;
+}
+
+/**
+ * @brief Libera a memória do cache de inodes. Inodes sujos NÃO são gravados;
+ * chame `cache_inodes_sincronizar` antes.
+ */
+void cache_inodes_finalizar(void) {
+    free(inodes_cache);
+    free(hash_inodes);
+    inodes_cache = NULL;
+    hash_inodes = NULL;
+    capacidade_inodes = 0;
+    lru_inodes_cabeca = lru_inodes_cauda = SEM_ENTRADA;
+}
+
+/**
+ * @brief Procura um inode no cache.
+ *
+ * @param inode_num O número do inode.
+ * @param inode_out Recebe uma cópia do inode em caso de acerto.
+ * @return 1 em caso de acerto, 0 em caso de falta.
+ */
+int cache_inodes_buscar(uint32_t inode_num, inode* inode_out) {
+    if (!cache_inodes_ativo()) return 0;
+
+    pthread_mutex_lock(&trava_inodes);
+    int32_t idx = hash_inodes_buscar(inode_num);
+    if (idx == SEM_ENTRADA) {
+        estatisticas_inodes.faltas++;
+        pthread_mutex_unlock(&trava_inodes);
+        return 0;
+    }
+
+    estatisticas_inodes.acertos++;
+    lru_inodes_remover(idx);
+    lru_inodes_inserir_na_frente(idx);
+    *inode_out = inodes_cache[idx].dados;
+    pthread_mutex_unlock(&trava_inodes);
+    return 1;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Corpo de `cache_inodes_guardar`, com o cache já travado.
+ */
+static int guardar_inode_sem_trava(int fd, const superbloco* sb, const group_desc* gdt, uint32_t inode_num, const inode* ino, int sujo) {
+    int32_t idx = hash_inodes_buscar(inode_num);
+    if (idx == SEM_ENTRADA) {
+        // Procura, a partir da cauda, a entrada menos recente que não esteja fixada.
+        idx = lru_inodes_cauda;
+        while (idx != SEM_ENTRADA && inodes_cache[idx].referencias > 0) {
+            idx = inodes_cache[idx].anterior;
+        }
+        if (idx == SEM_ENTRADA) return -1;
+
+        if (inodes_cache[idx].valido) {
+            if (gravar_inode(fd, sb, gdt, idx) != 0) return -1;
+            hash_inodes_remover(idx);
+            estatisticas_inodes.despejos++;
+        }
+
+        inodes_cache[idx].inode_num = inode_num;
+        inodes_cache[idx].referencias = 0;
+        inodes_cache[idx].sujo = 0;
+        inodes_cache[idx].valido = 1;
+        inodes_cache[idx].proximo_hash = hash_inodes[balde_do_inode(inode_num)];
+        hash_inodes[balde_do_inode(inode_num)] = idx;
+    }
+
+    lru_inodes_remover(idx);
+    lru_inodes_inserir_na_frente(idx);
+    inodes_cache[idx].dados = *ino;
+    if (sujo) {
+        inodes_cache[idx].sujo = 1;
+        estatisticas_inodes.escritas_adiadas++;
+    }
+    return 0;
+}
+
+/**
+ * @brief Guarda (ou atualiza) um inode no cache.
+ *
+ * Se for preciso abrir espaço, o inode menos recente que não esteja fixado é
+ * despejado (e gravado antes, se estiver sujo).
+ *
+ * @param sujo 1 se o inode foi alterado e ainda não está no disco (write-back).
+ * @return 0 em sucesso, -1 se não foi possível guardar (cache cheio de fixados
+ * ou erro ao gravar a vítima). Nesse caso o chamador deve gravar o inode ele mesmo.
+ */
+int cache_inodes_guardar(int fd, const superbloco* sb, const group_desc* gdt, uint32_t inode_num, const inode* ino, int sujo) {
+    if (!cache_inodes_ativo()) return -1;
+
+    pthread_mutex_lock(&trava_inodes);
+    int status = guardar_inode_sem_trava(fd, sb, gdt, inode_num, ino, sujo);
+    geracao_inodes++;
+    pthread_mutex_unlock(&trava_inodes);
+    return status;
+}
+
+/**
+ * @brief Devolve a geração atual das escritas de inodes, a ser passada a `cache_inodes_guardar_lido`.
+ */
+uint64_t cache_inodes_geracao(void) {
+    if (!cache_inodes_ativo()) return 0;
+
+    pthread_mutex_lock(&trava_inodes);
+    uint64_t geracao = geracao_inodes;
+    pthread_mutex_unlock(&trava_inodes);
+    return geracao;
+}
+
+/**
+ * @brief Guarda um inode que o chamador acabou de ler do disco (falta de `ler_inode`).
+ *
+ * A leitura é feita sem a trava do inode, então uma escrita pode ter passado pelo
+ * cache nesse meio-tempo. Se o inode já estiver no cache, a cópia do cache prevalece
+ * e é devolvida em `ino`. Se algum inode foi escrito desde `geracao` (obtida antes da
+ * leitura) e este não está no cache, a cópia lida pode ser anterior à escrita: nada é
+ * guardado e o chamador deve ler o inode de novo.
+ *
+ * @return 0 em sucesso (ou se não coube no cache), 1 se o inode precisa ser lido de novo.
+ */
+int cache_inodes_guardar_lido(int fd, const superbloco* sb, const group_desc* gdt, uint32_t inode_num, inode* ino, uint64_t geracao) {
+    if (!cache_inodes_ativo()) return 0;
+
+    int status = 0;
+    pthread_mutex_lock(&trava_inodes);
+    int32_t idx = hash_inodes_buscar(inode_num);
+    if (idx != SEM_ENTRADA) {
+        *ino = inodes_cache[idx].dados;
+    } else if (geracao != geracao_inodes) {
+        status = 1;
+    } else {
+        // Falhar em guardar no cache (ex: todas as entradas fixadas) não é um erro.
+        guardar_inode_sem_trava(fd, sb, gdt, inode_num, ino, 0);
+    }
+    pthread_mutex_unlock(&trava_inodes);
+    return status;
+}
+
+/**
+ * @brief Fixa um inode no cache, carregando-o se necessário.
+ *
+ * Inodes fixados (ex: a raiz e o diretório de trabalho atual) nunca são despejados.
+ * Cada chamada deve ser balanceada por um `cache_inodes_soltar`.
+ *
+ * @return 0 em sucesso, -1 em erro.
+ */
+int cache_inodes_fixar(int fd, const superbloco* sb, const group_desc* gdt, uint32_t inode_num) {
+    if (!cache_inodes_ativo()) return 0;
+
+    pthread_mutex_lock(&trava_inodes);
+    int32_t idx = hash_inodes_buscar(inode_num);
+    if (idx == SEM_ENTRADA) {
+        // Lê o inode com o cache destravado (a leitura passa pelo cache de blocos) e
+        // confere de novo: outra thread pode tê-lo guardado nesse meio-tempo.
+        estatisticas_inodes.faltas++;
+        pthread_mutex_unlock(&trava_inodes);
+        inode ino;
+        if (ler_inode_disco(fd, sb, gdt, inode_num, &ino) != 0) return -1;
+        pthread_mutex_lock(&trava_inodes);
+        if (hash_inodes_buscar(inode_num) == SEM_ENTRADA &&
+            guardar_inode_sem_trava(fd, sb, gdt, inode_num, &ino, 0) != 0) {
+            pthread_mutex_unlock(&trava_inodes);
+            return -1;
+        }
+        idx = hash_inodes_buscar(inode_num);
+    }
+
+    inodes_cache[idx].referencias++;
+    pthread_mutex_unlock(&trava_inodes);
+    return 0;
+}
+
+/**
+ * @brief Desfaz uma fixação feita por `cache_inodes_fixar`.
+ */
+void cache_inodes_soltar(uint32_t inode_num) {
+    if (!cache_inodes_ativo()) return;
+
+    pthread_mutex_lock(&trava_inodes);
+    int32_t idx = hash_inodes_buscar(inode_num);
+    if (idx != SEM_ENTRADA && inodes_cache[idx].referencias > 0) {
+        inodes_cache[idx].referencias--;
+    }
+    pthread_mutex_unlock(&trava_inodes);
+}
+
+/**
+ * @brief Grava no disco todos os inodes sujos (modo write-back).
+ * @return O número de inodes gravados, ou -1 se alguma gravação falhar.
+ */
+int cache_inodes_sincronizar(int fd, const superbloco* sb, const group_desc* gdt) {
+    if (!cache_inodes_ativo()) return 0;
+
+    int status = 0;
+    int gravados = 0;
+    pthread_mutex_lock(&trava_inodes);
+    for (uint32_t i = 0; i < capacidade_inodes; ++i) {
+        if (!inodes_cache[i].valido || !inodes_cache[i].sujo) continue;
+        if (gravar_inode(fd, sb, gdt, (int32_t)i) != 0) status = -1;
+        else gravados++;
+    }
+    pthread_mutex_unlock(&trava_inodes);
+    return (status == 0) ? gravados : -1;
+}
+
+/**
+ * @brief Copia os contadores atuais do cache de inodes.
+ */
+void cache_inodes_obter_estatisticas(estatisticas_cache_inodes* est) {
+    if (!est) return;
+    pthread_mutex_lock(&trava_inodes);
+    *est = estatisticas_inodes;
+    pthread_mutex_unlock(&trava_inodes);
+}
+
+
+/*
+ * =================================================================================
+ * Cache de Entradas de Diretório
+ * =================================================================================
+ */
+
+/*
+ * Uma entrada do cache de nomes. `inode_filho` == 0 representa um resultado negativo.
+ * Colisões simplesmente sobrescrevem a entrada anterior (mapeamento direto).
+ */
+typedef struct {
+    uint32_t inode_pai;
+    uint32_t inode_filho;
+    uint8_t  nome_len;
+    uint8_t  valido;
+    char     nome[EXT2_NAME_LEN];   // Não terminado em '\0', como no disco
+} entrada_dentry;
+
+static entrada_dentry* dentries = NULL;
+static uint32_t mascara_dentries = 0;
+static estatisticas_cache_dentries estatisticas_dentries;
+static pthread_mutex_t trava_dentries = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief (Função Auxiliar Estática) Hash FNV-1a do par (pai, nome).
+ */
+static uint32_t hash_dentry(uint32_t inode_pai, const char* nome, size_t nome_len) {
+    uint32_t h = 2166136261u;
+    for (int i = 0; i < 4; ++i) {
+        h ^= (inode_pai >> (i * 8)) & 0xFF;
+        h *= 16777619u;
+    }
+    for (size_t i = 0; i < nome_len; ++i) {
+        h ^= (unsigned char)nome[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/**
+ * @brief Cria o cache de entradas de diretório.
+ *
+ * @param capacidade Número aproximado de entradas (arredondado para potência de 2; 0 desativa).
+ * @return 0 em sucesso, -1 em erro de alocação.
+ */
+int cache_dentries_inicializar(uint32_t capacidade) {
+    cache_dentries_finalizar();
+    if (capacidade == 0) return 0;
+
+    uint32_t num_entradas = 1;
+    while (num_entradas < capacidade) num_entradas <<= 1;
+
+    dentries = calloc(num_entradas, sizeof(entrada_dentry));
+    if (!dentries) {
+        perror("Erro (cache_dentries_inicializar): Falha ao alocar memória para o cache");
+        return -1;
+    }
+    mascara_dentries = num_entradas - 1;
+    memset(&estatisticas_dentries, 0, sizeof(estatisticas_dentries));
+    return 0;
+}
+
+/**
+ * @brief Informa se o cache de entradas de diretório está em uso.
+ */
+int cache_dentries_ativo(void) {
+    return dentries != NULL;
+}
+
+/**
+ * @brief Libera a memória do cache de entradas de diretório.
+ */
+void cache_dentries_finalizar(void) {
+    free(dentries);
+    dentries = NULL;
+    mascara_dentries = 0;
+}
+
+/**
+ * @brief Procura o resultado de uma busca anterior de `nome` dentro do diretório `inode_pai`.
+ *
+ * @param inode_filho Recebe o inode encontrado, ou 0 se o cache sabe que o nome não existe.
+ * @return 1 se o cache respondeu (positiva ou negativamente), 0 se é preciso varrer o diretório.
+ */
+int cache_dentries_buscar(uint32_t inode_pai, const char* nome, uint32_t* inode_filho) {
+    if (!dentries) return 0;
+
+    size_t nome_len = strlen(nome);
+    if (nome_len > EXT2_NAME_LEN) return 0;
+
+    pthread_mutex_lock(&trava_dentries);
+    const entrada_dentry* e = &dentries[hash_dentry(inode_pai, nome, nome_len) & mascara_dentries];
+    if (!e->valido || e->inode_pai != inode_pai || e->nome_len != nome_len ||
+        memcmp(e->nome, nome, nome_len) != 0) {
+        estatisticas_dentries.faltas++;
+        pthread_mutex_unlock(&trava_dentries);
+        return 0;
+    }
+
+    estatisticas_dentries.acertos++;
+    if (e->inode_filho == 0) estatisticas_dentries.acertos_negativos++;
+    *inode_filho = e->inode_filho;
+    pthread_mutex_unlock(&trava_dentries);
+    return 1;
+}
+
+/**
+ * @brief Registra que `nome` dentro de `inode_pai` aponta para `inode_filho`
+ * (0 = o nome não existe). Também é usado para invalidar/atualizar um nome
+ * quando o diretório é alterado.
+ */
+void cache_dentries_guardar(uint32_t inode_pai, const char* nome, uint32_t inode_filho) {
+    if (!dentries) return;
+
+    size_t nome_len = strlen(nome);
+    if (nome_len > EXT2_NAME_LEN) return;
+
+    pthread_mutex_lock(&trava_dentries);
+    entrada_dentry* e = &dentries[hash_dentry(inode_pai, nome, nome_len) & mascara_dentries];
+    e->inode_pai = inode_pai;
+    e->inode_filho = inode_filho;
+    e->nome_len = (uint8_t)nome_len;
+    memcpy(e->nome, nome, nome_len);
+    e->valido = 1;
+    pthread_mutex_unlock(&trava_dentries);
+}
+
+/**
+ * @brief Descarta todas as entradas cujo pai é `inode_pai` (ex: o diretório foi removido
+ * e o número do inode pode ser reaproveitado) e as que apontam para ele.
+ */
+void cache_dentries_invalidar_diretorio(uint32_t inode_pai) {
+    if (!dentries) return;
+
+    pthread_mutex_lock(&trava_dentries);
+    for (uint32_t i = 0; i <= mascara_dentries; ++i) {
+        entrada_dentry* e = &dentries[i];
+        if (e->valido && (e->inode_pai == inode_pai || e->inode_filho == inode_pai)) {
+            e->valido = 0;
+            estatisticas_dentries.invalidacoes++;
+        }
+    }
+    pthread_mutex_unlock(&trava_dentries);
+}
+
+/**
+ * @brief Como cache_dentries_invalidar_diretorio, para vários inodes de uma vez (ex: uma
+ * sub-árvore removida): a tabela é percorrida uma única vez.
+ *
+ * @param inodes_ordenados Números dos inodes, em ordem crescente.
+ */
+void cache_dentries_invalidar_inodes(const uint32_t* inodes_ordenados, size_t quantidade) {
+    if (!dentries || quantidade == 0) return;
+
+    pthread_mutex_lock(&trava_dentries);
+    for (uint32_t i = 0; i <= mascara_dentries; ++i) {
+        entrada_dentry* e = &dentries[i];
+        if (e->valido && (bsearch(&e->inode_pai, inodes_ordenados, quantidade, sizeof(uint32_t), comparar_uint32) ||
+                          bsearch(&e->inode_filho, inodes_ordenados, quantidade, sizeof(uint32_t), comparar_uint32))) {
+            e->valido = 0;
+            estatisticas_dentries.invalidacoes++;
+        }
+    }
+    pthread_mutex_unlock(&trava_dentries);
+}
+
+/**
+ * @brief Copia os contadores atuais do cache de entradas de diretório.
+ */
+void cache_dentries_obter_estatisticas(estatisticas_cache_dentries* est) {
+    if (!est) return;
+    pthread_mutex_lock(&trava_dentries);
+    *est = estatisticas_dentries;
+    pthread_mutex_unlock(&trava_dentries);
+}
+
+
+/*
+ * =================================================================================
+ * Cache de Bitmaps
+ * =================================================================================
+ */
+
+// bitmaps[tipo][grupo]: NULL até o primeiro uso. bitmaps_sujos indica o que precisa ir ao disco.
+static unsigned char** bitmaps[2] = { NULL, NULL };
+static uint8_t* bitmaps_sujos[2] = { NULL, NULL };
+static uint32_t num_grupos_bitmaps = 0;
+static estatisticas_cache_bitmaps estatisticas_bitmaps;
+static pthread_mutex_t trava_bitmaps = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief (Função Auxiliar Estática) Cria as tabelas de bitmaps por grupo, no primeiro uso.
+ * @return 0 em sucesso, -1 em erro de alocação.
+ */
+static int preparar_tabelas_bitmaps(const superbloco* sb) {
+    if (bitmaps[0]) return 0;
+
+    uint32_t num_grupos = (sb->blocks_count + sb->blocks_per_group - 1) / sb->blocks_per_group;
+    for (int tipo = 0; tipo < 2; ++tipo) {
+        bitmaps[tipo] = calloc(num_grupos, sizeof(unsigned char*));
+        bitmaps_sujos[tipo] = calloc(num_grupos, sizeof(uint8_t));
+        if (!bitmaps[tipo] || !bitmaps_sujos[tipo]) {
+            perror("Erro (cache_bitmaps): Falha ao alocar as tabelas de bitmaps");
+            cache_bitmaps_finalizar();
+            return -1;
+        }
+    }
+    num_grupos_bitmaps = num_grupos;
+    return 0;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Bloco do disco onde fica o bitmap pedido.
+ */
+static uint32_t bloco_do_bitmap(const group_desc* gdt, uint32_t grupo, tipo_bitmap tipo) {
+    return (tipo == BITMAP_BLOCOS) ? gdt[grupo].block_bitmap : gdt[grupo].inode_bitmap;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Corpo de `cache_bitmaps_obter`, com o cache já travado.
+ */
+static unsigned char* obter_bitmap_sem_trava(int fd, const superbloco* sb, const group_desc* gdt, uint32_t grupo, tipo_bitmap tipo) {
+    if (preparar_tabelas_bitmaps(sb) != 0) return NULL;
+    if (grupo >= num_grupos_bitmaps) {
+        fprintf(stderr, "Erro (cache_bitmaps_obter): Grupo inválido: %u\n", grupo);
+        return NULL;
+    }
+
+    if (!bitmaps[tipo][grupo]) {
+        unsigned char* bitmap = malloc(calcular_tamanho_do_bloco(sb));
+        if (!bitmap) {
+            perror("Erro (cache_bitmaps_obter): Falha ao alocar buffer para o bitmap");
+            return NULL;
+        }
+        if (ler_bloco(fd, sb, bloco_do_bitmap(gdt, grupo, tipo), bitmap) != 0) {
+            free(bitmap);
+            return NULL;
+        }
+        bitmaps[tipo][grupo] = bitmap;
+        estatisticas_bitmaps.carregados++;
+    }
+    return bitmaps[tipo][grupo];
+}
+
+/**
+ * @brief Devolve o bitmap (de blocos ou de inodes) de um grupo, carregando-o se necessário.
+ *
+ * O ponteiro devolvido continua válido até `cache_bitmaps_finalizar`. Quem alterar o
+ * bitmap deve segurar a trava do grupo e chamar `cache_bitmaps_marcar_sujo` para que
+ * ele seja gravado depois.
+ *
+ * @return O bitmap em memória, ou NULL em erro.
+ */
+unsigned char* cache_bitmaps_obter(int fd, const superbloco* sb, const group_desc* gdt, uint32_t grupo, tipo_bitmap tipo) {
+    pthread_mutex_lock(&trava_bitmaps);
+    unsigned char* bitmap = obter_bitmap_sem_trava(fd, sb, gdt, grupo, tipo);
+    pthread_mutex_unlock(&trava_bitmaps);
+    return bitmap;
+}
+
+/**
+ * @brief Marca o bitmap de um grupo como alterado em memória.
+ */
+void cache_bitmaps_marcar_sujo(uint32_t grupo, tipo_bitmap tipo) {
+    pthread_mutex_lock(&trava_bitmaps);
+    if (bitmaps[0] && grupo < num_grupos_bitmaps) {
+        bitmaps_sujos[tipo][grupo] = 1;
+        estatisticas_bitmaps.alteracoes++;
+    }
+    pthread_mutex_unlock(&trava_bitmaps);
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Conclusão da gravação de um bitmap em lote.
+ * O marcador guarda o grupo e, no bit mais alto, o tipo do bitmap.
+ */
+static void ao_gravar_bitmap(io_pedido* pedido, void* contexto) {
+    int* gravados = contexto;
+    uint32_t grupo = pedido->marcador & 0x7FFFFFFFu;
+    tipo_bitmap tipo = (pedido->marcador >> 31) ? BITMAP_INODES : BITMAP_BLOCOS;
+    if (pedido->resultado != (ssize_t)pedido->tamanho) {
+        fprintf(stderr, "Erro (cache): Falha ao gravar o bitmap do grupo %u.\n", grupo);
+        return;
+    }
+    bitmaps_sujos[tipo][grupo] = 0;
+    estatisticas_bitmaps.gravados++;
+    (*gravados)++;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Grava os bitmaps sujos direto na imagem, como um lote.
+ * @return O número de bitmaps gravados; -1 se alguma gravação falhar; -2 sem memória.
+ */
+static int sincronizar_bitmaps_em_lote(int fd, const superbloco* sb, const group_desc* gdt) {
+    io_pedido* pedidos = malloc((size_t)num_grupos_bitmaps * 2 * sizeof(io_pedido));
+    if (!pedidos) return -2;
+
+    uint32_t tamanho_bloco = calcular_tamanho_do_bloco(sb);
+    size_t num_pedidos = 0;
+    for (int tipo = 0; tipo < 2; ++tipo) {
+        for (uint32_t grupo = 0; grupo < num_grupos_bitmaps; ++grupo) {
+            if (!bitmaps_sujos[tipo][grupo]) continue;
+            io_pedido* pedido = &pedidos[num_pedidos++];
+            pedido->escrita = 1;
+            pedido->buffer = bitmaps[tipo][grupo];
+            pedido->tamanho = tamanho_bloco;
+            pedido->offset = (off_t)bloco_do_bitmap(gdt, grupo, (tipo_bitmap)tipo) * tamanho_bloco;
+            pedido->marcador = grupo | ((uint32_t)tipo << 31);
+        }
+    }
+
+    int gravados = 0;
+    int status = io_lote_executar(fd, pedidos, num_pedidos, ao_gravar_bitmap, &gravados);
+    free(pedidos);
+    return (status == 0) ? gravados : -1;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Corpo de `cache_bitmaps_sincronizar`, com o cache já travado.
+ */
+static int sincronizar_bitmaps_sem_trava(int fd, const superbloco* sb, const group_desc* gdt) {
+    if (!bitmaps[0]) return 0;
+
+    // Sem o cache de blocos, os bitmaps vão direto à imagem: todos num único lote.
+    if (!cache_blocos_ativo()) {
+        int gravados = sincronizar_bitmaps_em_lote(fd, sb, gdt);
+        if (gravados != -2) return gravados;
+        // Sem memória para o lote: segue pelo caminho bloco a bloco.
+    }
+
+    int status = 0;
+    int gravados = 0;
+    for (int tipo = 0; tipo < 2; ++tipo) {
+        for (uint32_t grupo = 0; grupo < num_grupos_bitmaps; ++grupo) {
+            if (!bitmaps_sujos[tipo][grupo]) continue;
+            if (escrever_bloco(fd, sb, bloco_do_bitmap(gdt, grupo, (tipo_bitmap)tipo), bitmaps[tipo][grupo]) != 0) {
+                fprintf(stderr, "Erro (cache): Falha ao gravar o bitmap do grupo %u.\n", grupo);
+                status = -1;
+                continue;
+            }
+            bitmaps_sujos[tipo][grupo] = 0;
+            estatisticas_bitmaps.gravados++;
+            gravados++;
+        }
+    }
+    return (status == 0) ? gravados : -1;
+}
+
+/**
+ * @brief Grava os bitmaps sujos (um bloco por bitmap), via escrever_bloco.
+ *
+ * Com o cache de blocos desligado, os bitmaps são enviados juntos num único lote.
+ *
+ * @return O número de bitmaps gravados, ou -1 se alguma gravação falhar.
+ */
+int cache_bitmaps_sincronizar(int fd, const superbloco* sb, const group_desc* gdt) {
+    pthread_mutex_lock(&trava_bitmaps);
+    int resultado = sincronizar_bitmaps_sem_trava(fd, sb, gdt);
+    pthread_mutex_unlock(&trava_bitmaps);
+    return resultado;
+}
+
+/**
+ * @brief Libera todos os bitmaps em memória. Bitmaps sujos NÃO são gravados;
+ * chame `cache_bitmaps_sincronizar` antes.
+ */
+void cache_bitmaps_finalizar(void) {
+    for (int tipo = 0; tipo < 2; ++tipo) {
+        if (bitmaps[tipo]) {
+            for (uint32_t grupo = 0; grupo < num_grupos_bitmaps; ++grupo) free(bitmaps[tipo][grupo]);
+        }
+        free(bitmaps[tipo]);
+        free(bitmaps_sujos[tipo]);
+        bitmaps[tipo] = NULL;
+        bitmaps_sujos[tipo] = NULL;
+    }
+    num_grupos_bitmaps = 0;
+}
+
+/**
+ * @brief Copia os contadores atuais do cache de bitmaps.
+ */
+void cache_bitmaps_obter_estatisticas(estatisticas_cache_bitmaps* est) {
+    if (!est) return;
+    pthread_mutex_lock(&trava_bitmaps);
+    *est = estatisticas_bitmaps;
+    pthread_mutex_unlock(&trava_bitmaps);
+}
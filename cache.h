@@ -0,0 +1,131 @@
+/**
+ * @file       cache.h
+ * @brief      Declaração da API dos caches em memória (blocos, inodes, entradas de diretório e bitmaps).
+ *
+ *  @author     Allan Custódio Diniz Marques (L33tSh4rk)
+ *
+ * O cache fica entre as funções ler_bloco/escrever_bloco (systemOp.c) e a imagem
+ * do disco. Blocos lidos ficam em RAM e escritas são adiadas (write-back) até um
+ * despejo, o comando 'sync' ou o encerramento do shell. Acima dele, o cache de
+ * inodes guarda as estruturas `inode` já decodificadas, indexadas pelo número, e o
+ * cache de entradas de diretório memoriza resultados (positivos e negativos) de
+ * buscas de nomes dentro de diretórios. Os bitmaps de alocação de cada grupo ficam
+ * inteiros em memória e só são gravados nos pontos de sincronização.
+ *
+ * Data de criação: 16 de outubro de 2026
+ * Data de atualização: 16 de outubro de 2026
+ *
+ */
+
+#ifndef EXT2_CACHE_H
+#define EXT2_CACHE_H
+
+#include "headers.h"
+
+// Capacidade padrão do cache de blocos (em blocos) quando o usuário não informa outra.
+#define CACHE_BLOCOS_PADRAO 1024
+
+// Capacidade padrão do cache de inodes (em inodes).
+#define CACHE_INODES_PADRAO 512
+
+// Capacidade padrão do cache de entradas de diretório (pares pai/nome).
+#define CACHE_DENTRIES_PADRAO 4096
+
+/*
+ * Contadores do cache de blocos, úteis para avaliar a taxa de acerto.
+ */
+typedef struct {
+    uint64_t acertos;               // Leituras/escritas atendidas pela RAM
+    uint64_t faltas;                // Leituras que precisaram ir ao disco
+    uint64_t despejos;              // Entradas válidas substituídas pelo LRU
+    uint64_t blocos_gravados;       // Blocos sujos efetivamente escritos no disco
+} estatisticas_cache_blocos;
+
+/*
+ * Contadores do cache de inodes.
+ */
+typedef struct {
+    uint64_t acertos;               // ler_inode atendidos pela RAM
+    uint64_t faltas;                // ler_inode que precisaram ir ao disco
+    uint64_t despejos;              // Entradas válidas substituídas pelo LRU
+    uint64_t escritas_adiadas;      // escrever_inode absorvidos em modo write-back
+    uint64_t inodes_gravados;       // Inodes sujos efetivamente escritos no disco
+} estatisticas_cache_inodes;
+
+/*
+ * Contadores do cache de entradas de diretório (resolução de caminhos).
+ */
+typedef struct {
+    uint64_t acertos;               // Buscas respondidas pelo cache (inclui negativas)
+    uint64_t acertos_negativos;     // Acertos que confirmaram que o nome NÃO existe
+    uint64_t faltas;                // Buscas que precisaram varrer o diretório
+    uint64_t invalidacoes;          // Entradas descartadas por alterações no diretório
+} estatisticas_cache_dentries;
+
+/*
+ * Tipos de bitmap mantidos pelo cache de bitmaps (um de cada por grupo).
+ */
+typedef enum {
+    BITMAP_BLOCOS = 0,
+    BITMAP_INODES = 1
+} tipo_bitmap;
+
+/*
+ * Contadores do cache de bitmaps.
+ */
+typedef struct {
+    uint64_t carregados;            // Bitmaps lidos do disco (uma vez por grupo e tipo)
+    uint64_t alteracoes;            // Alocações/liberações feitas só em memória
+    uint64_t gravados;              // Bitmaps sujos gravados nas sincronizações
+} estatisticas_cache_bitmaps;
+
+/* Ciclo de vida */
+int cache_blocos_inicializar(uint32_t capacidade, uint32_t tamanho_bloco);
+int cache_blocos_ativo(void);
+void cache_blocos_finalizar(void);
+
+/* Acesso a blocos (chamadas por ler_bloco/escrever_bloco) */
+int cache_blocos_ler(int fd, const superbloco* sb, uint32_t num_bloco, void* buffer);
+int cache_blocos_escrever(int fd, const superbloco* sb, uint32_t num_bloco, const void* buffer);
+int cache_blocos_preencher(int fd, const superbloco* sb, uint32_t num_bloco, void* buffer, uint64_t geracao);
+uint64_t cache_blocos_geracao(void);
+int cache_blocos_contem(uint32_t num_bloco);
+void cache_blocos_descartar(uint32_t num_bloco, uint32_t quantidade);
+
+/* Sincronização e instrumentação */
+int cache_blocos_sincronizar(int fd, const superbloco* sb);
+int cache_blocos_sincronizar_intervalo(int fd, const superbloco* sb, uint32_t primeiro, uint32_t quantidade);
+void cache_blocos_obter_estatisticas(estatisticas_cache_blocos* est);
+
+/* Cache de inodes (consultado por ler_inode/escrever_inode) */
+int cache_inodes_inicializar(uint32_t capacidade, int write_back);
+int cache_inodes_ativo(void);
+int cache_inodes_write_back(void);
+void cache_inodes_finalizar(void);
+int cache_inodes_buscar(uint32_t inode_num, inode* inode_out);
+int cache_inodes_guardar(int fd, const superbloco* sb, const group_desc* gdt, uint32_t inode_num, const inode* ino, int sujo);
+int cache_inodes_guardar_lido(int fd, const superbloco* sb, const group_desc* gdt, uint32_t inode_num, inode* ino, uint64_t geracao);
+uint64_t cache_inodes_geracao(void);
+int cache_inodes_fixar(int fd, const superbloco* sb, const group_desc* gdt, uint32_t inode_num);
+void cache_inodes_soltar(uint32_t inode_num);
+int cache_inodes_sincronizar(int fd, const superbloco* sb, const group_desc* gdt);
+void cache_inodes_obter_estatisticas(estatisticas_cache_inodes* est);
+
+/* Cache de entradas de diretório (consultado por procurar_entrada_no_diretorio) */
+int cache_dentries_inicializar(uint32_t capacidade);
+int cache_dentries_ativo(void);
+void cache_dentries_finalizar(void);
+int cache_dentries_buscar(uint32_t inode_pai, const char* nome, uint32_t* inode_filho);
+void cache_dentries_guardar(uint32_t inode_pai, const char* nome, uint32_t inode_filho);
+void cache_dentries_invalidar_diretorio(uint32_t inode_pai);
+void cache_dentries_invalidar_inodes(const uint32_t* inodes_ordenados, size_t quantidade);
+void cache_dentries_obter_estatisticas(estatisticas_cache_dentries* est);
+
+/* Cache de bitmaps de blocos e de inodes (usado pelos alocadores) */
+unsigned char* cache_bitmaps_obter(int fd, const superbloco* sb, const group_desc* gdt, uint32_t grupo, tipo_bitmap tipo);
+void cache_bitmaps_marcar_sujo(uint32_t grupo, tipo_bitmap tipo);
+int cache_bitmaps_sincronizar(int fd, const superbloco* sb, const group_desc* gdt);
+void cache_bitmaps_finalizar(void);
+void cache_bitmaps_obter_estatisticas(estatisticas_cache_bitmaps* est);
+
+#endif // EXT2_CACHE_H
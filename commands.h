@@ -7,8 +7,11 @@
  * Este arquivo serve como a interface entre o main.c e as implementações
  * dos comandos em commands.c, garantindo a consistência das chamadas de função.
  *
+ * Todo comando devolve 0 quando teve sucesso e 1 quando falhou (a mensagem de erro
+ * já foi impressa); os modos -c e -f usam esse valor como status do comando.
+ *
  * Data de criação: 19 de junho de 2025
- * Data de atualização: 6 de julho de 2025
+ * Data de atualização: 16 de outubro de 2026
  *
  */
 
@@ -17,44 +20,92 @@
 
 #include "headers.h"
 
+/*
+ * Estado de uma sessão do shell. A imagem (fd, superbloco e GDT) é compartilhada;
+ * o diretório atual é de cada sessão: a interativa, a de um lote (-c / -f) ou a de
+ * cada cliente conectado ao servidor (--servir).
+ */
+typedef struct {
+    int fd;
+    superbloco* sb;
+    group_desc* gdt;
+    uint32_t num_grupos;
+    uint32_t diretorio_atual_inode;
+    char diretorio_atual_str[1024];
+} sessao_shell;
+
+// Status devolvido por executar_comando para 'exit' e 'quit'.
+#define COMANDO_SAIR (-1)
+
 // --- 'print' ---
-void comando_print_superblock(const superbloco* sb);
-void comando_print_inode(int fd, const superbloco* sb, const group_desc* gdt, char* arg_num_inode);
-void comando_print_groups(const group_desc* gdt, uint32_t num_grupos);
+int comando_print_superblock(const superbloco* sb);
+int comando_print_inode(int fd, const superbloco* sb, const group_desc* gdt, char* arg_num_inode);
+int comando_print_groups(const group_desc* gdt, uint32_t num_grupos);
 
 // --- info ---
-void comando_info(const superbloco* sb, uint32_t num_grupos, char* argumentos);
+int comando_info(const superbloco* sb, uint32_t num_grupos, char* argumentos);
 
 // --- attr ---
-void comando_attr(int fd, const superbloco* sb, const group_desc* gdt, uint32_t inode_dir_atual, char* argumentos);
+int comando_attr(int fd, const superbloco* sb, const group_desc* gdt, uint32_t inode_dir_atual, char* argumentos);
 
 // --- cat ---
-void comando_cat(int fd, const superbloco* sb, const group_desc* gdt, uint32_t inode_dir_atual, char* argumentos);
+int comando_cat(int fd, const superbloco* sb, const group_desc* gdt, uint32_t inode_dir_atual, char* argumentos);
+
+// --- head / tail ---
+int comando_head(int fd, const superbloco* sb, const group_desc* gdt, uint32_t inode_dir_atual, char* argumentos);
+int comando_tail(int fd, const superbloco* sb, const group_desc* gdt, uint32_t inode_dir_atual, char* argumentos);
 
 // --- ls ---
-void comando_ls(int fd, const superbloco* sb, const group_desc* gdt, uint32_t inode_dir_atual, char* argumentos);
+int comando_ls(int fd, const superbloco* sb, const group_desc* gdt, uint32_t inode_dir_atual, char* argumentos);
 
 // --- pwd ---
-void comando_pwd(const char* diretorio_atual_str, char* argumentos);
+int comando_pwd(const char* diretorio_atual_str, char* argumentos);
 
 // --- cd ---
-void comando_cd(int fd, const superbloco* sb, const group_desc* gdt, uint32_t* p_inode_dir_atual, char* diretorio_atual_str, char* argumentos);
+int comando_cd(int fd, const superbloco* sb, const group_desc* gdt, uint32_t* p_inode_dir_atual, char* diretorio_atual_str, char* argumentos);
 
 // --- touch ---
-void comando_touch(int fd, superbloco* sb, group_desc* gdt, uint32_t inode_dir_atual, char* argumentos);
+int comando_touch(int fd, superbloco* sb, group_desc* gdt, uint32_t inode_dir_atual, char* argumentos);
 
 // --- rm ---
-void comando_rm(int fd, superbloco* sb, group_desc* gdt, uint32_t inode_dir_atual, char* argumentos);
+int comando_rm(int fd, superbloco* sb, group_desc* gdt, uint32_t inode_dir_atual, char* argumentos);
 
 // --- mkdir ---
-void comando_mkdir(int fd, superbloco* sb, group_desc* gdt, uint32_t inode_dir_atual, char* argumentos);
+int comando_mkdir(int fd, superbloco* sb, group_desc* gdt, uint32_t inode_dir_atual, char* argumentos);
 
 // --- rmdir ---
-void comando_rmdir(int fd, superbloco* sb, group_desc* gdt, uint32_t inode_dir_atual, char* argumentos);
+int comando_rmdir(int fd, superbloco* sb, group_desc* gdt, uint32_t inode_dir_atual, char* argumentos);
 
 // --- rename ---
-void comando_rename(int fd, const superbloco* sb, const group_desc* gdt, uint32_t inode_dir_atual, char* argumentos);
+int comando_rename(int fd, superbloco* sb, group_desc* gdt, uint32_t inode_dir_atual, char* argumentos);
 
 // --- cp ---
-void comando_cp(int fd, superbloco* sb, group_desc* gdt, uint32_t inode_dir_atual, char* argumentos);
+int comando_cp(int fd, superbloco* sb, group_desc* gdt, uint32_t inode_dir_atual, char* argumentos);
+
+// --- import ---
+int comando_import(int fd, superbloco* sb, group_desc* gdt, uint32_t inode_dir_atual, char* argumentos);
+
+// --- extents ---
+int comando_extents(int fd, const superbloco* sb, const group_desc* gdt, uint32_t inode_dir_atual, char* argumentos);
+
+// --- find / du / tree ---
+int comando_find(int fd, const superbloco* sb, const group_desc* gdt, uint32_t inode_dir_atual, char* argumentos);
+int comando_du(int fd, const superbloco* sb, const group_desc* gdt, uint32_t inode_dir_atual, char* argumentos);
+int comando_tree(int fd, const superbloco* sb, const group_desc* gdt, uint32_t inode_dir_atual, char* argumentos);
+
+// --- sync ---
+int comando_sync(int fd, const superbloco* sb, const group_desc* gdt, char* argumentos);
+
+// --- stats ---
+int comando_stats(char* argumentos);
+
+// --- diretórios atuais das sessões (protegidos de 'rm -r' e 'rmdir') ---
+int sessao_fixar_diretorio(int fd, const superbloco* sb, const group_desc* gdt, uint32_t inode_num);
+void sessao_soltar_diretorio(uint32_t inode_num);
+int sessao_diretorio_em_uso(uint32_t inode_num);
+void sessao_revalidar_diretorio_atual(sessao_shell* s);
+
+// --- despacho ---
+void imprimir_ajuda(void);
+int executar_comando(sessao_shell* s, char* linha);
 #endif
\ No newline at end of file
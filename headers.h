@@ -42,6 +42,12 @@
 #define EXT2_S_IWOTH 00002       // Write by others
 #define EXT2_S_IXOTH 00001       // Execute by others
 
+/* Features e flags usadas pelos índices de diretório (dir_index / htree) */
+#define EXT2_FEATURE_COMPAT_DIR_INDEX 0x0020  // Diretórios podem ter índice hash
+#define EXT2_INDEX_FL                 0x1000  // Flag de inode: diretório indexado por hash
+#define EXT2_FLAGS_SIGNED_HASH        0x0001  // s_flags: hash calculado com char com sinal
+#define EXT2_FLAGS_UNSIGNED_HASH      0x0002  // s_flags: hash calculado com char sem sinal
+
 /* Níveis de revisão */
 #define EXT2_GOOD_OLD_REV 0      // Revisão original
 #define EXT2_DYNAMIC_REV  1      // Revisão dinâmica
@@ -131,8 +137,29 @@ typedef struct {
     char     last_mounted[64];      // Último ponto de montagem
     /* Offset 0xD0 */
     uint32_t algo_bitmap;           // Algoritmos de compressão
+    uint8_t  prealloc_blocks;       // Blocos a pré-alocar para arquivos
+    uint8_t  prealloc_dir_blocks;   // Blocos a pré-alocar para diretórios
+    uint16_t _padding1;             // Alinhamento
+    uint8_t  journal_uuid[16];      // UUID do journal (ext3)
+    uint32_t journal_inum;          // Inode do journal
+    uint32_t journal_dev;           // Dispositivo do journal
+    uint32_t last_orphan;           // Início da lista de inodes órfãos
+    uint32_t hash_seed[4];          // Semente do hash dos índices de diretório (dir_index)
+    uint8_t  def_hash_version;      // Versão de hash padrão dos índices de diretório
+    uint8_t  jnl_backup_type;       // Tipo de cópia do journal em jnl_blocks
+    uint16_t desc_size;             // Tamanho do descritor de grupo (64bit)
+    uint32_t default_mount_opts;    // Opções de montagem padrão
+    uint32_t first_meta_bg;         // Primeiro grupo de meta_bg
+    uint32_t mkfs_time;             // Hora da criação do sistema de arquivos
+    uint32_t jnl_blocks[17];        // Cópia dos blocos do inode do journal
+    uint32_t blocks_count_hi;       // 32 bits superiores de blocks_count (64bit)
+    uint32_t r_blocks_count_hi;     // 32 bits superiores de r_blocks_count
+    uint32_t free_blocks_hi;        // 32 bits superiores de free_blocks_count
+    uint16_t min_extra_isize;       // Bytes extras mínimos em cada inode
+    uint16_t want_extra_isize;      // Bytes extras desejados em cada inode
+    uint32_t flags;                 // Flags diversas (ex: assinatura do hash de diretório)
     
-    // Mantida apenas a parte utilizável da estrutura para o projeto, mas que resolve a imagem com os campos coerentes.
+    // Mantida apenas a parte utilizável da estrutura para o projeto (até s_flags), mas que resolve a imagem com os campos coerentes.
 
 } __attribute__((packed)) superbloco;
 
@@ -208,6 +235,8 @@ void print_groups(const group_desc* gdt, uint32_t num_grupos);
 /* Inodes */
 int ler_inode(int fd, const superbloco* sb, const group_desc* gdt, uint32_t inode_num, inode* inode_out);
 int escrever_inode(int fd, const superbloco* sb, const group_desc* gdt, uint32_t inode_num, const inode* inode_in);
+int ler_inode_disco(int fd, const superbloco* sb, const group_desc* gdt, uint32_t inode_num, inode* inode_out);
+int escrever_inode_disco(int fd, const superbloco* sb, const group_desc* gdt, uint32_t inode_num, const inode* inode_in);
 void print_inode(const inode* ino, uint32_t inode_num);
 uint32_t alocar_inode(int fd, superbloco* sb, group_desc* gdt);
 int liberar_inode(int fd, superbloco* sb, group_desc* gdt, uint32_t inode_num);
@@ -215,10 +244,22 @@ int liberar_inode(int fd, superbloco* sb, group_desc* gdt, uint32_t inode_num);
 /* Funções de Manipulação de Bloco de Dados */
 int ler_bloco(int fd, const superbloco* sb, uint32_t num_bloco, void* buffer);
 int escrever_bloco(int fd, const superbloco* sb, uint32_t num_bloco, const void* buffer);
+const void* ler_bloco_ref(int fd, const superbloco* sb, uint32_t num_bloco, void* buffer_reserva);
+int ler_blocos(int fd, const superbloco* sb, const uint32_t* nums, uint32_t quantidade, void* const* buffers);
+int ler_bloco_disco(int fd, const superbloco* sb, uint32_t num_bloco, void* buffer);
+int escrever_bloco_disco(int fd, const superbloco* sb, uint32_t num_bloco, const void* buffer);
 void imprimir_entradas_de_bloco_dir(const char* buffer, uint32_t tamanho_bloco);
 
 uint32_t alocar_bloco(int fd, superbloco* sb, group_desc* gdt, uint32_t inode_num);
+uint32_t alocar_blocos_contiguos(int fd, superbloco* sb, group_desc* gdt, uint32_t inode_num, uint32_t objetivo, uint32_t desejados, uint32_t* obtidos);
+uint32_t blocos_no_grupo(const superbloco* sb, uint32_t grupo);
 int liberar_bloco(int fd, superbloco* sb, group_desc* gdt, uint32_t num_bloco);
+int liberar_blocos_do_inode(int fd, superbloco* sb, group_desc* gdt, const inode* ino);
+int liberar_em_lote(int fd, superbloco* sb, group_desc* gdt, uint32_t* blocos, size_t num_blocos, uint32_t* inodes, size_t num_inodes);
+int sincronizar_metadados(int fd, const superbloco* sb, const group_desc* gdt);
+uint32_t mapear_bloco_logico(int fd, const superbloco* sb, const inode* ino, uint32_t bloco_logico);
+int definir_bloco_logico(int fd, superbloco* sb, group_desc* gdt, inode* ino, uint32_t inode_num, uint32_t bloco_logico, uint32_t bloco_fisico);
+int definir_blocos_logicos(int fd, superbloco* sb, group_desc* gdt, inode* ino, uint32_t inode_num, uint32_t bloco_logico, uint32_t bloco_fisico, uint32_t quantidade);
 
 
 
@@ -226,6 +267,9 @@ int liberar_bloco(int fd, superbloco* sb, group_desc* gdt, uint32_t num_bloco);
 int bit_esta_setado(const unsigned char* bitmap, int bit_idx);
 void setar_bit(unsigned char* bitmap, int bit_idx);
 void limpar_bit(unsigned char* bitmap, int bit_idx);
+int32_t bitmap_procurar_zero(const unsigned char* bitmap, uint32_t inicio, uint32_t total_bits);
+int32_t bitmap_procurar_sequencia_zeros(const unsigned char* bitmap, uint32_t inicio, uint32_t total_bits, uint32_t quantidade);
+int comparar_uint32(const void* a, const void* b);
 
 /*Imprime a lista de comandos disponíveis no shell */
 void imprimir_ajuda(void);
@@ -235,7 +279,7 @@ int listar_entradas_diretorio(int fd, const superbloco* sb, const inode* dir_ino
 uint32_t procurar_entrada_no_diretorio(int fd, const superbloco* sb, const group_desc* gdt, uint32_t dir_inode_num, const char* nome_procurado);
 uint32_t caminho_para_inode(int fd, const superbloco* sb, const group_desc* gdt, uint32_t inode_dir_atual, const char* caminho);
 int adicionar_entrada_diretorio(int fd, superbloco* sb, group_desc* gdt, inode* inode_pai, uint32_t inode_pai_num, uint32_t inode_filho, const char* nome_filho, uint8_t tipo_arquivo);
-int remover_entrada_diretorio(int fd, superbloco* sb, inode* inode_pai, const char* nome_filho);
+int remover_entrada_diretorio(int fd, superbloco* sb, inode* inode_pai, uint32_t inode_pai_num, const char* nome_filho);
 int diretorio_esta_vazio(int fd, const superbloco* sb, const inode* dir_ino);
 
 /*Formatação*/
@@ -244,7 +288,29 @@ void formatar_tamanho_humano(uint32_t tamanho_bytes, char* buffer, size_t buffer
 void imprimir_formato_attr(const inode* ino);
 
 /* Funções de Conteúdo de Arquivo */
+// Recebe cada trecho do arquivo, em ordem; retornar algo diferente de 0 interrompe a leitura.
+typedef int (*consumidor_conteudo)(const void* dados, size_t tamanho, void* contexto);
+// Contadores das leituras de arquivos por sequências de blocos contíguos.
+typedef struct {
+    uint64_t arquivos;              // Arquivos lidos ('cat', 'cp')
+    uint64_t sequencias;            // Sequências de blocos contíguos encontradas
+    uint64_t blocos;                // Blocos de dados nessas sequências
+    uint64_t leituras;              // Chamadas de leitura/cópia feitas (uma por sequência, salvo as muito longas)
+} estatisticas_leitura_arquivos;
+void obter_estatisticas_leitura_arquivos(estatisticas_leitura_arquivos* est);
+// Contadores de ler_blocos (leitura de vários blocos avulsos de uma vez).
+typedef struct {
+    uint64_t chamadas;              // Chamadas a ler_blocos
+    uint64_t blocos;                // Blocos pedidos
+    uint64_t do_cache;              // Blocos atendidos pelo cache de blocos
+    uint64_t leituras;              // Leituras feitas no disco (uma preadv por sequência de blocos vizinhos)
+} estatisticas_ler_blocos;
+void obter_estatisticas_ler_blocos(estatisticas_ler_blocos* est);
+int ler_arquivo_em_fluxo(int fd, const superbloco* sb, const inode* file_ino, consumidor_conteudo consumidor, void* contexto);
 char* ler_conteudo_arquivo(int fd, const superbloco* sb, const inode* file_ino);
+ssize_t ler_intervalo_arquivo(int fd, const superbloco* sb, const inode* file_ino, uint64_t offset, size_t tamanho, void* buffer);
+int exportar_arquivo_para_host(int fd, const superbloco* sb, const inode* file_ino, int fd_destino);
+int importar_arquivo_do_host(int fd, superbloco* sb, group_desc* gdt, inode* ino, uint32_t inode_num, int fd_origem, uint32_t tamanho);
 
 void imprimir_formato_info(const superbloco* sb, uint32_t num_grupos);
 
@@ -0,0 +1,814 @@
+/**
+ * @file       htree.c
+ * @brief      Implementação da busca e inserção em diretórios indexados por hash (htree).
+ *
+ * @author     Allan Custódio Diniz Marques (L33tSh4rk)
+ *
+ * O formato em disco é o do dir_index do ext3/ext4: o bloco 0 do diretório contém
+ * as entradas "." e ".." seguidas da raiz do índice; nós intermediários são blocos
+ * com uma entrada "vazia" que ocupa o bloco inteiro. As folhas são blocos de
+ * diretório comuns, por isso a varredura linear continua funcionando sobre eles.
+ *
+ * Suportamos até um nível intermediário (o máximo sem a feature largedir). Quando
+ * uma folha enche, ela é dividida ao meio pelo hash, e nós do índice cheios são
+ * divididos (ou a raiz ganha um nível). Só quando a árvore inteira está cheia o
+ * índice é descartado (a flag EXT2_INDEX_FL é removida) e o diretório volta a ser
+ * tratado de forma linear; `e2fsck -D` reconstrói o índice.
+ *
+ * Data de criação: 16 de outubro de 2026
+ * Data de atualização: 16 de outubro de 2026
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "headers.h"
+#include "htree.h"
+#include "buffers.h"
+
+#define TAMANHO_CABECALHO_ENTRADA_DIR 8
+#define DX_MAX_NIVEIS 2                  // Raiz + um nível intermediário
+#define DX_HASH_EOF 0x7FFFFFFFu          // Valor reservado para "fim do diretório"
+#define DX_BLOCO_MASCARA 0x0FFFFFFF      // Os 4 bits superiores de dx_entrada.bloco são reservados
+
+/*
+ * Caminho percorrido da raiz até a folha. Os blocos dos nós ficam em memória para
+ * que uma divisão de folha possa inserir a nova entrada no nó sem relê-lo.
+ */
+typedef struct {
+    char*       blocos[DX_MAX_NIVEIS];    // Conteúdo de cada nó visitado
+    uint32_t    fisicos[DX_MAX_NIVEIS];   // Bloco físico de cada nó
+    dx_entrada* entradas[DX_MAX_NIVEIS];  // Início do vetor de entradas de cada nó
+    uint32_t    posicoes[DX_MAX_NIVEIS];  // Entrada escolhida em cada nó
+    int         niveis;                   // Quantos nós foram visitados
+    int         versao_hash;              // Versão efetiva (já considerando signed/unsigned)
+    uint32_t    semente[4];
+    uint32_t    hash;                     // Hash do nome procurado
+} caminho_dx;
+
+
+/*
+ * =================================================================================
+ * Funções de Hash (idênticas às do ext3/ext4 e do e2fsprogs)
+ * =================================================================================
+ */
+
+#define ROTACIONAR(x, s) (((x) << (s)) | ((x) >> (32 - (s))))
+#define MD4_F(x, y, z) ((z) ^ ((x) & ((y) ^ (z))))
+#define MD4_G(x, y, z) (((x) & (y)) + (((x) ^ (y)) & (z)))
+#define MD4_H(x, y, z) ((x) ^ (y) ^ (z))
+#define MD4_RODADA(f, a, b, c, d, x, s) ((a) += f((b), (c), (d)) + (x), (a) = ROTACIONAR((a), (s)))
+#define MD4_K1 0
+#define MD4_K2 013240474631U
+#define MD4_K3 015666365641U
+
+/**
+ * @brief (Função Auxiliar Estática) Transformação "meio MD4" usada pelo hash half_md4.
+ */
+static void transformacao_half_md4(uint32_t buf[4], const uint32_t in[8]) {
+    uint32_t a = buf[0], b = buf[1], c = buf[2], d = buf[3];
+
+    MD4_RODADA(MD4_F, a, b, c, d, in[0] + MD4_K1,  3);
+    MD4_RODADA(MD4_F, d, a, b, c, in[1] + MD4_K1,  7);
+    MD4_RODADA(MD4_F, c, d, a, b, in[2] + MD4_K1, 11);
+    MD4_RODADA(MD4_F, b, c, d, a, in[3] + MD4_K1, 19);
+    MD4_RODADA(MD4_F, a, b, c, d, in[4] + MD4_K1,  3);
+    MD4_RODADA(MD4_F, d, a, b, c, in[5] + MD4_K1,  7);
+    MD4_RODADA(MD4_F, c, d, a, b, in[6] + MD4_K1, 11);
+    MD4_RODADA(MD4_F, b, c, d, a, in[7] + MD4_K1, 19);
+
+    MD4_RODADA(MD4_G, a, b, c, d, in[1] + MD4_K2,  3);
+    MD4_RODADA(MD4_G, d, a, b, c, in[3] + MD4_K2,  5);
+    MD4_RODADA(MD4_G, c, d, a, b, in[5] + MD4_K2,  9);
+    MD4_RODADA(MD4_G, b, c, d, a, in[7] + MD4_K2, 13);
+    MD4_RODADA(MD4_G, a, b, c, d, in[0] + MD4_K2,  3);
+    MD4_RODADA(MD4_G, d, a, b, c, in[2] + MD4_K2,  5);
+    MD4_RODADA(MD4_G, c, d, a, b, in[4] + MD4_K2,  9);
+    MD4_RODADA(MD4_G, b, c, d, a, in[6] + MD4_K2, 13);
+
+    MD4_RODADA(MD4_H, a, b, c, d, in[3] + MD4_K3,  3);
+    MD4_RODADA(MD4_H, d, a, b, c, in[7] + MD4_K3,  9);
+    MD4_RODADA(MD4_H, c, d, a, b, in[2] + MD4_K3, 11);
+    MD4_RODADA(MD4_H, b, c, d, a, in[6] + MD4_K3, 15);
+    MD4_RODADA(MD4_H, a, b, c, d, in[1] + MD4_K3,  3);
+    MD4_RODADA(MD4_H, d, a, b, c, in[5] + MD4_K3,  9);
+    MD4_RODADA(MD4_H, c, d, a, b, in[0] + MD4_K3, 11);
+    MD4_RODADA(MD4_H, b, c, d, a, in[4] + MD4_K3, 15);
+
+    buf[0] += a;
+    buf[1] += b;
+    buf[2] += c;
+    buf[3] += d;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Transformação TEA usada pelo hash "tea".
+ */
+static void transformacao_tea(uint32_t buf[4], const uint32_t in[4]) {
+    uint32_t soma = 0;
+    uint32_t b0 = buf[0], b1 = buf[1];
+    uint32_t a = in[0], b = in[1], c = in[2], d = in[3];
+
+    for (int n = 0; n < 16; ++n) {
+        soma += 0x9E3779B9;
+        b0 += ((b1 << 4) + a) ^ (b1 + soma) ^ ((b1 >> 5) + b);
+        b1 += ((b0 << 4) + c) ^ (b0 + soma) ^ ((b0 >> 5) + d);
+    }
+
+    buf[0] += b0;
+    buf[1] += b1;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) O hash "legacy" original do dir_index.
+ */
+static uint32_t hash_legado(const char* nome, size_t tamanho, int sem_sinal) {
+    uint32_t hash, hash0 = 0x12a3fe2d, hash1 = 0x37abe8f9;
+
+    for (size_t i = 0; i < tamanho; ++i) {
+        int c = sem_sinal ? (int)(unsigned char)nome[i] : (int)(signed char)nome[i];
+        hash = hash1 + (hash0 ^ (uint32_t)(c * 7152373));
+        if (hash & 0x80000000) hash -= 0x7fffffff;
+        hash1 = hash0;
+        hash0 = hash;
+    }
+    return hash0 << 1;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Empacota até `num` palavras de 32 bits do nome,
+ * completando com um padrão derivado do tamanho (str2hashbuf do ext3).
+ */
+static void nome_para_palavras(const char* nome, size_t tamanho, uint32_t* buf, int num, int sem_sinal) {
+    uint32_t pad = (uint32_t)tamanho | ((uint32_t)tamanho << 8);
+    pad |= pad << 16;
+
+    uint32_t val = pad;
+    if (tamanho > (size_t)num * 4) tamanho = (size_t)num * 4;
+
+    for (size_t i = 0; i < tamanho; ++i) {
+        int c = sem_sinal ? (int)(unsigned char)nome[i] : (int)(signed char)nome[i];
+        val = (uint32_t)c + (val << 8);
+        if ((i % 4) == 3) {
+            *buf++ = val;
+            val = pad;
+            num--;
+        }
+    }
+    if (--num >= 0) *buf++ = val;
+    while (--num >= 0) *buf++ = pad;
+}
+
+/**
+ * @brief Calcula o hash de um nome de arquivo, como o ext3/ext4 faz para o dir_index.
+ *
+ * @param nome O nome (não precisa terminar em '\0').
+ * @param tamanho_nome O tamanho do nome em bytes.
+ * @param versao_hash Uma das constantes DX_HASH_* (incluindo as variantes sem sinal).
+ * @param semente A semente do superbloco (s_hash_seed); toda zero usa a semente padrão.
+ * @return O hash de 32 bits com o bit menos significativo zerado.
+ */
+uint32_t htree_calcular_hash(const char* nome, size_t tamanho_nome, int versao_hash, const uint32_t semente[4]) {
+    uint32_t buf[4] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476 };
+    uint32_t in[8];
+    uint32_t hash = 0;
+
+    if (semente && (semente[0] || semente[1] || semente[2] || semente[3])) {
+        memcpy(buf, semente, sizeof(buf));
+    }
+
+    int sem_sinal = versao_hash >= DX_HASH_LEGACY_UNSIGNED;
+    const char* p = nome;
+    long restante = (long)tamanho_nome;
+
+    switch (versao_hash) {
+        case DX_HASH_LEGACY:
+        case DX_HASH_LEGACY_UNSIGNED:
+            hash = hash_legado(nome, tamanho_nome, sem_sinal);
+            break;
+
+        case DX_HASH_HALF_MD4:
+        case DX_HASH_HALF_MD4_UNSIGNED:
+            while (restante > 0) {
+                nome_para_palavras(p, (size_t)restante, in, 8, sem_sinal);
+                transformacao_half_md4(buf, in);
+                restante -= 32;
+                p += 32;
+            }
+            hash = buf[1];
+            break;
+
+        case DX_HASH_TEA:
+        case DX_HASH_TEA_UNSIGNED:
+            while (restante > 0) {
+                nome_para_palavras(p, (size_t)restante, in, 4, sem_sinal);
+                transformacao_tea(buf, in);
+                restante -= 16;
+                p += 16;
+            }
+            hash = buf[0];
+            break;
+
+        default:
+            return 0;
+    }
+
+    hash &= ~1u;
+    if (hash == (DX_HASH_EOF << 1)) hash = (DX_HASH_EOF - 1) << 1;
+    return hash;
+}
+
+
+/*
+ * =================================================================================
+ * Navegação no Índice
+ * =================================================================================
+ */
+
+/**
+ * @brief Informa se o diretório deve ser tratado como indexado por hash.
+ * @return 1 se o sistema de arquivos tem dir_index e o inode tem a flag EXT2_INDEX_FL.
+ */
+int htree_diretorio_indexado(const superbloco* sb, const inode* dir_ino) {
+    return (sb->feature_compat & EXT2_FEATURE_COMPAT_DIR_INDEX) &&
+           EXT2_IS_DIR(dir_ino->mode) &&
+           (dir_ino->flags & EXT2_INDEX_FL);
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Lê o bloco lógico `logico` do diretório.
+ * @return 0 em sucesso, -1 se o bloco não existir ou a leitura falhar.
+ */
+static int ler_bloco_do_diretorio(int fd, const superbloco* sb, const inode* dir_ino, uint32_t logico, char* buffer, uint32_t* p_fisico) {
+    uint32_t tamanho_bloco = calcular_tamanho_do_bloco(sb);
+    if ((uint64_t)logico * tamanho_bloco >= dir_ino->size) return -1;
+
+    uint32_t fisico = mapear_bloco_logico(fd, sb, dir_ino, logico);
+    if (fisico == 0 || ler_bloco(fd, sb, fisico, buffer) != 0) return -1;
+
+    if (p_fisico) *p_fisico = fisico;
+    return 0;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Valida o cabeçalho de contagem de um nó.
+ */
+static int contagem_valida(const dx_entrada* entradas, uint32_t limite_esperado) {
+    const dx_contagem* cont = (const dx_contagem*)entradas;
+    return cont->limite == limite_esperado && cont->contagem >= 1 && cont->contagem <= cont->limite;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Escolhe, por busca binária, a última entrada do nó
+ * cujo hash é menor ou igual a `hash`.
+ */
+static uint32_t escolher_entrada(const dx_entrada* entradas, uint32_t hash) {
+    uint32_t contagem = ((const dx_contagem*)entradas)->contagem;
+    uint32_t inicio = 1, fim = contagem; // A entrada 0 cobre tudo abaixo da entrada 1
+
+    while (inicio < fim) {
+        uint32_t meio = inicio + (fim - inicio) / 2;
+        if (entradas[meio].hash > hash) fim = meio;
+        else inicio = meio + 1;
+    }
+    return inicio - 1;
+}
+
+static void liberar_caminho(caminho_dx* c) {
+    for (int i = 0; i < DX_MAX_NIVEIS; ++i) {
+        buffer_bloco_devolver(c->blocos[i]);
+        c->blocos[i] = NULL;
+    }
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Lê um nó intermediário para o nível `nivel` do caminho.
+ * @return 0 em sucesso, -1 se o nó for inválido.
+ */
+static int carregar_no_intermediario(int fd, const superbloco* sb, const inode* dir_ino, caminho_dx* c, int nivel, uint32_t logico) {
+    uint32_t tamanho_bloco = calcular_tamanho_do_bloco(sb);
+
+    if (!c->blocos[nivel]) {
+        c->blocos[nivel] = buffer_bloco_obter();
+        if (!c->blocos[nivel]) {
+            perror("Erro (htree): Falha ao alocar buffer");
+            return -1;
+        }
+    }
+    if (ler_bloco_do_diretorio(fd, sb, dir_ino, logico, c->blocos[nivel], &c->fisicos[nivel]) != 0) return -1;
+
+    // Um nó intermediário começa com uma entrada vazia que cobre o bloco inteiro.
+    const ext2_dir_entry* falsa = (const ext2_dir_entry*)c->blocos[nivel];
+    if (falsa->inode != 0 || falsa->rec_len != tamanho_bloco) return -1;
+
+    c->entradas[nivel] = (dx_entrada*)(c->blocos[nivel] + TAMANHO_CABECALHO_ENTRADA_DIR);
+    if (!contagem_valida(c->entradas[nivel], (tamanho_bloco - TAMANHO_CABECALHO_ENTRADA_DIR) / sizeof(dx_entrada))) return -1;
+
+    c->posicoes[nivel] = escolher_entrada(c->entradas[nivel], c->hash);
+    return 0;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Desce da raiz até a folha onde `nome` deve estar.
+ *
+ * @return O bloco LÓGICO da folha, ou 0 se o índice for inválido (o chamador deve
+ * então usar a varredura linear). O bloco 0 nunca é folha, então 0 não é ambíguo.
+ */
+static uint32_t sondar_indice(int fd, const superbloco* sb, const inode* dir_ino, const char* nome, caminho_dx* c) {
+    uint32_t tamanho_bloco = calcular_tamanho_do_bloco(sb);
+    memset(c, 0, sizeof(*c));
+
+    c->blocos[0] = buffer_bloco_obter();
+    if (!c->blocos[0]) {
+        perror("Erro (htree): Falha ao alocar buffer");
+        return 0;
+    }
+    if (ler_bloco_do_diretorio(fd, sb, dir_ino, 0, c->blocos[0], &c->fisicos[0]) != 0) return 0;
+
+    // Bloco 0: "." (12 bytes), ".." (resto do bloco) e, escondida dentro de "..", a raiz.
+    const ext2_dir_entry* ponto = (const ext2_dir_entry*)c->blocos[0];
+    const ext2_dir_entry* ponto_ponto = (const ext2_dir_entry*)(c->blocos[0] + 12);
+    if (ponto->rec_len != 12 || ponto->name_len != 1 || ponto->name[0] != '.' ||
+        ponto_ponto->rec_len != tamanho_bloco - 12 || ponto_ponto->name_len != 2) {
+        return 0;
+    }
+
+    const dx_info_raiz* info = (const dx_info_raiz*)(c->blocos[0] + 24);
+    if (info->reservado_zero != 0 || info->tamanho_info != 8 ||
+        info->versao_hash > DX_HASH_TEA || info->niveis_indiretos >= DX_MAX_NIVEIS) {
+        return 0;
+    }
+
+    c->versao_hash = info->versao_hash;
+    if (sb->flags & EXT2_FLAGS_UNSIGNED_HASH) c->versao_hash += DX_HASH_LEGACY_UNSIGNED;
+    memcpy(c->semente, (const void*)sb->hash_seed, sizeof(c->semente));
+    c->hash = htree_calcular_hash(nome, strlen(nome), c->versao_hash, c->semente);
+
+    c->entradas[0] = (dx_entrada*)(c->blocos[0] + 24 + info->tamanho_info);
+    if (!contagem_valida(c->entradas[0], (tamanho_bloco - 24 - info->tamanho_info) / sizeof(dx_entrada))) return 0;
+    c->posicoes[0] = escolher_entrada(c->entradas[0], c->hash);
+    c->niveis = 1;
+
+    for (int nivel = 1; nivel <= info->niveis_indiretos; ++nivel) {
+        uint32_t logico = c->entradas[nivel - 1][c->posicoes[nivel - 1]].bloco & DX_BLOCO_MASCARA;
+        if (carregar_no_intermediario(fd, sb, dir_ino, c, nivel, logico) != 0) return 0;
+        c->niveis++;
+    }
+
+    int folha = c->niveis - 1;
+    return c->entradas[folha][c->posicoes[folha]].bloco & DX_BLOCO_MASCARA;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Avança para a próxima folha quando nomes com o mesmo
+ * hash foram divididos entre duas folhas (a entrada seguinte tem o mesmo hash).
+ *
+ * @return O bloco lógico da próxima folha, ou 0 se não houver continuação.
+ */
+static uint32_t proxima_folha_colisao(int fd, const superbloco* sb, const inode* dir_ino, caminho_dx* c) {
+    int nivel = c->niveis - 1;
+    while (nivel >= 0 && c->posicoes[nivel] + 1 >= ((dx_contagem*)c->entradas[nivel])->contagem) {
+        nivel--;
+    }
+    if (nivel < 0) return 0;
+
+    c->posicoes[nivel]++;
+    if ((c->entradas[nivel][c->posicoes[nivel]].hash & ~1u) != c->hash) return 0;
+
+    // Os níveis abaixo recomeçam pela primeira entrada do novo nó.
+    for (int abaixo = nivel + 1; abaixo < c->niveis; ++abaixo) {
+        uint32_t logico = c->entradas[abaixo - 1][c->posicoes[abaixo - 1]].bloco & DX_BLOCO_MASCARA;
+        if (carregar_no_intermediario(fd, sb, dir_ino, c, abaixo, logico) != 0) return 0;
+        c->posicoes[abaixo] = 0;
+    }
+
+    int folha = c->niveis - 1;
+    return c->entradas[folha][c->posicoes[folha]].bloco & DX_BLOCO_MASCARA;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Procura um nome em um bloco-folha já carregado.
+ * @return O inode encontrado, ou 0.
+ */
+static uint32_t buscar_nome_na_folha(const char* bloco, uint32_t tamanho_bloco, const char* nome, size_t tamanho_nome) {
+    uint32_t offset = 0;
+    while (offset + TAMANHO_CABECALHO_ENTRADA_DIR <= tamanho_bloco) {
+        const ext2_dir_entry* entry = (const ext2_dir_entry*)(bloco + offset);
+        if (entry->rec_len < TAMANHO_CABECALHO_ENTRADA_DIR || offset + entry->rec_len > tamanho_bloco) break;
+
+        if (entry->inode != 0 && entry->name_len == tamanho_nome &&
+            memcmp(entry->name, nome, tamanho_nome) == 0) {
+            return entry->inode;
+        }
+        offset += entry->rec_len;
+    }
+    return 0;
+}
+
+/**
+ * @brief Procura um nome em um diretório indexado, lendo apenas os nós do caminho.
+ *
+ * @param inode_encontrado Recebe o inode do nome, se encontrado.
+ * @return 1 se encontrou, 0 se o nome não existe, -1 se o índice não pôde ser usado
+ * (diretório não indexado, índice inválido ou erro de leitura) — nesse caso o
+ * chamador deve recorrer à varredura linear.
+ */
+int htree_procurar(int fd, const superbloco* sb, const inode* dir_ino, const char* nome, uint32_t* inode_encontrado) {
+    if (!htree_diretorio_indexado(sb, dir_ino)) return -1;
+
+    // "." e ".." ficam no bloco 0, fora das folhas: a varredura linear os acha de imediato.
+    if (strcmp(nome, ".") == 0 || strcmp(nome, "..") == 0) return -1;
+
+    uint32_t tamanho_bloco = calcular_tamanho_do_bloco(sb);
+    caminho_dx c;
+    uint32_t folha = sondar_indice(fd, sb, dir_ino, nome, &c);
+    char* buffer_folha = buffer_bloco_obter();
+    int resultado = -1;
+
+    if (folha != 0 && buffer_folha) {
+        resultado = 0;
+        size_t tamanho_nome = strlen(nome);
+        while (folha != 0) {
+            if (ler_bloco_do_diretorio(fd, sb, dir_ino, folha, buffer_folha, NULL) != 0) {
+                resultado = -1;
+                break;
+            }
+            uint32_t achado = buscar_nome_na_folha(buffer_folha, tamanho_bloco, nome, tamanho_nome);
+            if (achado != 0) {
+                *inode_encontrado = achado;
+                resultado = 1;
+                break;
+            }
+            folha = proxima_folha_colisao(fd, sb, dir_ino, &c);
+        }
+    }
+
+    buffer_bloco_devolver(buffer_folha);
+    liberar_caminho(&c);
+    return resultado;
+}
+
+/**
+ * @brief Devolve o bloco FÍSICO da folha onde `nome` deveria estar (usado pela remoção).
+ * @return O número do bloco, ou 0 se o índice não puder ser usado.
+ */
+uint32_t htree_localizar_folha(int fd, const superbloco* sb, const inode* dir_ino, const char* nome) {
+    if (!htree_diretorio_indexado(sb, dir_ino)) return 0;
+
+    caminho_dx c;
+    uint32_t folha = sondar_indice(fd, sb, dir_ino, nome, &c);
+    liberar_caminho(&c);
+    return (folha != 0) ? mapear_bloco_logico(fd, sb, dir_ino, folha) : 0;
+}
+
+
+/*
+ * =================================================================================
+ * Inserção
+ * =================================================================================
+ */
+
+/**
+ * @brief (Função Auxiliar Estática) Insere uma entrada em um bloco de diretório em memória,
+ * reaproveitando uma entrada apagada ou a sobra de espaço de qualquer entrada.
+ * @return 1 se inseriu, 0 se não há espaço.
+ */
+static int inserir_no_bloco(char* bloco, uint32_t tamanho_bloco, uint32_t inode_filho, const char* nome, uint8_t tamanho_nome, uint8_t tipo_arquivo) {
+    uint16_t rec_len_necessario = (TAMANHO_CABECALHO_ENTRADA_DIR + tamanho_nome + 3) & ~3;
+    uint32_t offset = 0;
+
+    while (offset + TAMANHO_CABECALHO_ENTRADA_DIR <= tamanho_bloco) {
+        ext2_dir_entry* entry = (ext2_dir_entry*)(bloco + offset);
+        if (entry->rec_len < TAMANHO_CABECALHO_ENTRADA_DIR || offset + entry->rec_len > tamanho_bloco) return 0;
+
+        ext2_dir_entry* nova_entry = NULL;
+        if (entry->inode == 0 && entry->rec_len >= rec_len_necessario) {
+            nova_entry = entry; // Entrada apagada: ocupa o lugar dela, mantendo o rec_len
+        } else {
+            uint16_t rec_len_real = (TAMANHO_CABECALHO_ENTRADA_DIR + entry->name_len + 3) & ~3;
+            if (entry->inode != 0 && entry->rec_len - rec_len_real >= rec_len_necessario) {
+                nova_entry = (ext2_dir_entry*)(bloco + offset + rec_len_real);
+                nova_entry->rec_len = entry->rec_len - rec_len_real;
+                entry->rec_len = rec_len_real;
+            }
+        }
+
+        if (nova_entry) {
+            nova_entry->inode = inode_filho;
+            nova_entry->name_len = tamanho_nome;
+            nova_entry->file_type = tipo_arquivo;
+            memcpy(nova_entry->name, nome, tamanho_nome);
+            return 1;
+        }
+        offset += entry->rec_len;
+    }
+    return 0;
+}
+
+/*
+ * Entrada de uma folha a ser redistribuída numa divisão.
+ */
+typedef struct {
+    uint32_t hash;
+    uint16_t offset;
+    uint16_t tamanho;
+} entrada_folha;
+
+static int comparar_entradas_folha(const void* a, const void* b) {
+    const entrada_folha* ea = a;
+    const entrada_folha* eb = b;
+    if (ea->hash != eb->hash) return (ea->hash < eb->hash) ? -1 : 1;
+    return (ea->offset < eb->offset) ? -1 : (ea->offset > eb->offset);
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Copia as entradas [inicio, fim) para `destino`,
+ * compactadas e em ordem de hash; a última entrada absorve o resto do bloco.
+ */
+static void montar_folha(char* destino, uint32_t tamanho_bloco, const char* origem, const entrada_folha* mapa, uint32_t inicio, uint32_t fim) {
+    memset(destino, 0, tamanho_bloco);
+    uint32_t offset = 0;
+    ext2_dir_entry* ultima = NULL;
+
+    for (uint32_t i = inicio; i < fim; ++i) {
+        memcpy(destino + offset, origem + mapa[i].offset, mapa[i].tamanho);
+        ultima = (ext2_dir_entry*)(destino + offset);
+        ultima->rec_len = mapa[i].tamanho;
+        offset += mapa[i].tamanho;
+    }
+    if (ultima) ultima->rec_len += tamanho_bloco - offset;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Aloca um bloco novo e o anexa ao fim do diretório.
+ *
+ * @param p_logico Recebe o índice lógico do bloco dentro do diretório.
+ * @return O bloco físico alocado, ou 0 em erro.
+ */
+static uint32_t anexar_bloco_ao_diretorio(int fd, superbloco* sb, group_desc* gdt, inode* dir_ino, uint32_t dir_inode_num, uint32_t* p_logico) {
+    uint32_t tamanho_bloco = calcular_tamanho_do_bloco(sb);
+    uint32_t logico = dir_ino->size / tamanho_bloco;
+
+    uint32_t fisico = alocar_bloco(fd, sb, gdt, dir_inode_num);
+    if (fisico == 0) return 0;
+    if (definir_bloco_logico(fd, sb, gdt, dir_ino, dir_inode_num, logico, fisico) != 0) {
+        liberar_bloco(fd, sb, gdt, fisico);
+        return 0;
+    }
+
+    dir_ino->size += tamanho_bloco;
+    dir_ino->blocks += tamanho_bloco / 512;
+    *p_logico = logico;
+    return fisico;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Garante que o nó do índice que aponta para a folha
+ * tenha espaço para mais uma entrada.
+ *
+ * Se a raiz (sem níveis intermediários) estiver cheia, suas entradas passam para um novo
+ * nó intermediário e a árvore ganha um nível. Se um nó intermediário estiver cheio, ele
+ * é dividido ao meio e a metade superior é registrada na raiz. O caminho `c` é ajustado
+ * para continuar apontando para a folha original.
+ *
+ * @return 0 se há espaço, -1 se o índice não pode crescer mais.
+ */
+static int abrir_espaco_no_indice(int fd, superbloco* sb, group_desc* gdt, inode* dir_ino, uint32_t dir_inode_num, caminho_dx* c) {
+    uint32_t tamanho_bloco = calcular_tamanho_do_bloco(sb);
+    int nivel = c->niveis - 1;
+    dx_contagem* cont = (dx_contagem*)c->entradas[nivel];
+    if (cont->contagem < cont->limite) return 0;
+
+    uint16_t limite_intermediario = (tamanho_bloco - TAMANHO_CABECALHO_ENTRADA_DIR) / sizeof(dx_entrada);
+    dx_contagem* cont_raiz = (dx_contagem*)c->entradas[0];
+    if (nivel > 0 && cont_raiz->contagem >= cont_raiz->limite) return -1; // Árvore cheia
+    if (nivel == 0 && DX_MAX_NIVEIS < 2) return -1;
+
+    char* novo_no = buffer_bloco_obter_zerado();
+    if (!novo_no) {
+        perror("Erro (htree): Falha ao alocar buffer");
+        return -1;
+    }
+    uint32_t logico_novo;
+    uint32_t fisico_novo = anexar_bloco_ao_diretorio(fd, sb, gdt, dir_ino, dir_inode_num, &logico_novo);
+    if (fisico_novo == 0) {
+        buffer_bloco_devolver(novo_no);
+        return -1;
+    }
+
+    // Todo nó intermediário começa com uma entrada vazia que cobre o bloco inteiro.
+    ext2_dir_entry* falsa = (ext2_dir_entry*)novo_no;
+    falsa->inode = 0;
+    falsa->rec_len = tamanho_bloco;
+    dx_entrada* entradas_novas = (dx_entrada*)(novo_no + TAMANHO_CABECALHO_ENTRADA_DIR);
+    dx_contagem* cont_novo = (dx_contagem*)entradas_novas;
+
+    if (nivel == 0) {
+        // A raiz vira o pai de um único nó intermediário que recebe todas as suas entradas.
+        uint16_t contagem = cont->contagem;
+        memcpy(entradas_novas, c->entradas[0], contagem * sizeof(dx_entrada));
+        cont_novo->limite = limite_intermediario;
+        cont_novo->contagem = contagem;
+
+        cont->contagem = 1;
+        c->entradas[0][0].bloco = logico_novo;
+        ((dx_info_raiz*)(c->blocos[0] + 24))->niveis_indiretos = 1;
+
+        c->blocos[1] = novo_no;
+        c->fisicos[1] = fisico_novo;
+        c->entradas[1] = entradas_novas;
+        c->posicoes[1] = c->posicoes[0];
+        c->posicoes[0] = 0;
+        c->niveis = 2;
+
+        if (escrever_bloco(fd, sb, fisico_novo, novo_no) != 0 ||
+            escrever_bloco(fd, sb, c->fisicos[0], c->blocos[0]) != 0) {
+            return -1;
+        }
+        return 0;
+    }
+
+    // Divide o nó intermediário: a metade superior vai para o novo nó.
+    dx_entrada* entradas = c->entradas[nivel];
+    uint16_t metade = cont->contagem / 2;
+    uint16_t movidas = cont->contagem - metade;
+    uint32_t hash_divisao = entradas[metade].hash;
+
+    memcpy(entradas_novas, &entradas[metade], movidas * sizeof(dx_entrada));
+    cont_novo->limite = limite_intermediario;
+    cont_novo->contagem = movidas;
+    cont->contagem = metade;
+
+    // Registra o novo nó na raiz, logo após o nó dividido.
+    dx_entrada* entradas_raiz = c->entradas[0];
+    uint32_t posicao = c->posicoes[0] + 1;
+    memmove(&entradas_raiz[posicao + 1], &entradas_raiz[posicao], (cont_raiz->contagem - posicao) * sizeof(dx_entrada));
+    entradas_raiz[posicao].hash = hash_divisao;
+    entradas_raiz[posicao].bloco = logico_novo;
+    cont_raiz->contagem++;
+
+    int status = 0;
+    if (escrever_bloco(fd, sb, fisico_novo, novo_no) != 0 ||
+        escrever_bloco(fd, sb, c->fisicos[nivel], c->blocos[nivel]) != 0 ||
+        escrever_bloco(fd, sb, c->fisicos[0], c->blocos[0]) != 0) {
+        status = -1;
+    }
+
+    // Se a folha ficou na metade nova, o caminho passa a usar o novo nó.
+    if (c->posicoes[nivel] >= metade) {
+        buffer_bloco_devolver(c->blocos[nivel]);
+        c->blocos[nivel] = novo_no;
+        c->fisicos[nivel] = fisico_novo;
+        c->entradas[nivel] = entradas_novas;
+        c->posicoes[nivel] -= metade;
+        c->posicoes[0]++;
+    } else {
+        buffer_bloco_devolver(novo_no);
+    }
+    return status;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Divide uma folha cheia em duas, pelo hash mediano,
+ * e registra a nova folha no nó do índice que aponta para a antiga.
+ *
+ * @param folha Conteúdo atual da folha (é reescrito com a primeira metade).
+ * @param p_hash_divisao Recebe o menor hash que foi para a nova folha.
+ * @param p_fisico_novo Recebe o bloco físico da nova folha.
+ * @param nova_folha Buffer que recebe o conteúdo da nova folha.
+ * @return 0 em sucesso, -1 se não foi possível dividir.
+ */
+static int dividir_folha(int fd, superbloco* sb, group_desc* gdt, inode* dir_ino, uint32_t dir_inode_num,
+                         caminho_dx* c, char* folha, char* nova_folha, uint32_t* p_hash_divisao, uint32_t* p_fisico_novo) {
+    uint32_t tamanho_bloco = calcular_tamanho_do_bloco(sb);
+    if (abrir_espaco_no_indice(fd, sb, gdt, dir_ino, dir_inode_num, c) != 0) return -1;
+    int nivel = c->niveis - 1;
+    dx_contagem* cont = (dx_contagem*)c->entradas[nivel];
+
+    // Mapeia as entradas vivas da folha e as ordena por hash.
+    entrada_folha* mapa = malloc((tamanho_bloco / TAMANHO_CABECALHO_ENTRADA_DIR) * sizeof(entrada_folha));
+    char* copia = buffer_bloco_obter();
+    if (!mapa || !copia) {
+        perror("Erro (htree): Falha ao alocar buffers para a divisão");
+        free(mapa); buffer_bloco_devolver(copia);
+        return -1;
+    }
+    memcpy(copia, folha, tamanho_bloco);
+
+    uint32_t n = 0, total = 0, offset = 0;
+    while (offset + TAMANHO_CABECALHO_ENTRADA_DIR <= tamanho_bloco) {
+        const ext2_dir_entry* entry = (const ext2_dir_entry*)(copia + offset);
+        if (entry->rec_len < TAMANHO_CABECALHO_ENTRADA_DIR || offset + entry->rec_len > tamanho_bloco) break;
+        if (entry->inode != 0) {
+            mapa[n].hash = htree_calcular_hash(entry->name, entry->name_len, c->versao_hash, c->semente);
+            mapa[n].offset = (uint16_t)offset;
+            mapa[n].tamanho = (TAMANHO_CABECALHO_ENTRADA_DIR + entry->name_len + 3) & ~3;
+            total += mapa[n].tamanho;
+            n++;
+        }
+        offset += entry->rec_len;
+    }
+    if (n < 2) {
+        free(mapa); buffer_bloco_devolver(copia);
+        return -1;
+    }
+    qsort(mapa, n, sizeof(entrada_folha), comparar_entradas_folha);
+
+    // Divide onde a primeira metade atinge metade dos bytes ocupados.
+    uint32_t divisao = 0, acumulado = 0;
+    while (divisao < n - 1 && acumulado + mapa[divisao].tamanho <= total / 2) {
+        acumulado += mapa[divisao].tamanho;
+        divisao++;
+    }
+    if (divisao == 0) divisao = 1;
+
+    uint32_t hash_divisao = mapa[divisao].hash;
+    uint32_t continuado = (hash_divisao == mapa[divisao - 1].hash) ? 1 : 0;
+
+    // Aloca a nova folha no fim do diretório.
+    uint32_t logico_novo;
+    uint32_t fisico_novo = anexar_bloco_ao_diretorio(fd, sb, gdt, dir_ino, dir_inode_num, &logico_novo);
+    if (fisico_novo == 0) {
+        free(mapa); buffer_bloco_devolver(copia);
+        return -1;
+    }
+
+    montar_folha(folha, tamanho_bloco, copia, mapa, 0, divisao);
+    montar_folha(nova_folha, tamanho_bloco, copia, mapa, divisao, n);
+    free(mapa);
+    buffer_bloco_devolver(copia);
+
+    // Registra a nova folha logo após a antiga no nó do índice.
+    dx_entrada* entradas = c->entradas[nivel];
+    uint32_t posicao = c->posicoes[nivel] + 1;
+    memmove(&entradas[posicao + 1], &entradas[posicao], (cont->contagem - posicao) * sizeof(dx_entrada));
+    entradas[posicao].hash = hash_divisao | continuado;
+    entradas[posicao].bloco = logico_novo;
+    cont->contagem++;
+
+    if (escrever_bloco(fd, sb, c->fisicos[nivel], c->blocos[nivel]) != 0) return -1;
+
+    *p_hash_divisao = hash_divisao;
+    *p_fisico_novo = fisico_novo;
+    return 0;
+}
+
+/**
+ * @brief Insere uma entrada em um diretório indexado, mantendo o índice.
+ *
+ * A entrada vai para a folha indicada pelo hash; se a folha estiver cheia, ela é
+ * dividida. Em caso de falha, o diretório não é alterado no disco e o chamador
+ * deve desligar o índice (limpar EXT2_INDEX_FL) e usar a inserção linear.
+ *
+ * IMPORTANTE: Pode modificar 'dir_ino' em memória (tamanho e blocos). O chamador DEVE
+ * escrevê-lo de volta ao disco.
+ * @return 0 em sucesso, -1 se o índice não pôde ser usado.
+ */
+int htree_adicionar(int fd, superbloco* sb, group_desc* gdt, inode* dir_ino, uint32_t dir_inode_num,
+                    uint32_t inode_filho, const char* nome, uint8_t tipo_arquivo) {
+    if (!htree_diretorio_indexado(sb, dir_ino)) return -1;
+
+    uint32_t tamanho_bloco = calcular_tamanho_do_bloco(sb);
+    size_t tamanho_nome = strlen(nome);
+    if (tamanho_nome == 0 || tamanho_nome > EXT2_NAME_LEN) return -1;
+
+    caminho_dx c;
+    uint32_t folha_logica = sondar_indice(fd, sb, dir_ino, nome, &c);
+    char* folha = buffer_bloco_obter();
+    char* nova_folha = buffer_bloco_obter();
+    uint32_t fisico_folha = 0;
+    int status = -1;
+
+    if (folha_logica == 0 || !folha || !nova_folha ||
+        ler_bloco_do_diretorio(fd, sb, dir_ino, folha_logica, folha, &fisico_folha) != 0) {
+        goto fim;
+    }
+
+    if (inserir_no_bloco(folha, tamanho_bloco, inode_filho, nome, (uint8_t)tamanho_nome, tipo_arquivo)) {
+        status = escrever_bloco(fd, sb, fisico_folha, folha);
+        goto fim;
+    }
+
+    // Folha cheia: divide e insere na metade correspondente ao hash do nome.
+    uint32_t hash_divisao, fisico_novo;
+    if (dividir_folha(fd, sb, gdt, dir_ino, dir_inode_num, &c, folha, nova_folha, &hash_divisao, &fisico_novo) != 0) {
+        goto fim;
+    }
+
+    char* destino = (c.hash >= hash_divisao) ? nova_folha : folha;
+    int inserido = inserir_no_bloco(destino, tamanho_bloco, inode_filho, nome, (uint8_t)tamanho_nome, tipo_arquivo);
+
+    // As duas metades são gravadas de qualquer forma: o índice já aponta para a nova folha.
+    if (escrever_bloco(fd, sb, fisico_novo, nova_folha) == 0 &&
+        escrever_bloco(fd, sb, fisico_folha, folha) == 0 && inserido) {
+        status = 0;
+    }
+
+fim:
+    buffer_bloco_devolver(folha);
+    buffer_bloco_devolver(nova_folha);
+    liberar_caminho(&c);
+    return status;
+}
@@ -0,0 +1,63 @@
+/**
+ * @file       htree.h
+ * @brief      Declaração do suporte aos índices hash de diretório (dir_index / htree).
+ *
+ *  @author     Allan Custódio Diniz Marques (L33tSh4rk)
+ *
+ * Diretórios com a flag EXT2_INDEX_FL guardam, no bloco 0, uma árvore de índices
+ * ordenada pelo hash dos nomes (o mesmo formato usado pelo ext3/ext4). Com ela, achar
+ * um nome exige ler apenas a raiz, no máximo um nó intermediário e uma folha, em vez
+ * de varrer todos os blocos do diretório. A varredura linear continua sendo usada
+ * quando o diretório não é indexado ou quando o índice é inválido.
+ *
+ * Data de criação: 16 de outubro de 2026
+ * Data de atualização: 16 de outubro de 2026
+ *
+ */
+
+#ifndef EXT2_HTREE_H
+#define EXT2_HTREE_H
+
+#include "headers.h"
+
+/* Versões de hash (dx_root_info.hash_version) */
+#define DX_HASH_LEGACY            0
+#define DX_HASH_HALF_MD4          1
+#define DX_HASH_TEA               2
+#define DX_HASH_LEGACY_UNSIGNED   3
+#define DX_HASH_HALF_MD4_UNSIGNED 4
+#define DX_HASH_TEA_UNSIGNED      5
+
+/*
+ * Cabeçalho da raiz do índice, logo após as entradas "." e ".." do bloco 0.
+ */
+typedef struct {
+    uint32_t reservado_zero;
+    uint8_t  versao_hash;           // Uma das constantes DX_HASH_*
+    uint8_t  tamanho_info;          // Sempre 8
+    uint8_t  niveis_indiretos;      // 0 = a raiz aponta direto para as folhas
+    uint8_t  flags_nao_usadas;
+} __attribute__((packed)) dx_info_raiz;
+
+/*
+ * Entrada de um nó do índice. A primeira entrada de cada nó não tem hash: no lugar
+ * dele ficam o limite e a quantidade de entradas do nó (dx_contagem).
+ */
+typedef struct {
+    uint32_t hash;
+    uint32_t bloco;                 // Bloco LÓGICO do diretório
+} __attribute__((packed)) dx_entrada;
+
+typedef struct {
+    uint16_t limite;
+    uint16_t contagem;
+} __attribute__((packed)) dx_contagem;
+
+uint32_t htree_calcular_hash(const char* nome, size_t tamanho_nome, int versao_hash, const uint32_t semente[4]);
+int htree_diretorio_indexado(const superbloco* sb, const inode* dir_ino);
+int htree_procurar(int fd, const superbloco* sb, const inode* dir_ino, const char* nome, uint32_t* inode_encontrado);
+uint32_t htree_localizar_folha(int fd, const superbloco* sb, const inode* dir_ino, const char* nome);
+int htree_adicionar(int fd, superbloco* sb, group_desc* gdt, inode* dir_ino, uint32_t dir_inode_num,
+                    uint32_t inode_filho, const char* nome, uint8_t tipo_arquivo);
+
+#endif // EXT2_HTREE_H
@@ -0,0 +1,743 @@
+/**
+ * @file       io.c
+ * @brief      Implementação da camada de E/S posicional (pread/pwrite) sobre a imagem do disco.
+ *
+ * @author     Allan Custódio Diniz Marques (L33tSh4rk)
+ *
+ * Substitui os pares lseek + read/write: cada acesso vira uma única chamada de
+ * sistema e o offset do descritor deixa de ser estado compartilhado, o que permite
+ * que várias leituras aconteçam ao mesmo tempo sobre o mesmo descritor.
+ *
+ * Data de criação: 16 de outubro de 2026
+ * Data de atualização: 16 de outubro de 2026
+ *
+ */
+
+#define _GNU_SOURCE     // copy_file_range, fallocate e SEEK_DATA/SEEK_HOLE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/sendfile.h>
+#include <sys/uio.h>
+
+#ifdef EXT2_IO_URING
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#include <pthread.h>
+#endif
+
+#include "io.h"
+#include "travas.h"
+
+// Estado do mapeamento da imagem (modo --mmap). Só existe uma imagem por processo.
+static unsigned char* mapa_imagem = NULL;
+static size_t tamanho_mapa = 0;
+static int fd_mapeado = -1;
+
+// Mecanismos de cópia no kernel que já falharam por falta de suporte (não são tentados de novo).
+static int copy_file_range_indisponivel = 0;
+static int sendfile_indisponivel = 0;
+static int punch_hole_indisponivel = 0;
+
+// Contadores da E/S em lote (comando 'stats').
+static estatisticas_io_lotes estatisticas_lotes;
+
+
+/**
+ * @brief Lê `tamanho` bytes da posição `offset` do arquivo, sem alterar seu offset.
+ *
+ * Repete a chamada enquanto a leitura for parcial ou interrompida por um sinal.
+ *
+ * @param fd O descritor de arquivo.
+ * @param buffer O buffer de destino.
+ * @param tamanho Quantidade de bytes a ler.
+ * @param offset Posição absoluta no arquivo.
+ * @return Total de bytes lidos (menor que `tamanho` apenas se o fim do arquivo
+ * for atingido), ou -1 em erro (com errno preenchido).
+ */
+ssize_t io_ler_em(int fd, void* buffer, size_t tamanho, off_t offset) {
+    const void* origem_mapeada = io_ponteiro_em(fd, offset, tamanho);
+    if (origem_mapeada) {
+        memcpy(buffer, origem_mapeada, tamanho);
+        return (ssize_t)tamanho;
+    }
+
+    size_t total = 0;
+    char* destino = buffer;
+
+    while (total < tamanho) {
+        ssize_t lidos = pread(fd, destino + total, tamanho - total, offset + (off_t)total);
+        if (lidos == -1) {
+            if (errno == EINTR) continue; // Interrompido por sinal: tenta de novo
+            return -1;
+        }
+        if (lidos == 0) break; // Fim do arquivo
+        total += (size_t)lidos;
+    }
+
+    return (ssize_t)total;
+}
+
+/**
+ * @brief Escreve `tamanho` bytes na posição `offset` do arquivo, sem alterar seu offset.
+ *
+ * Repete a chamada enquanto a escrita for parcial ou interrompida por um sinal.
+ *
+ * @param fd O descritor de arquivo.
+ * @param buffer Os dados a serem escritos.
+ * @param tamanho Quantidade de bytes a escrever.
+ * @param offset Posição absoluta no arquivo.
+ * @return Total de bytes escritos (igual a `tamanho` em sucesso), ou -1 em erro.
+ */
+ssize_t io_escrever_em(int fd, const void* buffer, size_t tamanho, off_t offset) {
+    void* destino_mapeado = io_ponteiro_em(fd, offset, tamanho);
+    if (destino_mapeado) {
+        memcpy(destino_mapeado, buffer, tamanho);
+        return (ssize_t)tamanho;
+    }
+
+    size_t total = 0;
+    const char* origem = buffer;
+
+    while (total < tamanho) {
+        ssize_t escritos = pwrite(fd, origem + total, tamanho - total, offset + (off_t)total);
+        if (escritos == -1) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (escritos == 0) break; // Nada foi escrito (ex: disco cheio); evita laço infinito
+        total += (size_t)escritos;
+    }
+
+    return (ssize_t)total;
+}
+
+/**
+ * @brief Lê uma região contígua do arquivo, a partir de `offset`, espalhando-a pelos
+ * buffers de `vetor` (preadv). Sem alterar o offset do descritor.
+ *
+ * Repete a chamada enquanto a leitura for parcial ou interrompida por um sinal.
+ * No modo --mmap cada buffer é copiado direto do mapeamento.
+ *
+ * @param fd O descritor de arquivo.
+ * @param vetor Os buffers de destino, em ordem.
+ * @param quantidade Número de buffers (no máximo IO_MAX_VETOR).
+ * @param offset Posição absoluta no arquivo.
+ * @return Total de bytes lidos (menor que a soma dos buffers apenas se o fim do
+ * arquivo for atingido), ou -1 em erro (com errno preenchido).
+ */
+ssize_t io_ler_vetor_em(int fd, const struct iovec* vetor, int quantidade, off_t offset) {
+    if (quantidade <= 0) return 0;
+    if (quantidade > IO_MAX_VETOR) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    size_t total_pedido = 0;
+    for (int i = 0; i < quantidade; ++i) total_pedido += vetor[i].iov_len;
+
+    const char* origem_mapeada = io_ponteiro_em(fd, offset, total_pedido);
+    if (origem_mapeada) {
+        for (int i = 0; i < quantidade; ++i) {
+            memcpy(vetor[i].iov_base, origem_mapeada, vetor[i].iov_len);
+            origem_mapeada += vetor[i].iov_len;
+        }
+        return (ssize_t)total_pedido;
+    }
+
+    // Cópia local do vetor: uma leitura parcial avança o primeiro buffer pendente.
+    struct iovec restante[IO_MAX_VETOR];
+    memcpy(restante, vetor, (size_t)quantidade * sizeof(struct iovec));
+
+    size_t total = 0;
+    int inicio = 0;
+    while (inicio < quantidade) {
+        ssize_t lidos = preadv(fd, restante + inicio, quantidade - inicio, offset + (off_t)total);
+        if (lidos == -1) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (lidos == 0) break; // Fim do arquivo
+        total += (size_t)lidos;
+
+        size_t consumidos = (size_t)lidos;
+        while (inicio < quantidade && consumidos >= restante[inicio].iov_len) {
+            consumidos -= restante[inicio].iov_len;
+            inicio++;
+        }
+        if (inicio < quantidade) {
+            restante[inicio].iov_base = (char*)restante[inicio].iov_base + consumidos;
+            restante[inicio].iov_len -= consumidos;
+        }
+    }
+
+    return (ssize_t)total;
+}
+
+/*
+ * =================================================================================
+ * Cópia entre Arquivos
+ * =================================================================================
+ */
+
+/**
+ * @brief (Função Auxiliar Estática) Indica se o erro significa "mecanismo não suportado
+ * para este par de arquivos", caso em que vale tentar o próximo.
+ */
+static int erro_de_suporte(int erro) {
+    return erro == ENOSYS || erro == EXDEV || erro == EINVAL || erro == EOPNOTSUPP || erro == EBADF;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Cópia com buffer intermediário (pread/pwrite), o último recurso.
+ */
+static ssize_t copiar_com_buffer(int fd_origem, off_t offset_origem, int fd_destino, off_t offset_destino, size_t tamanho) {
+    const size_t tamanho_buffer = 1 << 20;
+    char* buffer = malloc(tamanho < tamanho_buffer ? tamanho : tamanho_buffer);
+    if (!buffer) return -1;
+
+    size_t total = 0;
+    while (total < tamanho) {
+        size_t trecho = tamanho - total;
+        if (trecho > tamanho_buffer) trecho = tamanho_buffer;
+        ssize_t lidos = io_ler_em(fd_origem, buffer, trecho, offset_origem + (off_t)total);
+        if (lidos <= 0) break;
+        if (io_escrever_em(fd_destino, buffer, (size_t)lidos, offset_destino + (off_t)total) != lidos) {
+            free(buffer);
+            return -1;
+        }
+        total += (size_t)lidos;
+    }
+    free(buffer);
+    return (ssize_t)total;
+}
+
+/**
+ * @brief Copia `tamanho` bytes entre dois arquivos sem passar os dados pelo espaço do usuário.
+ *
+ * Tenta, nesta ordem: copy_file_range (cópia inteira no kernel, podendo até
+ * compartilhar extents no sistema de arquivos do host), sendfile e, por fim,
+ * pread/pwrite com um buffer intermediário. Se a origem ou o destino estiver
+ * mapeado (--mmap), os dados vão direto do mapeamento ou para ele. O offset da
+ * origem nunca muda; o do destino só muda se o sendfile for usado.
+ *
+ * @param fd_origem O descritor de origem (a imagem, no 'cp'; o arquivo do host, no 'import').
+ * @param offset_origem Posição inicial na origem.
+ * @param fd_destino O descritor de destino.
+ * @param offset_destino Posição inicial no destino.
+ * @param tamanho Quantidade de bytes.
+ * @return Total de bytes copiados (menor que `tamanho` apenas no fim da origem), ou -1 em erro.
+ */
+ssize_t io_copiar_intervalo(int fd_origem, off_t offset_origem, int fd_destino, off_t offset_destino, size_t tamanho) {
+    const void* origem_mapeada = io_ponteiro_em(fd_origem, offset_origem, tamanho);
+    if (origem_mapeada) {
+        return io_escrever_em(fd_destino, origem_mapeada, tamanho, offset_destino);
+    }
+    void* destino_mapeado = io_ponteiro_em(fd_destino, offset_destino, tamanho);
+    if (destino_mapeado) {
+        return io_ler_em(fd_origem, destino_mapeado, tamanho, offset_origem);
+    }
+
+    size_t total = 0;
+
+    while (!copy_file_range_indisponivel && total < tamanho) {
+        loff_t de = offset_origem + (off_t)total;
+        loff_t para = offset_destino + (off_t)total;
+        ssize_t copiados = copy_file_range(fd_origem, &de, fd_destino, &para, tamanho - total, 0);
+        if (copiados == -1) {
+            if (errno == EINTR) continue;
+            if (!erro_de_suporte(errno) || total > 0) return -1;
+            copy_file_range_indisponivel = 1;
+            break;
+        }
+        if (copiados == 0) return (ssize_t)total; // Fim da origem
+        total += (size_t)copiados;
+    }
+    if (total == tamanho) return (ssize_t)total;
+
+    // sendfile escreve na posição corrente do destino: posiciona-o antes.
+    if (!sendfile_indisponivel && lseek(fd_destino, offset_destino + (off_t)total, SEEK_SET) != (off_t)-1) {
+        while (total < tamanho) {
+            off_t de = offset_origem + (off_t)total;
+            ssize_t copiados = sendfile(fd_destino, fd_origem, &de, tamanho - total);
+            if (copiados == -1) {
+                if (errno == EINTR) continue;
+                if (!erro_de_suporte(errno) || total > 0) return -1;
+                sendfile_indisponivel = 1;
+                break;
+            }
+            if (copiados == 0) return (ssize_t)total;
+            total += (size_t)copiados;
+        }
+        if (total == tamanho) return (ssize_t)total;
+    }
+
+    ssize_t restantes = copiar_com_buffer(fd_origem, offset_origem + (off_t)total, fd_destino,
+                                          offset_destino + (off_t)total, tamanho - total);
+    return (restantes < 0) ? -1 : (ssize_t)(total + (size_t)restantes);
+}
+
+/**
+ * @brief Transforma o intervalo [offset, offset + tamanho) do arquivo em um buraco.
+ *
+ * Usa fallocate(FALLOC_FL_PUNCH_HOLE), que libera o espaço no host sem mudar o
+ * tamanho do arquivo. Se o sistema de arquivos não suportar, o intervalo é
+ * preenchido com zeros, que têm o mesmo conteúdo lógico.
+ *
+ * @param fd O descritor do arquivo (aberto para escrita).
+ * @param offset Início do intervalo.
+ * @param tamanho Tamanho do intervalo em bytes.
+ * @return 0 em sucesso, -1 em erro.
+ */
+int io_abrir_buraco(int fd, off_t offset, off_t tamanho) {
+    if (tamanho <= 0) return 0;
+    if (!punch_hole_indisponivel) {
+        if (fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, offset, tamanho) == 0) return 0;
+        if (!erro_de_suporte(errno)) return -1;
+        punch_hole_indisponivel = 1;
+    }
+
+    const size_t tamanho_buffer = 1 << 20;
+    char* zeros = calloc(1, (size_t)tamanho < tamanho_buffer ? (size_t)tamanho : tamanho_buffer);
+    if (!zeros) return -1;
+    off_t escritos = 0;
+    while (escritos < tamanho) {
+        size_t trecho = (size_t)(tamanho - escritos) < tamanho_buffer ? (size_t)(tamanho - escritos) : tamanho_buffer;
+        if (io_escrever_em(fd, zeros, trecho, offset + escritos) != (ssize_t)trecho) {
+            free(zeros);
+            return -1;
+        }
+        escritos += (off_t)trecho;
+    }
+    free(zeros);
+    return 0;
+}
+
+/**
+ * @brief Procura, a partir de `offset`, o próximo trecho do arquivo que contém dados
+ * (isto é, que não é um buraco), com lseek(SEEK_DATA/SEEK_HOLE).
+ *
+ * Se o sistema de arquivos não souber responder, o arquivo inteiro é tratado como dados.
+ *
+ * @param fd O descritor do arquivo.
+ * @param offset Posição inicial da busca.
+ * @param tamanho O tamanho do arquivo.
+ * @param fim_dados Recebe o fim (exclusivo) do trecho de dados encontrado.
+ * @return O início do trecho de dados, ou `tamanho` se só houver buraco até o fim.
+ */
+off_t io_procurar_dados(int fd, off_t offset, off_t tamanho, off_t* fim_dados) {
+    *fim_dados = tamanho;
+    if (offset >= tamanho) return tamanho;
+
+    off_t inicio = lseek(fd, offset, SEEK_DATA);
+    if (inicio == (off_t)-1) {
+        return (errno == ENXIO) ? tamanho : offset;   // ENXIO: nenhum dado depois de offset
+    }
+    if (inicio >= tamanho) return tamanho;
+
+    off_t fim = lseek(fd, inicio, SEEK_HOLE);
+    if (fim != (off_t)-1 && fim < tamanho) *fim_dados = fim;
+    return inicio;
+}
+
+/*
+ * =================================================================================
+ * Leitura Antecipada
+ * =================================================================================
+ */
+
+/**
+ * @brief Avisa o kernel de que o intervalo será lido em breve, sem esperar pela leitura.
+ *
+ * Com pread/pwrite usa posix_fadvise(POSIX_FADV_WILLNEED), que agenda a leitura para
+ * o page cache e retorna na hora; no modo --mmap usa madvise(MADV_WILLNEED) sobre o
+ * trecho mapeado. Falhas são ignoradas: o pior caso é a leitura não ser antecipada.
+ *
+ * @param fd O descritor do arquivo.
+ * @param offset Início do intervalo.
+ * @param tamanho Tamanho do intervalo em bytes.
+ */
+void io_antecipar(int fd, off_t offset, size_t tamanho) {
+    if (tamanho == 0) return;
+
+    unsigned char* mapeado = io_ponteiro_em(fd, offset, tamanho);
+    if (mapeado) {
+        // madvise exige um endereço alinhado à página.
+        uintptr_t pagina = (uintptr_t)sysconf(_SC_PAGESIZE);
+        uintptr_t inicio = (uintptr_t)mapeado & ~(pagina - 1);
+        madvise((void*)inicio, tamanho + ((uintptr_t)mapeado - inicio), MADV_WILLNEED);
+        return;
+    }
+    posix_fadvise(fd, offset, (off_t)tamanho, POSIX_FADV_WILLNEED);
+}
+
+/*
+ * =================================================================================
+ * E/S em Lote
+ * =================================================================================
+ */
+
+/**
+ * @brief (Função Auxiliar Estática) Executa um pedido com io_ler_em/io_escrever_em,
+ * a partir do byte `feitos` (o que um envio assíncrono já tiver transferido).
+ */
+static void executar_pedido_sincrono(int fd, io_pedido* pedido, size_t feitos) {
+    char* buffer = (char*)pedido->buffer + feitos;
+    size_t restante = pedido->tamanho - feitos;
+    off_t offset = pedido->offset + (off_t)feitos;
+
+    ssize_t r = pedido->escrita ? io_escrever_em(fd, buffer, restante, offset)
+                                : io_ler_em(fd, buffer, restante, offset);
+    pedido->resultado = (r < 0) ? -(ssize_t)errno : (ssize_t)(feitos + (size_t)r);
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Fecha um pedido: contabiliza e avisa o chamador.
+ * @return 1 se o pedido transferiu todos os bytes, 0 caso contrário.
+ */
+static int concluir_pedido(io_pedido* pedido, io_conclusao ao_concluir, void* contexto) {
+    if (pedido->resultado > 0) contador_somar(&estatisticas_lotes.bytes, (uint64_t)pedido->resultado);
+    if (ao_concluir) ao_concluir(pedido, contexto);
+    return pedido->resultado == (ssize_t)pedido->tamanho;
+}
+
+#ifdef EXT2_IO_URING
+
+/*
+ * Anel do io_uring, criado no primeiro lote e mantido até io_lotes_finalizar.
+ * As chamadas são feitas direto por syscall(2), sem liburing.
+ */
+typedef struct {
+    int fd;
+    unsigned entradas;                  // Capacidade da fila de submissão
+    unsigned* sq_cabeca;
+    unsigned* sq_cauda;
+    unsigned* sq_mascara;
+    unsigned* sq_vetor;
+    struct io_uring_sqe* sqes;
+    unsigned* cq_cabeca;
+    unsigned* cq_cauda;
+    unsigned* cq_mascara;
+    struct io_uring_cqe* cqes;
+    void* mapa_sq;
+    size_t tamanho_mapa_sq;
+    void* mapa_cq;                      // Igual a mapa_sq com IORING_FEAT_SINGLE_MMAP
+    size_t tamanho_mapa_cq;
+    size_t tamanho_sqes;
+} anel_io_uring;
+
+static anel_io_uring anel = { .fd = -1 };
+static int io_uring_indisponivel = 0;   // Criação ou operação recusada pelo kernel: só síncrono
+static pthread_mutex_t trava_anel = PTHREAD_MUTEX_INITIALIZER;  // Um lote por vez no anel
+
+/**
+ * @brief (Função Auxiliar Estática) Desfaz os mapeamentos e fecha o anel.
+ */
+static void destruir_anel(void) {
+    if (anel.sqes && anel.sqes != MAP_FAILED) munmap(anel.sqes, anel.tamanho_sqes);
+    if (anel.mapa_cq && anel.mapa_cq != MAP_FAILED && anel.mapa_cq != anel.mapa_sq) munmap(anel.mapa_cq, anel.tamanho_mapa_cq);
+    if (anel.mapa_sq && anel.mapa_sq != MAP_FAILED) munmap(anel.mapa_sq, anel.tamanho_mapa_sq);
+    if (anel.fd >= 0) close(anel.fd);
+    memset(&anel, 0, sizeof(anel));
+    anel.fd = -1;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Cria o anel (io_uring_setup) e mapeia as filas.
+ * @return 0 em sucesso, -1 se o io_uring não estiver disponível.
+ */
+static int criar_anel(void) {
+    struct io_uring_params parametros;
+    memset(&parametros, 0, sizeof(parametros));
+
+    int fd = (int)syscall(__NR_io_uring_setup, IO_LOTE_PROFUNDIDADE, &parametros);
+    if (fd < 0) return -1;
+    anel.fd = fd;
+    anel.entradas = parametros.sq_entries;
+
+    anel.tamanho_mapa_sq = parametros.sq_off.array + parametros.sq_entries * sizeof(unsigned);
+    anel.tamanho_mapa_cq = parametros.cq_off.cqes + parametros.cq_entries * sizeof(struct io_uring_cqe);
+    int mapa_unico = (parametros.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (mapa_unico) {
+        if (anel.tamanho_mapa_cq > anel.tamanho_mapa_sq) anel.tamanho_mapa_sq = anel.tamanho_mapa_cq;
+        anel.tamanho_mapa_cq = anel.tamanho_mapa_sq;
+    }
+
+    anel.mapa_sq = mmap(NULL, anel.tamanho_mapa_sq, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (anel.mapa_sq == MAP_FAILED) { destruir_anel(); return -1; }
+    anel.mapa_cq = mapa_unico ? anel.mapa_sq
+                              : mmap(NULL, anel.tamanho_mapa_cq, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    if (anel.mapa_cq == MAP_FAILED) { destruir_anel(); return -1; }
+    anel.tamanho_sqes = parametros.sq_entries * sizeof(struct io_uring_sqe);
+    anel.sqes = mmap(NULL, anel.tamanho_sqes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (anel.sqes == MAP_FAILED) { destruir_anel(); return -1; }
+
+    char* sq = anel.mapa_sq;
+    char* cq = anel.mapa_cq;
+    anel.sq_cabeca  = (unsigned*)(sq + parametros.sq_off.head);
+    anel.sq_cauda   = (unsigned*)(sq + parametros.sq_off.tail);
+    anel.sq_mascara = (unsigned*)(sq + parametros.sq_off.ring_mask);
+    anel.sq_vetor   = (unsigned*)(sq + parametros.sq_off.array);
+    anel.cq_cabeca  = (unsigned*)(cq + parametros.cq_off.head);
+    anel.cq_cauda   = (unsigned*)(cq + parametros.cq_off.tail);
+    anel.cq_mascara = (unsigned*)(cq + parametros.cq_off.ring_mask);
+    anel.cqes       = (struct io_uring_cqe*)(cq + parametros.cq_off.cqes);
+    return 0;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Executa o lote pelo io_uring, mantendo até
+ * `anel.entradas` pedidos em voo. Pedidos que voltam com erro ou incompletos são
+ * refeitos de forma síncrona a partir de onde pararam.
+ *
+ * @return Número de pedidos que não transferiram todos os bytes, ou -1 se o anel
+ * falhar antes de aceitar algum pedido (o chamador refaz tudo de forma síncrona).
+ */
+static int executar_no_anel(int fd, io_pedido* pedidos, size_t quantidade, io_conclusao ao_concluir, void* contexto) {
+    size_t enviados = 0, concluidos = 0;
+    unsigned em_voo = 0;
+    int falhas = 0;
+
+    while (concluidos < quantidade) {
+        // Preenche a fila de submissão enquanto houver pedidos e espaço.
+        unsigned cauda = *anel.sq_cauda;
+        while (enviados < quantidade && em_voo < anel.entradas) {
+            io_pedido* pedido = &pedidos[enviados];
+            unsigned posicao = cauda & *anel.sq_mascara;
+            struct io_uring_sqe* sqe = &anel.sqes[posicao];
+            memset(sqe, 0, sizeof(*sqe));
+            sqe->opcode = pedido->escrita ? IORING_OP_WRITE : IORING_OP_READ;
+            sqe->fd = fd;
+            sqe->addr = (uint64_t)(uintptr_t)pedido->buffer;
+            sqe->len = (uint32_t)pedido->tamanho;
+            sqe->off = (uint64_t)pedido->offset;
+            sqe->user_data = enviados;
+            anel.sq_vetor[posicao] = posicao;
+            cauda++;
+            enviados++;
+            em_voo++;
+        }
+        __atomic_store_n(anel.sq_cauda, cauda, __ATOMIC_RELEASE);
+        if (em_voo > __atomic_load_n(&estatisticas_lotes.maior_profundidade, __ATOMIC_RELAXED)) {
+            __atomic_store_n(&estatisticas_lotes.maior_profundidade, em_voo, __ATOMIC_RELAXED);
+        }
+
+        // Entrega ao kernel o que ainda não foi consumido e espera ao menos uma conclusão.
+        unsigned a_enviar = cauda - __atomic_load_n(anel.sq_cabeca, __ATOMIC_ACQUIRE);
+        if (syscall(__NR_io_uring_enter, anel.fd, a_enviar, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY) continue;
+            if (concluidos == 0 && a_enviar == em_voo) {
+                // Nada foi aceito: descarta o anel e deixa o lote para o caminho síncrono.
+                destruir_anel();
+                io_uring_indisponivel = 1;
+                return -1;
+            }
+            perror("Erro (io_lote_executar): Falha em io_uring_enter");
+            destruir_anel();
+            io_uring_indisponivel = 1;
+            // Os pedidos ainda sem conclusão são refeitos um a um.
+            for (size_t i = 0; i < quantidade; ++i) {
+                if (pedidos[i].resultado != IO_PEDIDO_PENDENTE) continue;
+                executar_pedido_sincrono(fd, &pedidos[i], 0);
+                if (!concluir_pedido(&pedidos[i], ao_concluir, contexto)) falhas++;
+            }
+            return falhas;
+        }
+
+        // Colhe as conclusões disponíveis.
+        unsigned cabeca = *anel.cq_cabeca;
+        unsigned cauda_cq = __atomic_load_n(anel.cq_cauda, __ATOMIC_ACQUIRE);
+        while (cabeca != cauda_cq) {
+            struct io_uring_cqe* cqe = &anel.cqes[cabeca & *anel.cq_mascara];
+            io_pedido* pedido = &pedidos[cqe->user_data];
+            int res = cqe->res;
+            cabeca++;
+            em_voo--;
+            concluidos++;
+
+            if (res == -EINVAL || res == -EOPNOTSUPP) {
+                io_uring_indisponivel = 1;  // Kernel sem IORING_OP_READ/WRITE: os próximos lotes são síncronos
+            }
+            if (res < 0) {
+                executar_pedido_sincrono(fd, pedido, 0);
+            } else if ((size_t)res < pedido->tamanho) {
+                executar_pedido_sincrono(fd, pedido, (size_t)res);
+            } else {
+                pedido->resultado = res;
+            }
+            if (!concluir_pedido(pedido, ao_concluir, contexto)) falhas++;
+        }
+        __atomic_store_n(anel.cq_cabeca, cabeca, __ATOMIC_RELEASE);
+    }
+    return falhas;
+}
+
+#endif // EXT2_IO_URING
+
+/**
+ * @brief Executa um lote de leituras e escritas independentes sobre o mesmo arquivo.
+ *
+ * Com o build EXT2_IO_URING (make IO_URING=1), os pedidos são enviados juntos ao
+ * io_uring, com até IO_LOTE_PROFUNDIDADE em voo, e concluídos na ordem em que o
+ * dispositivo os terminar. Sem ele, se o kernel recusar o io_uring ou no modo
+ * --mmap, os pedidos são executados em ordem com pread/pwrite (ou memcpy).
+ *
+ * Cada pedido tem `resultado` preenchido com o total de bytes transferidos ou com
+ * -errno, e `ao_concluir` (se não for NULL) é chamada uma vez por pedido logo
+ * após sua conclusão. Os pedidos não podem se sobrepor entre si.
+ *
+ * @param fd O descritor do arquivo.
+ * @param pedidos Vetor de pedidos.
+ * @param quantidade Tamanho do vetor.
+ * @param ao_concluir Função chamada a cada conclusão (pode ser NULL).
+ * @param contexto Ponteiro repassado a `ao_concluir`.
+ * @return 0 se todos os pedidos transferiram todos os bytes, -1 caso contrário.
+ */
+int io_lote_executar(int fd, io_pedido* pedidos, size_t quantidade, io_conclusao ao_concluir, void* contexto) {
+    if (quantidade == 0) return 0;
+    if (!pedidos) return -1;
+
+    for (size_t i = 0; i < quantidade; ++i) pedidos[i].resultado = IO_PEDIDO_PENDENTE;
+    contador_somar(&estatisticas_lotes.lotes, 1);
+    contador_somar(&estatisticas_lotes.pedidos, quantidade);
+
+#ifdef EXT2_IO_URING
+    if (quantidade > 1 && !io_uring_indisponivel && !io_imagem_mapeada(fd)) {
+        // O anel não é compartilhável: lotes de threads diferentes passam por ele em fila.
+        pthread_mutex_lock(&trava_anel);
+        int falhas = -1;
+        if (anel.fd < 0 && !io_uring_indisponivel && criar_anel() != 0) io_uring_indisponivel = 1;
+        if (anel.fd >= 0) falhas = executar_no_anel(fd, pedidos, quantidade, ao_concluir, contexto);
+        pthread_mutex_unlock(&trava_anel);
+        if (falhas >= 0) {
+            contador_somar(&estatisticas_lotes.lotes_assincronos, 1);
+            return (falhas == 0) ? 0 : -1;
+        }
+    }
+#endif
+
+    int falhas = 0;
+    for (size_t i = 0; i < quantidade; ++i) {
+        executar_pedido_sincrono(fd, &pedidos[i], 0);
+        if (!concluir_pedido(&pedidos[i], ao_concluir, contexto)) falhas++;
+    }
+    uint32_t sem_profundidade = 0;
+    __atomic_compare_exchange_n(&estatisticas_lotes.maior_profundidade, &sem_profundidade, 1, 0,
+                                __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+    return (falhas == 0) ? 0 : -1;
+}
+
+/**
+ * @brief Nome do mecanismo usado pelos próximos lotes ("io_uring" ou "síncrono").
+ */
+const char* io_lote_mecanismo(void) {
+#ifdef EXT2_IO_URING
+    if (!io_uring_indisponivel) return "io_uring";
+#endif
+    return "síncrono";
+}
+
+/**
+ * @brief Copia os contadores atuais da E/S em lote.
+ */
+void io_lote_obter_estatisticas(estatisticas_io_lotes* est) {
+    if (est) *est = estatisticas_lotes;
+}
+
+/**
+ * @brief Libera o anel do io_uring (se existir). Chamada no encerramento do shell.
+ */
+void io_lotes_finalizar(void) {
+#ifdef EXT2_IO_URING
+    if (anel.fd >= 0) destruir_anel();
+#endif
+}
+
+/*
+ * =================================================================================
+ * Backend Mapeado em Memória
+ * =================================================================================
+ */
+
+/**
+ * @brief Mapeia a imagem inteira em memória (MAP_SHARED, leitura e escrita).
+ *
+ * A partir daqui, io_ler_em/io_escrever_em sobre este descritor viram memcpy e
+ * `io_ponteiro_em` permite acessar blocos sem cópia nenhuma.
+ *
+ * @param fd O descritor da imagem, aberto com O_RDWR.
+ * @return 0 em sucesso, -1 em erro (a imagem continua acessível via pread/pwrite).
+ */
+int io_mapear_imagem(int fd) {
+    struct stat info;
+    if (fstat(fd, &info) == -1) {
+        perror("Erro (io_mapear_imagem): Falha ao obter o tamanho da imagem");
+        return -1;
+    }
+    if (info.st_size <= 0) {
+        fprintf(stderr, "Erro (io_mapear_imagem): A imagem está vazia.\n");
+        return -1;
+    }
+
+    void* mapa = mmap(NULL, (size_t)info.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapa == MAP_FAILED) {
+        perror("Erro (io_mapear_imagem): Falha ao mapear a imagem em memória");
+        return -1;
+    }
+
+    io_desmapear_imagem();
+    mapa_imagem = mapa;
+    tamanho_mapa = (size_t)info.st_size;
+    fd_mapeado = fd;
+    return 0;
+}
+
+/**
+ * @brief Informa se o descritor `fd` está sendo acessado pelo mapeamento.
+ */
+int io_imagem_mapeada(int fd) {
+    return mapa_imagem != NULL && fd == fd_mapeado;
+}
+
+/**
+ * @brief Retorna um ponteiro para a região [offset, offset + tamanho) da imagem mapeada.
+ *
+ * @return O ponteiro dentro do mapeamento, ou NULL se a imagem não estiver mapeada
+ * ou se a região sair dos limites do arquivo.
+ */
+void* io_ponteiro_em(int fd, off_t offset, size_t tamanho) {
+    if (!io_imagem_mapeada(fd) || offset < 0) return NULL;
+    if ((size_t)offset > tamanho_mapa || tamanho > tamanho_mapa - (size_t)offset) return NULL;
+    return mapa_imagem + offset;
+}
+
+/**
+ * @brief Força a gravação das páginas alteradas do mapeamento na imagem.
+ * @return 0 em sucesso (ou se nada estiver mapeado), -1 em erro.
+ */
+int io_sincronizar_mapa(void) {
+    if (!mapa_imagem) return 0;
+    if (msync(mapa_imagem, tamanho_mapa, MS_SYNC) == -1) {
+        perror("Erro (io_sincronizar_mapa): Falha ao sincronizar o mapeamento");
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Desfaz o mapeamento da imagem (as alterações já estão no page cache do arquivo).
+ */
+void io_desmapear_imagem(void) {
+    if (mapa_imagem) {
+        munmap(mapa_imagem, tamanho_mapa);
+    }
+    mapa_imagem = NULL;
+    tamanho_mapa = 0;
+    fd_mapeado = -1;
+}
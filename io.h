@@ -0,0 +1,95 @@
+/**
+ * @file       io.h
+ * @brief      Declaração da camada de E/S posicional usada para acessar a imagem do disco.
+ *
+ *  @author     Allan Custódio Diniz Marques (L33tSh4rk)
+ *
+ * Todas as leituras e escritas na imagem passam por estas funções, que usam
+ * pread/pwrite (sem mover o offset compartilhado do descritor) e repetem a
+ * chamada em leituras/escritas parciais ou interrompidas por sinal (EINTR).
+ * Uma região contígua pode ser lida para vários buffers de uma vez (preadv).
+ * Opcionalmente, a imagem inteira pode ser mapeada em memória (mmap); nesse caso
+ * os acessos viram cópias diretas da/para a região mapeada.
+ *
+ * Leituras e escritas independentes podem ser agrupadas em lotes (io_lote_executar).
+ * Com o build EXT2_IO_URING o lote inteiro é enviado ao io_uring de uma vez, o que
+ * mantém vários pedidos em voo no dispositivo; sem ele (ou se o kernel recusar),
+ * os pedidos são executados um a um, com o mesmo resultado.
+ *
+ * Data de criação: 16 de outubro de 2026
+ * Data de atualização: 16 de outubro de 2026
+ *
+ */
+
+#ifndef EXT2_IO_H
+#define EXT2_IO_H
+
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Máximo de buffers de uma chamada a io_ler_vetor_em.
+#define IO_MAX_VETOR 256
+
+// Máximo de pedidos de um lote em voo ao mesmo tempo (tamanho do anel do io_uring).
+#define IO_LOTE_PROFUNDIDADE 64
+
+// Valor de io_pedido.resultado enquanto o pedido não foi concluído.
+#define IO_PEDIDO_PENDENTE ((ssize_t)-0x40000000)
+
+/*
+ * Um pedido de um lote: ler ou escrever `tamanho` bytes na posição `offset`.
+ */
+typedef struct {
+    int escrita;                    // 0 = leitura, 1 = escrita
+    void* buffer;
+    size_t tamanho;
+    off_t offset;
+    ssize_t resultado;              // Preenchido na conclusão: bytes transferidos ou -errno
+    uint32_t marcador;              // Livre para o chamador (ex: índice de uma entrada de cache)
+} io_pedido;
+
+// Chamada uma vez para cada pedido, assim que ele é concluído.
+typedef void (*io_conclusao)(io_pedido* pedido, void* contexto);
+
+/*
+ * Contadores da E/S em lote (comando 'stats').
+ */
+typedef struct {
+    uint64_t lotes;                 // Lotes executados
+    uint64_t lotes_assincronos;     // Lotes enviados ao io_uring
+    uint64_t pedidos;               // Pedidos somando todos os lotes
+    uint64_t bytes;                 // Bytes transferidos pelos pedidos
+    uint32_t maior_profundidade;    // Maior número de pedidos em voo ao mesmo tempo
+} estatisticas_io_lotes;
+
+/* E/S posicional com tratamento de leituras/escritas parciais */
+ssize_t io_ler_em(int fd, void* buffer, size_t tamanho, off_t offset);
+ssize_t io_escrever_em(int fd, const void* buffer, size_t tamanho, off_t offset);
+ssize_t io_ler_vetor_em(int fd, const struct iovec* vetor, int quantidade, off_t offset);
+
+/* Cópia entre arquivos no kernel (copy_file_range, sendfile ou pread/pwrite) */
+ssize_t io_copiar_intervalo(int fd_origem, off_t offset_origem, int fd_destino, off_t offset_destino, size_t tamanho);
+
+/* Arquivos esparsos (buracos) */
+int io_abrir_buraco(int fd, off_t offset, off_t tamanho);
+off_t io_procurar_dados(int fd, off_t offset, off_t tamanho, off_t* fim_dados);
+
+/* Leitura antecipada (posix_fadvise / madvise) */
+void io_antecipar(int fd, off_t offset, size_t tamanho);
+
+/* E/S em lote (io_uring ou síncrona) */
+int io_lote_executar(int fd, io_pedido* pedidos, size_t quantidade, io_conclusao ao_concluir, void* contexto);
+const char* io_lote_mecanismo(void);
+void io_lote_obter_estatisticas(estatisticas_io_lotes* est);
+void io_lotes_finalizar(void);
+
+/* Backend mapeado em memória (modo --mmap) */
+int io_mapear_imagem(int fd);
+int io_imagem_mapeada(int fd);
+void* io_ponteiro_em(int fd, off_t offset, size_t tamanho);
+int io_sincronizar_mapa(void);
+void io_desmapear_imagem(void);
+
+#endif // EXT2_IO_H
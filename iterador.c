@@ -0,0 +1,434 @@
+/**
+ * @file       iterador.c
+ * @brief      Implementação do iterador de blocos de um inode.
+ *
+ * @author     Allan Custódio Diniz Marques (L33tSh4rk)
+ *
+ * Substitui as várias cópias do laço "12 diretos, depois L1, depois L2" que existiam
+ * em ls, rm, rename, leitura de arquivos e manipulação de diretórios. Além de cobrir a
+ * indireção tripla, evita o malloc de um buffer de L2 a cada ponteiro de L1.
+ *
+ * Data de criação: 16 de outubro de 2026
+ * Data de atualização: 16 de outubro de 2026
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "iterador.h"
+#include "buffers.h"
+#include "cache.h"
+#include "io.h"
+#include "travas.h"
+
+// Primeira janela da leitura antecipada, em blocos; ela dobra a cada pedido.
+#define ITER_ANTECIPACAO_INICIAL 4
+
+// Máximo de blocos de ponteiros irmãos lidos de uma vez (ler_blocos) ao descer na árvore.
+#define ITER_LEQUE_MAXIMO 32
+
+// Configuração e contadores da leitura antecipada (compartilhados por todos os iteradores).
+static uint32_t janela_maxima_ra = ITER_ANTECIPACAO_PADRAO;
+static estatisticas_antecipacao estatisticas_ra;
+
+/*
+ * =================================================================================
+ * Leitura Antecipada
+ * =================================================================================
+ */
+
+/**
+ * @brief (Função Auxiliar Estática) Resolve um bloco lógico usando apenas as tabelas de
+ * ponteiros que já estão nos buffers do iterador (nunca lê o disco).
+ *
+ * @param ponteiros_faltando Recebe o bloco de ponteiros que precisaria ser lido para
+ * continuar a descida (0 se nenhum faltou).
+ * @return O bloco físico, ou 0 se for um buraco ou se a descida parou num bloco ausente.
+ */
+static uint32_t resolver_em_memoria(const iterador_blocos* it, uint32_t logico, uint32_t* ponteiros_faltando) {
+    const uint64_t p = it->ponteiros_por_bloco;
+    *ponteiros_faltando = 0;
+    if (logico < 12) return it->ponteiros[logico];
+
+    uint64_t deslocamento = (uint64_t)logico - 12;
+    uint64_t cobertura = p;
+    int niveis_indiretos = 1;
+    while (niveis_indiretos < 3 && deslocamento >= cobertura) {
+        deslocamento -= cobertura;
+        niveis_indiretos++;
+        cobertura *= p;
+    }
+    if (deslocamento >= cobertura) return 0;
+
+    uint32_t ponteiro = it->ponteiros[11 + niveis_indiretos];
+    for (int nivel = 0; nivel < niveis_indiretos; ++nivel) {
+        if (ponteiro == 0) return 0;
+        if (it->bloco_do_nivel[nivel] != ponteiro) {
+            *ponteiros_faltando = ponteiro;
+            return 0;
+        }
+        cobertura /= p;
+        ponteiro = it->niveis[nivel][(deslocamento / cobertura) % p];
+    }
+    return ponteiro;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Avisa o kernel sobre uma sequência de blocos físicos.
+ */
+static void antecipar_sequencia(const iterador_blocos* it, uint32_t inicio, uint32_t quantidade) {
+    if (quantidade == 0) return;
+    uint32_t tamanho_bloco = it->ponteiros_por_bloco * sizeof(uint32_t);
+    io_antecipar(it->fd, (off_t)inicio * tamanho_bloco, (size_t)quantidade * tamanho_bloco);
+    contador_somar(&estatisticas_ra.pedidos, 1);
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Chamada a cada bloco de dados devolvido: quando a
+ * leitura entra na última janela pedida, pede a seguinte (com o dobro do tamanho).
+ *
+ * Assim sempre há uma janela à frente do leitor. Um salto para além do que já foi
+ * pedido (buraco grande ou iterador_blocos_restringir) recomeça com a janela mínima.
+ * Se a janela esbarrar num bloco de ponteiros ainda não carregado, o próximo pedido
+ * só acontece quando o leitor chegar a ele (e o iterador já o tiver lido). Blocos
+ * que já estão no cache de blocos não geram aviso.
+ */
+static void antecipar(iterador_blocos* it, uint32_t logico) {
+    if (it->ra_janela == 0 || logico > it->ra_proximo) {
+        it->ra_janela = (janela_maxima_ra < ITER_ANTECIPACAO_INICIAL) ? janela_maxima_ra : ITER_ANTECIPACAO_INICIAL;
+        it->ra_proximo = logico + 1;
+        it->ra_gatilho = logico;
+    }
+    if (logico < it->ra_gatilho) return;
+
+    uint32_t inicio = (it->ra_proximo > logico) ? it->ra_proximo : logico + 1;
+    if (inicio >= it->limite_logico) return;
+    uint32_t fim = (it->limite_logico - inicio > it->ra_janela) ? inicio + it->ra_janela : it->limite_logico;
+    it->ra_gatilho = inicio;
+    it->ra_proximo = fim;
+    it->ra_janela = (it->ra_janela * 2 < janela_maxima_ra) ? it->ra_janela * 2 : janela_maxima_ra;
+
+    uint32_t seq_inicio = 0, seq_blocos = 0;
+    for (uint32_t l = inicio; l < fim; ++l) {
+        uint32_t faltando;
+        uint32_t fisico = resolver_em_memoria(it, l, &faltando);
+        if (faltando != 0) {
+            // O resto da janela depende de um bloco de ponteiros ainda não lido: antecipa
+            // esse bloco e retoma daqui quando o iterador já o tiver carregado.
+            if (!cache_blocos_contem(faltando)) {
+                antecipar_sequencia(it, faltando, 1);
+                contador_somar(&estatisticas_ra.blocos_de_ponteiros, 1);
+            }
+            it->ra_proximo = it->ra_gatilho = l;
+            break;
+        }
+        if (fisico == 0) continue;
+        if (cache_blocos_contem(fisico)) {
+            // Já está na RAM: nada a antecipar, e a sequência a avisar termina aqui.
+            antecipar_sequencia(it, seq_inicio, seq_blocos);
+            seq_blocos = 0;
+            continue;
+        }
+        contador_somar(&estatisticas_ra.blocos_de_dados, 1);
+        if (seq_blocos > 0 && fisico == seq_inicio + seq_blocos) {
+            seq_blocos++;
+            continue;
+        }
+        antecipar_sequencia(it, seq_inicio, seq_blocos);
+        seq_inicio = fisico;
+        seq_blocos = 1;
+    }
+    antecipar_sequencia(it, seq_inicio, seq_blocos);
+}
+
+
+/*
+ * =================================================================================
+ * Iteração
+ * =================================================================================
+ */
+
+/**
+ * @brief Prepara a iteração sobre os blocos de um inode.
+ *
+ * Sem ITER_IGNORAR_TAMANHO, a iteração para no último bloco coberto por i_size.
+ *
+ * @param it O iterador a ser preparado.
+ * @param fd O descritor de arquivo.
+ * @param sb O superbloco.
+ * @param ino O inode cujos blocos serão visitados (o mapa de blocos é copiado).
+ * @param flags Combinação de ITER_BLOCOS_INDIRETOS, ITER_IGNORAR_TAMANHO e ITER_ANTECIPAR.
+ * @return 0 em sucesso, -1 em erro de alocação.
+ */
+int iterador_blocos_iniciar(iterador_blocos* it, int fd, const superbloco* sb, const inode* ino, int flags) {
+    memset(it, 0, sizeof(*it));
+
+    uint32_t tamanho_bloco = calcular_tamanho_do_bloco(sb);
+    it->fd = fd;
+    it->sb = sb;
+    it->flags = flags;
+    it->ponteiros_por_bloco = tamanho_bloco / sizeof(uint32_t);
+    memcpy(it->ponteiros, ino->block, sizeof(it->ponteiros));
+
+    // Um buffer do pool por nível de indireção.
+    for (int nivel = 0; nivel < 3; ++nivel) {
+        it->niveis[nivel] = buffer_bloco_obter();
+        if (!it->niveis[nivel]) {
+            fprintf(stderr, "Erro (iterador_blocos_iniciar): Falha ao obter os buffers de ponteiros.\n");
+            iterador_blocos_finalizar(it);
+            return -1;
+        }
+    }
+
+    uint64_t p = it->ponteiros_por_bloco;
+    uint64_t enderecaveis = 12 + p + p * p + p * p * p;
+    if (enderecaveis > UINT32_MAX) enderecaveis = UINT32_MAX;
+
+    if (flags & ITER_IGNORAR_TAMANHO) {
+        it->limite_logico = (uint32_t)enderecaveis;
+    } else {
+        uint64_t blocos_do_tamanho = ((uint64_t)ino->size + tamanho_bloco - 1) / tamanho_bloco;
+        it->limite_logico = (uint32_t)(blocos_do_tamanho < enderecaveis ? blocos_do_tamanho : enderecaveis);
+    }
+    return 0;
+}
+
+/**
+ * @brief Restringe a iteração aos blocos lógicos [primeiro, fim).
+ *
+ * Deve ser chamada logo após iterador_blocos_iniciar. Como a descida pelos
+ * ponteiros começa direto em `primeiro`, só os blocos de ponteiros do caminho até
+ * o intervalo são lidos; os anteriores nunca são tocados.
+ *
+ * @param it O iterador.
+ * @param primeiro O primeiro bloco lógico a visitar.
+ * @param fim O primeiro bloco lógico fora do intervalo.
+ */
+void iterador_blocos_restringir(iterador_blocos* it, uint32_t primeiro, uint32_t fim) {
+    if (fim < it->limite_logico) it->limite_logico = fim;
+    it->proximo_logico = (primeiro < it->limite_logico) ? primeiro : it->limite_logico;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Lê para o cache de blocos, com uma única chamada a
+ * ler_blocos, o bloco de ponteiros irmaos[0] e os irmãos seguintes que a iteração
+ * ainda vai visitar (até ITER_LEQUE_MAXIMO). Os que já estão no cache são pulados.
+ * Sem o cache de blocos não há onde guardá-los, e nada é feito.
+ */
+static void ler_irmaos_em_leque(iterador_blocos* it, const uint32_t* irmaos, uint32_t restantes) {
+    uint32_t nums[ITER_LEQUE_MAXIMO];
+    void* destinos[ITER_LEQUE_MAXIMO];
+    uint32_t quantidade = 0;
+
+    if (restantes > ITER_LEQUE_MAXIMO) restantes = ITER_LEQUE_MAXIMO;
+    for (uint32_t i = 0; i < restantes; ++i) {
+        if (irmaos[i] != 0 && !cache_blocos_contem(irmaos[i])) nums[quantidade++] = irmaos[i];
+    }
+    if (quantidade < 2) return;     // Um só bloco: a leitura normal já resolve
+
+    uint32_t obtidos = 0;
+    while (obtidos < quantidade && (destinos[obtidos] = buffer_bloco_obter()) != NULL) obtidos++;
+    // Só uma otimização: sem buffers, a descida lê os blocos um a um.
+    if (obtidos == quantidade) ler_blocos(it->fd, it->sb, nums, quantidade, destinos);
+    for (uint32_t i = 0; i < obtidos; ++i) buffer_bloco_devolver(destinos[i]);
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Garante que o bloco de ponteiros pedido esteja no nível indicado.
+ *
+ * Se o bloco ainda não estiver no cache de blocos, ele é lido junto com os irmãos
+ * seguintes (`irmaos`, `restantes`: o trecho da tabela do nível de cima que a
+ * iteração ainda vai percorrer, começando por ele).
+ *
+ * @return A tabela de ponteiros, ou NULL se o bloco não puder ser lido.
+ */
+static const uint32_t* carregar_nivel(iterador_blocos* it, int nivel, uint32_t num_bloco,
+                                      const uint32_t* irmaos, uint32_t restantes) {
+    if (it->bloco_do_nivel[nivel] == num_bloco) return it->niveis[nivel];
+
+    if (irmaos && restantes > 1 && cache_blocos_ativo() && !cache_blocos_contem(num_bloco)) {
+        ler_irmaos_em_leque(it, irmaos, restantes);
+    }
+
+    if (ler_bloco(it->fd, it->sb, num_bloco, it->niveis[nivel]) != 0) {
+        it->bloco_do_nivel[nivel] = 0;
+        it->erro = 1;
+        return NULL;
+    }
+    it->bloco_do_nivel[nivel] = num_bloco;
+    if (it->flags & ITER_BLOCOS_INDIRETOS) {
+        it->pendentes[it->num_pendentes++] = num_bloco;
+    }
+    return it->niveis[nivel];
+}
+
+/**
+ * @brief Avança para o próximo bloco alocado do inode.
+ *
+ * Com ITER_BLOCOS_INDIRETOS, cada bloco de ponteiros é devolvido (com logico igual a
+ * ITER_LOGICO_INDIRETO) antes dos blocos que ele endereça. Como o conteúdo já está
+ * nos buffers do iterador, o chamador pode liberá-lo imediatamente.
+ *
+ * @param it O iterador.
+ * @param bloco_logico Recebe o índice do bloco dentro do arquivo.
+ * @param bloco_fisico Recebe o número do bloco no disco.
+ * @return 1 se um bloco foi devolvido, 0 no fim da iteração.
+ */
+int iterador_blocos_proximo(iterador_blocos* it, uint32_t* bloco_logico, uint32_t* bloco_fisico) {
+    const uint64_t p = it->ponteiros_por_bloco;
+
+    if (it->tem_adiantado) {
+        it->tem_adiantado = 0;
+        *bloco_logico = it->adiantado_logico;
+        *bloco_fisico = it->adiantado_fisico;
+        return 1;
+    }
+
+    for (;;) {
+        if (it->num_pendentes > 0) {
+            *bloco_logico = ITER_LOGICO_INDIRETO;
+            *bloco_fisico = it->pendentes[0];
+            it->num_pendentes--;
+            memmove(it->pendentes, it->pendentes + 1, it->num_pendentes * sizeof(uint32_t));
+            return 1;
+        }
+        if (it->proximo_logico >= it->limite_logico) return 0;
+
+        uint64_t logico = it->proximo_logico;
+        uint32_t ponteiro;
+        uint64_t cobertura = 1;     // Blocos lógicos cobertos pelo ponteiro atual
+
+        if (logico < 12) {
+            ponteiro = it->ponteiros[logico];
+        } else {
+            // Descobre a região (simples, dupla ou tripla) e o deslocamento dentro dela.
+            uint64_t deslocamento = logico - 12;
+            int niveis_indiretos = 1;
+            cobertura = p;
+            while (niveis_indiretos < 3 && deslocamento >= cobertura) {
+                deslocamento -= cobertura;
+                niveis_indiretos++;
+                cobertura *= p;
+            }
+            if (deslocamento >= cobertura) {
+                it->proximo_logico = it->limite_logico;
+                return 0;
+            }
+
+            ponteiro = it->ponteiros[11 + niveis_indiretos];
+            const uint32_t* irmaos = NULL;
+            uint32_t restantes = 0;
+            for (int nivel = 0; nivel < niveis_indiretos && ponteiro != 0; ++nivel) {
+                const uint32_t* tabela = carregar_nivel(it, nivel, ponteiro, irmaos, restantes);
+                if (!tabela) {
+                    ponteiro = 0;   // Pula a sub-árvore ilegível inteira
+                    break;
+                }
+                cobertura /= p;
+                uint32_t indice = (uint32_t)((deslocamento / cobertura) % p);
+                ponteiro = tabela[indice];
+
+                // Irmãos do filho escolhido que a iteração ainda vai visitar.
+                uint64_t inicio_filho = logico - deslocamento % cobertura;
+                uint64_t filhos = (it->limite_logico - inicio_filho + cobertura - 1) / cobertura;
+                irmaos = &tabela[indice];
+                restantes = (uint32_t)((filhos < p - indice) ? filhos : p - indice);
+            }
+            if (ponteiro == 0) {
+                cobertura -= deslocamento % cobertura;
+            }
+        }
+
+        if (ponteiro == 0) {
+            // Buraco: avança até o fim da sub-árvore que o ponteiro nulo cobriria.
+            uint64_t seguinte = logico + cobertura;
+            it->proximo_logico = (seguinte < it->limite_logico) ? (uint32_t)seguinte : it->limite_logico;
+            continue;
+        }
+
+        // Blocos de ponteiros recém-lidos saem antes; este bloco é resolvido de novo
+        // na próxima chamada, já com as tabelas nos buffers.
+        if (it->num_pendentes > 0) continue;
+
+        it->proximo_logico = (uint32_t)logico + 1;
+        *bloco_logico = (uint32_t)logico;
+        *bloco_fisico = ponteiro;
+        if ((it->flags & ITER_ANTECIPAR) && janela_maxima_ra > 0) antecipar(it, (uint32_t)logico);
+        return 1;
+    }
+}
+
+/**
+ * @brief Avança para a próxima sequência de blocos contíguos do inode.
+ *
+ * Uma sequência reúne blocos consecutivos tanto no arquivo quanto no disco, de modo
+ * que [bloco_fisico, bloco_fisico + quantidade) pode ser lido de uma só vez. Blocos
+ * de ponteiros (ITER_BLOCOS_INDIRETOS) saem sempre sozinhos.
+ *
+ * @param it O iterador.
+ * @param bloco_logico Recebe o índice do primeiro bloco da sequência dentro do arquivo.
+ * @param bloco_fisico Recebe o número do primeiro bloco da sequência no disco.
+ * @param quantidade Recebe o número de blocos da sequência.
+ * @return 1 se uma sequência foi devolvida, 0 no fim da iteração.
+ */
+int iterador_blocos_proxima_sequencia(iterador_blocos* it, uint32_t* bloco_logico, uint32_t* bloco_fisico, uint32_t* quantidade) {
+    if (!iterador_blocos_proximo(it, bloco_logico, bloco_fisico)) return 0;
+    *quantidade = 1;
+    if (*bloco_logico == ITER_LOGICO_INDIRETO) return 1;
+
+    uint32_t logico, fisico;
+    while (iterador_blocos_proximo(it, &logico, &fisico)) {
+        if (logico != ITER_LOGICO_INDIRETO && logico == *bloco_logico + *quantidade &&
+            fisico == *bloco_fisico + *quantidade && *quantidade < UINT32_MAX) {
+            (*quantidade)++;
+            continue;
+        }
+        // Fim da sequência: o par lido fica guardado para a próxima chamada.
+        it->tem_adiantado = 1;
+        it->adiantado_logico = logico;
+        it->adiantado_fisico = fisico;
+        break;
+    }
+    return 1;
+}
+
+/**
+ * @brief Libera os buffers do iterador.
+ */
+void iterador_blocos_finalizar(iterador_blocos* it) {
+    if (!it) return;
+    for (int nivel = 0; nivel < 3; ++nivel) {
+        buffer_bloco_devolver(it->niveis[nivel]);
+        it->niveis[nivel] = NULL;
+    }
+}
+
+
+/*
+ * =================================================================================
+ * Configuração
+ * =================================================================================
+ */
+
+/**
+ * @brief Define a janela máxima da leitura antecipada, em blocos (0 desativa).
+ */
+void iterador_configurar_antecipacao(uint32_t janela_maxima) {
+    janela_maxima_ra = janela_maxima;
+}
+
+/**
+ * @brief Retorna a janela máxima atual da leitura antecipada, em blocos.
+ */
+uint32_t iterador_janela_antecipacao(void) {
+    return janela_maxima_ra;
+}
+
+/**
+ * @brief Copia os contadores atuais da leitura antecipada.
+ */
+void iterador_obter_estatisticas_antecipacao(estatisticas_antecipacao* est) {
+    if (est) *est = estatisticas_ra;
+}
@@ -0,0 +1,97 @@
+/**
+ * @file       iterador.h
+ * @brief      Declaração do iterador de blocos de um inode (diretos e indiretos).
+ *
+ *  @author     Allan Custódio Diniz Marques (L33tSh4rk)
+ *
+ * O iterador percorre o mapa de blocos de um inode e devolve, em ordem, os pares
+ * (bloco lógico, bloco físico) dos blocos alocados, descendo pelos três níveis de
+ * indireção. Os blocos de ponteiros ficam em buffers próprios (um por nível) e só
+ * são relidos quando a descida passa para outro bloco; ponteiros nulos fazem o
+ * iterador pular de uma vez toda a sub-árvore que eles cobririam.
+ *
+ * Todo código que precisa visitar os blocos de um arquivo ou diretório deve usar
+ * este iterador, que é o ponto único para otimizações de leitura (prefetch, lotes).
+ * Blocos lógica e fisicamente consecutivos podem ser pedidos já agrupados em
+ * sequências (extents), para que cada uma vire uma única leitura grande.
+ *
+ * Com ITER_ANTECIPAR, o iterador avisa o kernel (posix_fadvise/madvise) dos blocos
+ * que virão a seguir, numa janela que começa pequena e dobra enquanto o acesso
+ * continua sequencial. Os blocos físicos da janela são tirados das tabelas de
+ * ponteiros já carregadas; quando a janela alcança um bloco de ponteiros ainda não
+ * lido, é ele que é antecipado.
+ *
+ * Data de criação: 16 de outubro de 2026
+ * Data de atualização: 16 de outubro de 2026
+ *
+ */
+
+#ifndef EXT2_ITERADOR_H
+#define EXT2_ITERADOR_H
+
+#include "headers.h"
+
+/* Flags de iterador_blocos_iniciar */
+#define ITER_BLOCOS_INDIRETOS   0x1     // Também devolve os blocos de ponteiros (logico = ITER_LOGICO_INDIRETO)
+#define ITER_IGNORAR_TAMANHO    0x2     // Percorre todos os ponteiros, mesmo além de i_size
+#define ITER_ANTECIPAR          0x4     // Leitura antecipada: o chamador vai ler os blocos devolvidos, em ordem
+
+// Janela máxima padrão da leitura antecipada, em blocos (0 desativa).
+#define ITER_ANTECIPACAO_PADRAO 128
+
+// Valor de 'logico' para blocos de ponteiros (só com ITER_BLOCOS_INDIRETOS).
+#define ITER_LOGICO_INDIRETO    0xFFFFFFFFu
+
+/*
+ * Estado de uma iteração. Os campos são internos; o único que os chamadores
+ * consultam é `erro`, que indica que algum bloco de ponteiros não pôde ser lido
+ * (a sub-árvore correspondente foi pulada).
+ */
+typedef struct {
+    int fd;
+    const superbloco* sb;
+    uint32_t ponteiros[15];         // Cópia de inode.block: o inode pode mudar durante a iteração
+    uint32_t ponteiros_por_bloco;
+    int flags;
+
+    uint32_t proximo_logico;        // Próximo bloco lógico a resolver
+    uint32_t limite_logico;         // Primeiro bloco lógico fora da iteração
+
+    uint32_t* niveis[3];            // Blocos de ponteiros carregados, por profundidade
+    uint32_t bloco_do_nivel[3];     // Número físico de cada um deles (0 = vazio)
+
+    uint32_t pendentes[3];          // Blocos de ponteiros recém-carregados a devolver
+    int num_pendentes;
+
+    uint32_t ra_proximo;            // Leitura antecipada: primeiro bloco lógico ainda não pedido
+    uint32_t ra_gatilho;            // Bloco lógico cuja leitura dispara o pedido da próxima janela
+    uint32_t ra_janela;             // Tamanho da próxima janela (dobra a cada pedido)
+
+    int tem_adiantado;              // 1 se o par abaixo já foi lido e ainda não devolvido
+    uint32_t adiantado_logico;      // (usado por iterador_blocos_proxima_sequencia)
+    uint32_t adiantado_fisico;
+
+    int erro;
+} iterador_blocos;
+
+/*
+ * Contadores da leitura antecipada (comando 'stats').
+ */
+typedef struct {
+    uint64_t pedidos;               // Avisos enviados ao kernel (posix_fadvise/madvise)
+    uint64_t blocos_de_dados;       // Blocos de dados antecipados
+    uint64_t blocos_de_ponteiros;   // Blocos de ponteiros antecipados
+} estatisticas_antecipacao;
+
+int iterador_blocos_iniciar(iterador_blocos* it, int fd, const superbloco* sb, const inode* ino, int flags);
+void iterador_blocos_restringir(iterador_blocos* it, uint32_t primeiro, uint32_t fim);
+int iterador_blocos_proximo(iterador_blocos* it, uint32_t* bloco_logico, uint32_t* bloco_fisico);
+int iterador_blocos_proxima_sequencia(iterador_blocos* it, uint32_t* bloco_logico, uint32_t* bloco_fisico, uint32_t* quantidade);
+void iterador_blocos_finalizar(iterador_blocos* it);
+
+/* Leitura antecipada (vale para os iteradores criados com ITER_ANTECIPAR) */
+void iterador_configurar_antecipacao(uint32_t janela_maxima);
+uint32_t iterador_janela_antecipacao(void);
+void iterador_obter_estatisticas_antecipacao(estatisticas_antecipacao* est);
+
+#endif // EXT2_ITERADOR_H
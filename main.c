@@ -5,10 +5,13 @@
  *
  * Este arquivo inicializa a conexão com a imagem de disco, gerencia o estado do
  * shell (como o diretório atual) e contém o loop principal que lê a entrada do
- * usuário e chama a função de comando apropriada.
+ * usuário e chama a função de comando apropriada. Com -c ou -f, os comandos vêm de
+ * uma string ou de um script e rodam em lote, sem prompt, com o status de cada um
+ * informado em stderr. Com --servir, atende comandos de clientes por um socket Unix
+ * (servidor.c); com --conectar, é o próprio cliente.
  *
  * Data de criação: 24 de maio de 2025
- * Data de atualização: 6 de julho de 2025
+ * Data de atualização: 16 de outubro de 2026
  *
  */
 
@@ -17,42 +20,132 @@
 #include <string.h>
 #include <unistd.h> 
 #include <fcntl.h>  
+#include <getopt.h>
+#include <errno.h>
 
 #include "headers.h"
 #include "commands.h"
+#include "cache.h"
+#include "io.h"
+#include "iterador.h"
+#include "buffers.h"
+#include "servidor.h"
+#include "travas.h"
+#include "percurso.h"
+
+/*
+ * Executa uma linha de comando do lote e devolve o status: localmente (na sessão
+ * aberta por este processo) ou em um servidor (--conectar).
+ */
+typedef int (*executor_de_comando)(void* contexto, char* linha);
+
+/**
+ * @brief (Função Auxiliar Estática) Executor local: roda o comando na sessão deste processo.
+ */
+static int executar_localmente(void* contexto, char* linha) {
+    return executar_comando((sessao_shell*)contexto, linha);
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Executor remoto: envia o comando ao servidor conectado.
+ */
+static int executar_no_servidor(void* contexto, char* linha) {
+    return cliente_executar(*(int*)contexto, linha);
+}
 
+/**
+ * @brief (Função Auxiliar Estática) Executa um comando do modo em lote e informa o seu status.
+ *
+ * A saída do comando vai para stdout; o status vai para stderr, numa linha
+ * "[n] status <s>: <comando>", depois de a saída do comando ser descarregada,
+ * para que as duas fiquem na ordem certa quando apontam para o mesmo lugar.
+ *
+ * @return O status do comando. COMANDO_SAIR ou outro valor negativo (conexão perdida)
+ *         interrompem o lote.
+ */
+static int executar_comando_em_lote(executor_de_comando executar, void* contexto, char* linha, uint64_t numero, int* falhas) {
+    // Pula espaços iniciais; linhas vazias e comentários ('#') não contam como comandos.
+    while (*linha == ' ' || *linha == '\t') linha++;
+    linha[strcspn(linha, "\n\r")] = 0;
+    if (*linha == '\0' || *linha == '#') return 0;
+
+    char texto[256];
+    snprintf(texto, sizeof(texto), "%s", linha); // executar_comando separa a linha original
+    int status = executar(contexto, linha);
+    if (status == COMANDO_SAIR) return status;
+    if (status < 0) {
+        (*falhas)++;
+        return status;
+    }
 
-void imprimir_ajuda(void) {
-    printf("\n========================================== Shell Ext2 - Comandos Disponíveis ==========================================\n");
-
-    printf("\n  --- Comandos de Navegação e Inspeção ---\n");
-    printf("  %-45s - Lista o conteúdo do diretório atual ou do [caminho] especificado.\n", "ls [caminho]");
-    printf("  %-45s - Muda para o diretório de trabalho especificado pelo <caminho>.\n", "cd <caminho>");
-    printf("  %-45s - Mostra o caminho absoluto do diretório de trabalho atual.\n", "pwd");
-    printf("  %-45s - Exibe o conteúdo de um arquivo de texto.\n", "cat <arquivo>");
-    printf("  %-45s - Mostra os atributos formatados de um arquivo ou diretório.\n", "attr <arquivo|diretório>");
-    printf("  %-45s - Mostra um resumo das informações do sistema de arquivos.\n", "info");
-
-    printf("\n  --- Comandos de Criação e Modificação ---\n");
-    printf("  %-45s - Cria um arquivo vazio ou atualiza seu timestamp.\n", "touch <arquivo>");
-    printf("  %-45s - Cria um novo diretório.\n", "mkdir <diretório>");
-    printf("  %-45s - Renomeia um arquivo ou diretório no diretório atual.\n", "rename <nome_antigo> <nome_novo>");
-    printf("  %-45s - Copia um arquivo da imagem para o seu computador.\n", "cp <origem_na_imagem> <destino_local_absoluto>");
-    
-    printf("\n  --- Comandos de Remoção ---\n");
-    printf("  %-45s - Remove (apaga) um arquivo.\n", "rm <arquivo>");
-    printf("  %-45s - Remove um diretório vazio.\n", "rmdir <diretório>");
-
-    printf("\n  --- Comandos de Depuração ---\n");
-    printf("  %-45s - Exibe os dados brutos do superbloco.\n", "print superblock");
-    printf("  %-45s - Exibe os dados brutos de um inode específico.\n", "print inode <numero>");
-    printf("  %-45s - Exibe os dados brutos de todos os descritores de grupo.\n", "print groups");
-
-    printf("\n  --- Comandos do Shell ---\n");
-    printf("  %-45s - Mostra esta mensagem de ajuda.\n", "help");
-    printf("  %-45s - Encerra o programa.\n", "exit | quit");
-
-    printf("=======================================================================================================================\n\n");
+    if (status != 0) (*falhas)++;
+    fflush(stdout);
+    fprintf(stderr, "[%llu] status %d: %s\n", (unsigned long long)numero, status, texto);
+    return status;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Modo -c: executa os comandos de uma string, separados por ';'.
+ * @return O número de comandos que falharam (-1 se faltar memória).
+ */
+static int executar_string_de_comandos(executor_de_comando executar, void* contexto, const char* comandos) {
+    char* copia = strdup(comandos);
+    if (!copia) {
+        perror("Erro: falha ao alocar memória para os comandos");
+        return -1;
+    }
+
+    int falhas = 0;
+    uint64_t numero = 0;
+    char* inicio = copia;
+    while (inicio != NULL) {
+        // Separa à mão, pois os comandos usam strtok nos seus argumentos.
+        char* fim = strpbrk(inicio, ";\n");
+        if (fim) *fim = '\0';
+        if (executar_comando_em_lote(executar, contexto, inicio, ++numero, &falhas) < 0) break;
+        inicio = fim ? fim + 1 : NULL;
+    }
+    free(copia);
+    return falhas;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Modo -f: executa os comandos de um script, um por linha
+ * ("-" lê o script da entrada padrão).
+ * @return O número de comandos que falharam (-1 se o script não puder ser aberto).
+ */
+static int executar_script(executor_de_comando executar, void* contexto, const char* caminho_script) {
+    FILE* script = (strcmp(caminho_script, "-") == 0) ? stdin : fopen(caminho_script, "r");
+    if (!script) {
+        fprintf(stderr, "Erro: não foi possível abrir o script '%s': %s\n", caminho_script, strerror(errno));
+        return -1;
+    }
+
+    int falhas = 0;
+    uint64_t numero = 0;
+    char* linha = NULL;
+    size_t capacidade = 0;
+    while (getline(&linha, &capacidade, script) != -1) {
+        if (executar_comando_em_lote(executar, contexto, linha, ++numero, &falhas) < 0) break;
+    }
+    free(linha);
+    if (script != stdin) fclose(script);
+    return falhas;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Modo --conectar: envia os comandos de -c, de -f ou
+ * da entrada padrão a um servidor já em execução, no mesmo formato do modo em lote.
+ * @return O código de saída do processo (1 se algum comando falhou ou a conexão caiu).
+ */
+static int executar_como_cliente(const char* caminho_socket, const char* comandos_lote, const char* script_lote) {
+    int conexao = cliente_conectar(caminho_socket);
+    if (conexao == -1) return 1;
+
+    int falhas = comandos_lote ? executar_string_de_comandos(executar_no_servidor, &conexao, comandos_lote)
+                               : executar_script(executar_no_servidor, &conexao, script_lote ? script_lote : "-");
+    cliente_desconectar(conexao);
+    return (falhas != 0) ? 1 : 0;
 }
 
 
@@ -61,14 +154,118 @@ void imprimir_ajuda(void) {
  */
 int main(int argc, char *argv[]) {
     // VERIFICAÇÃO DOS ARGUMENTOS
-    if (argc < 2) {
-        fprintf(stderr, "Uso: %s <caminho_para_a_imagem_ext2>\n", argv[0]);
+    static const struct option opcoes_longas[] = {
+        {"cache", required_argument, NULL, 'C'},
+        {"mmap",  no_argument,       NULL, 'm'},
+        {"cache-inodes", required_argument, NULL, 'I'},
+        {"inodes-write-back", no_argument, NULL, 'W'},
+        {"cache-dentries", required_argument, NULL, 'D'},
+        {"readahead", required_argument, NULL, 'R'},
+        {"comandos", required_argument, NULL, 'c'},
+        {"script", required_argument, NULL, 'f'},
+        {"servir", required_argument, NULL, 'S'},
+        {"conectar", required_argument, NULL, 'K'},
+        {"trabalhadores", required_argument, NULL, 'j'},
+        {NULL, 0, NULL, 0}
+    };
+    uint32_t capacidade_cache = CACHE_BLOCOS_PADRAO;
+    int usar_mmap = 0;
+    uint32_t capacidade_cache_inodes = CACHE_INODES_PADRAO;
+    int inodes_write_back = 0;
+    uint32_t capacidade_cache_dentries = CACHE_DENTRIES_PADRAO;
+    uint32_t janela_antecipacao = ITER_ANTECIPACAO_PADRAO;
+    uint32_t num_trabalhadores = 0;     // 0 = um por processador
+    const char* comandos_lote = NULL;   // -c "cmd; cmd"
+    const char* script_lote = NULL;     // -f script
+    const char* socket_servidor = NULL; // --servir <socket>
+    const char* socket_cliente = NULL;  // --conectar <socket>
+
+    int opcao;
+    while ((opcao = getopt_long(argc, argv, "C:mI:WD:R:c:f:S:K:j:", opcoes_longas, NULL)) != -1) {
+        if (opcao == 'm') {
+            usar_mmap = 1;
+        } else if (opcao == 'C') {
+            char* endptr;
+            long valor = strtol(optarg, &endptr, 10);
+            if (*endptr != '\0' || valor < 0 || valor > 1048576) {
+                fprintf(stderr, "Erro: capacidade de cache inválida: '%s' (use 0 a 1048576 blocos).\n", optarg);
+                return 1;
+            }
+            capacidade_cache = (uint32_t)valor;
+        } else if (opcao == 'I') {
+            char* endptr;
+            long valor = strtol(optarg, &endptr, 10);
+            if (*endptr != '\0' || valor < 0 || valor > 1048576) {
+                fprintf(stderr, "Erro: capacidade do cache de inodes inválida: '%s' (use 0 a 1048576 inodes).\n", optarg);
+                return 1;
+            }
+            capacidade_cache_inodes = (uint32_t)valor;
+        } else if (opcao == 'W') {
+            inodes_write_back = 1;
+        } else if (opcao == 'D') {
+            char* endptr;
+            long valor = strtol(optarg, &endptr, 10);
+            if (*endptr != '\0' || valor < 0 || valor > 1048576) {
+                fprintf(stderr, "Erro: capacidade do cache de nomes inválida: '%s' (use 0 a 1048576 entradas).\n", optarg);
+                return 1;
+            }
+            capacidade_cache_dentries = (uint32_t)valor;
+        } else if (opcao == 'R') {
+            char* endptr;
+            long valor = strtol(optarg, &endptr, 10);
+            if (*endptr != '\0' || valor < 0 || valor > 65536) {
+                fprintf(stderr, "Erro: janela de leitura antecipada inválida: '%s' (use 0 a 65536 blocos).\n", optarg);
+                return 1;
+            }
+            janela_antecipacao = (uint32_t)valor;
+        } else if (opcao == 'j') {
+            char* endptr;
+            long valor = strtol(optarg, &endptr, 10);
+            if (*endptr != '\0' || valor < 0 || valor > PERCURSO_MAX_TRABALHADORES) {
+                fprintf(stderr, "Erro: número de trabalhadores inválido: '%s' (use 0 a %d; 0 = um por processador).\n", optarg, PERCURSO_MAX_TRABALHADORES);
+                return 1;
+            }
+            num_trabalhadores = (uint32_t)valor;
+        } else if (opcao == 'c') {
+            comandos_lote = optarg;
+        } else if (opcao == 'f') {
+            script_lote = optarg;
+        } else if (opcao == 'S') {
+            socket_servidor = optarg;
+        } else if (opcao == 'K') {
+            socket_cliente = optarg;
+        } else {
+            optind = argc + 1; // Força a mensagem de uso abaixo
+            break;
+        }
+    }
+
+    if (comandos_lote && script_lote) {
+        fprintf(stderr, "Erro: as opções -c e -f não podem ser usadas juntas.\n");
+        return 1;
+    }
+
+    // O cliente não abre a imagem: os comandos são executados pelo servidor.
+    if (socket_cliente && optind == argc && !socket_servidor) {
+        return executar_como_cliente(socket_cliente, comandos_lote, script_lote);
+    }
+
+    if (optind != argc - 1 || socket_cliente) {
+        fprintf(stderr, "Uso: %s [--cache <num_blocos>] [--mmap] [--cache-inodes <num_inodes>] [--inodes-write-back] [--cache-dentries <num_entradas>] [--readahead <num_blocos>] [--trabalhadores <num>] [-c \"cmd; cmd\" | -f <script> | --servir <socket>] <caminho_para_a_imagem_ext2>\n"
+                        "       %s --conectar <socket> [-c \"cmd; cmd\" | -f <script>]\n", argv[0], argv[0]);
         return 1; // Encerra com código de erro
     }
-    const char* caminho_imagem = argv[1];
+    if (socket_servidor && (comandos_lote || script_lote)) {
+        fprintf(stderr, "Erro: a opção --servir não pode ser usada com -c ou -f.\n");
+        return 1;
+    }
+    const char* caminho_imagem = argv[optind];
+
+    // No modo em lote (-c / -f) não há banner nem prompt: stdout recebe só a saída dos comandos.
+    int modo_lote = (comandos_lote != NULL || script_lote != NULL);
 
     // INICIALIZAÇÃO DO SISTEMA DE ARQUIVOS
-    printf("Abrindo a imagem do disco: %s\n", caminho_imagem);
+    if (!modo_lote) printf("Abrindo a imagem do disco: %s\n", caminho_imagem);
 
     // Abre a imagem em modo de leitura (por enquanto)
     int fd = open(caminho_imagem, O_RDWR);
@@ -78,163 +275,158 @@ int main(int argc, char *argv[]) {
     }
 
     // Declara as estruturas principais que usaremos
-    superbloco sb;
+    superbloco superbloco_imagem;
+    superbloco* sb = &superbloco_imagem;
     group_desc *gdt = NULL;
     uint32_t num_grupos = 0;
 
     // Tenta ler o superbloco
-    if (ler_superbloco(fd, &sb) != 0) {
+    if (ler_superbloco(fd, sb) != 0) {
         fprintf(stderr, "Erro fatal: não foi possível ler o superbloco.\n");
         close(fd);
         return 1;
     }
 
     // Valida o superbloco para garantir que é um FS Ext2
-    if (!validar_superbloco(&sb)) {
+    if (!validar_superbloco(sb)) {
         fprintf(stderr, "Erro fatal: A imagem não parece ser um sistema de arquivos Ext2 válido.\n");
         close(fd);
         return 1;
     }
 
-    printf("Superbloco lido e validado com sucesso!\n");
+    if (!modo_lote) printf("Superbloco lido e validado com sucesso!\n");
+
+    // Pool de buffers de um bloco usados como rascunho pelas operações (reiniciado a cada comando).
+    if (buffers_inicializar(calcular_tamanho_do_bloco(sb)) != 0) {
+        close(fd);
+        return 1;
+    }
 
     // Lê a tabela de descritores de grupo (GDT)
-    gdt = ler_descritores_grupo(fd, &sb, &num_grupos);
+    gdt = ler_descritores_grupo(fd, sb, &num_grupos);
     if (gdt == NULL) {
         fprintf(stderr, "Erro fatal: não foi possível ler a tabela de descritores de grupo.\n");
         close(fd);
         return 1;
     }
-    printf("Tabela de descritores de grupo lida com sucesso (%u grupos).\n\n", num_grupos);
-
-
-    uint32_t diretorio_atual_inode = EXT2_ROOT_INO;
-
-    // Define a string do caminho atual, começando na raiz.
-    char diretorio_atual_str[1024] = "/";
-
-    // LOOP PRINCIPAL DO SHELL
-    char linha_comando[256];
-    char prompt[1024 + 4]; // Buffer para o prompt
-
+    if (!modo_lote) printf("Tabela de descritores de grupo lida com sucesso (%u grupos).\n", num_grupos);
 
+    // Travas por grupo, por inode e por diretório usadas pelo núcleo (ver travas.h).
+    if (travas_inicializar(num_grupos) != 0) {
+        fprintf(stderr, "Aviso: não foi possível criar as travas do núcleo; seguindo sem elas.\n");
+    }
 
-    do {
-        snprintf(prompt, sizeof(prompt), "[%s]> ", diretorio_atual_str);
-        printf("\n%s", prompt);
-
-        if (fgets(linha_comando, sizeof(linha_comando), stdin) == NULL) {
-            printf("\nSaindo (EOF detectado)...\n");
-            break; 
-        }
-
-        // remove quebra de linha do final do fgets
-        linha_comando[strcspn(linha_comando, "\n\r")] = 0;
-
-        // agora pega apensa o primeiro token como comando
-        char* comando = strtok(linha_comando, " \t");
-
-        if (comando == NULL) {
-            continue;
-        }
-
-        // pega todo o resto da linha como string de argumentos
-        char *argumentos = strtok(NULL, "");
-        // remove espaços em branco do inicio dos argumentos, se houver
-        if (argumentos) while (*argumentos == ' ' || *argumentos == '\t') argumentos++;
-        // Se após remover os espaços a string ficar vazia, trata como nula
-        if (argumentos && *argumentos == '\0') argumentos = NULL;
-
-
-
-        if (strcmp(comando, "print") == 0) {
-            // A lógica de 'print' é especial e continua analisando os 'argumentos'
-            char* subcomando = strtok(argumentos, " \t\n\r");
-            if (subcomando == NULL) {
-                printf("Comando 'print' incompleto. Uso: 'print superblock', 'print inode <n>', 'print groups'.\n");
-            
-            } else if (strcmp(subcomando, "superblock") == 0) {
-                // Passa o resto dos argumentos para a função validar
-                comando_print_superblock(&sb);
-            
-            } else if (strcmp(subcomando, "inode") == 0) {
-                char* arg_num_inode = strtok(NULL, " \t\n\r");
-                comando_print_inode(fd, &sb, gdt, arg_num_inode);
-            
-            } else if (strcmp(subcomando, "groups") == 0) {
-                comando_print_groups(gdt, num_grupos);
-            
-            } else {
-                printf("Argumento desconhecido para 'print': '%s'\n", subcomando);
-            }
-        }
-        else if (strcmp(comando, "info") == 0) {
-            comando_info(&sb, num_grupos, argumentos);
-        }
-        
-        else if (strcmp(comando, "attr") == 0) {
-            comando_attr(fd, &sb, gdt, diretorio_atual_inode, argumentos);
-        }
-        
-        else if (strcmp(comando, "cat") == 0) {
-            comando_cat(fd, &sb, gdt, diretorio_atual_inode, argumentos);
-        }
-
-         else if (strcmp(comando, "ls") == 0) {
-            comando_ls(fd, &sb, gdt, diretorio_atual_inode, argumentos);
+    // No modo --mmap a imagem inteira fica mapeada e o próprio mapeamento faz o papel
+    // de cache (page cache do kernel), então o cache de blocos é desligado.
+    if (usar_mmap) {
+        if (io_mapear_imagem(fd) == 0) {
+            if (!modo_lote) printf("Imagem mapeada em memória (modo --mmap).\n");
+            capacidade_cache = 0;
+        } else {
+            fprintf(stderr, "Aviso: não foi possível mapear a imagem; usando E/S com pread/pwrite.\n");
         }
+    }
 
-        else if (strcmp(comando, "cd") == 0) {
-            comando_cd(fd, &sb, gdt, &diretorio_atual_inode, diretorio_atual_str, argumentos);
-        }
+    // Cria o cache de blocos compartilhado por todos os comandos (0 = desativado).
+    if (cache_blocos_inicializar(capacidade_cache, calcular_tamanho_do_bloco(sb)) != 0) {
+        fprintf(stderr, "Aviso: não foi possível criar o cache de blocos; seguindo sem cache.\n");
+    } else if (cache_blocos_ativo() && !modo_lote) {
+        printf("Cache de blocos ativo (%u blocos).\n", capacidade_cache);
+    }
 
-        else if (strcmp(comando, "pwd") == 0){
-            comando_pwd(diretorio_atual_str, argumentos);
-        }
+    // Cria o cache de inodes (0 = desativado).
+    if (cache_inodes_inicializar(capacidade_cache_inodes, inodes_write_back) != 0) {
+        fprintf(stderr, "Aviso: não foi possível criar o cache de inodes; seguindo sem cache.\n");
+    } else if (cache_inodes_ativo() && !modo_lote) {
+        printf("Cache de inodes ativo (%u inodes, %s).\n", capacidade_cache_inodes,
+               inodes_write_back ? "write-back" : "write-through");
+    }
 
-        else if (strcmp(comando, "touch") == 0) {
-            comando_touch(fd, &sb, gdt, diretorio_atual_inode, argumentos);
-        }
+    // Cria o cache de nomes usado na resolução de caminhos (0 = desativado).
+    if (cache_dentries_inicializar(capacidade_cache_dentries) != 0) {
+        fprintf(stderr, "Aviso: não foi possível criar o cache de nomes; seguindo sem cache.\n");
+    } else if (cache_dentries_ativo() && !modo_lote) {
+        printf("Cache de nomes ativo (%u entradas).\n", capacidade_cache_dentries);
+    }
 
-        else if (strcmp(comando, "rm") == 0) {
-            comando_rm(fd, &sb, gdt, diretorio_atual_inode, argumentos);
-        }
+    // Janela máxima da leitura antecipada dos iteradores de blocos (0 = desativada).
+    iterador_configurar_antecipacao(janela_antecipacao);
 
-        else if (strcmp(comando, "mkdir") == 0) {
-            comando_mkdir(fd, &sb, gdt, diretorio_atual_inode, argumentos);
-        }
+    // Trabalhadores dos comandos recursivos (find, du, tree).
+    percurso_configurar_trabalhadores(num_trabalhadores);
+    if (!modo_lote) printf("\n");
 
-        else if (strcmp(comando, "rmdir") == 0){
-            comando_rmdir(fd, &sb, gdt, diretorio_atual_inode, argumentos);
-        }
 
-        else if (strcmp(comando, "rename") == 0){
-            comando_rename(fd, &sb, gdt, diretorio_atual_inode, argumentos);
-        }
+    sessao_shell sessao;
+    sessao.fd = fd;
+    sessao.sb = sb;
+    sessao.gdt = gdt;
+    sessao.num_grupos = num_grupos;
+    sessao.diretorio_atual_inode = EXT2_ROOT_INO;
 
-        else if (strcmp(comando, "help") == 0) {
-            imprimir_ajuda();
-        } 
-        
-        else if (strcmp(comando, "exit") == 0 || strcmp(comando, "quit") == 0) {
-            printf("Saindo...\n");
-            break;
-        } 
+    // A raiz fica fixada no cache de inodes durante toda a sessão (toda resolução de
+    // caminho absoluto começa nela); a segunda referência representa o diretório atual.
+    cache_inodes_fixar(fd, sb, gdt, EXT2_ROOT_INO);
+    sessao_fixar_diretorio(fd, sb, gdt, sessao.diretorio_atual_inode);
 
-        else if (strcmp(comando, "cp") == 0) {
-            comando_cp(fd, &sb, gdt, diretorio_atual_inode, argumentos);
-        }
-        
-        else {
-            printf("Comando desconhecido: '%s'. Digite 'help' para ver a lista de comandos.\n", comando);
-        }
+    // Define a string do caminho atual, começando na raiz.
+    strcpy(sessao.diretorio_atual_str, "/");
+
+    int codigo_saida = 0;
+    if (modo_lote) {
+        // MODO EM LOTE: todos os comandos rodam na mesma sessão, com os caches aquecidos.
+        int falhas = comandos_lote ? executar_string_de_comandos(executar_localmente, &sessao, comandos_lote)
+                                   : executar_script(executar_localmente, &sessao, script_lote);
+        codigo_saida = (falhas != 0) ? 1 : 0;
+    } else if (socket_servidor) {
+        // MODO SERVIDOR: a imagem e os caches ficam abertos atendendo clientes até um SIGINT/SIGTERM.
+        if (servidor_executar(socket_servidor, &sessao) != 0) codigo_saida = 1;
+    } else {
+        // LOOP PRINCIPAL DO SHELL
+        char linha_comando[256];
+        char prompt[1024 + 4]; // Buffer para o prompt
+
+        do {
+            snprintf(prompt, sizeof(prompt), "[%s]> ", sessao.diretorio_atual_str);
+            printf("\n%s", prompt);
+
+            if (fgets(linha_comando, sizeof(linha_comando), stdin) == NULL) {
+                printf("\nSaindo (EOF detectado)...\n");
+                break;
+            }
 
-    } while (1);
+            if (executar_comando(&sessao, linha_comando) == COMANDO_SAIR) {
+                printf("Saindo...\n");
+                break;
+            }
+        } while (1);
+    }
 
     // LIMPEZA E ENCERRAMENTO
-    printf("Liberando recursos e fechando o disco.\n");
+    if (!modo_lote) printf("Liberando recursos e fechando o disco.\n");
+    sincronizar_metadados(fd, sb, gdt);
+    cache_bitmaps_finalizar();
+    if (cache_inodes_sincronizar(fd, sb, gdt) < 0) {  // Inodes sujos vão para os blocos da tabela
+        fprintf(stderr, "Erro: alguns inodes do cache não puderam ser gravados no disco.\n");
+        codigo_saida = 1;
+    }
+    cache_inodes_finalizar();
+    cache_dentries_finalizar();
+    if (cache_blocos_sincronizar(fd, sb) < 0) {  // Grava os blocos pendentes antes de sair
+        fprintf(stderr, "Erro: alguns blocos do cache não puderam ser gravados no disco.\n");
+        codigo_saida = 1;
+    }
+    cache_blocos_finalizar();
+    if (io_sincronizar_mapa() != 0) {
+        fprintf(stderr, "Erro: a imagem mapeada não pôde ser sincronizada com o disco.\n");
+        codigo_saida = 1;
+    }
+    io_desmapear_imagem();
+    io_lotes_finalizar();
     liberar_descritores_grupo(gdt); // Libera a memória alocada para a GDT
+    travas_finalizar();             // Destrói as travas do núcleo
+    buffers_finalizar();            // Libera o pool de buffers de rascunho
     close(fd);                      // Fecha o arquivo da imagem
 
-    return 0;                       // Sucesso
+    return codigo_saida;            // 0 = sucesso; 1 = algum comando do lote falhou
 }
\ No newline at end of file
@@ -0,0 +1,443 @@
+/**
+ * @file       percurso.c
+ * @brief      Implementação do percurso paralelo de diretórios com roubo de tarefas.
+ *
+ * @author     Allan Custódio Diniz Marques (L33tSh4rk)
+ *
+ * Cada trabalhador tem uma fila de diretórios a ler, protegida por uma trava
+ * própria (a disputa só acontece quando alguém rouba). O fim do percurso é
+ * detectado por um contador atômico de tarefas pendentes: ele é incrementado antes
+ * de uma tarefa entrar numa fila e decrementado só depois que ela foi processada,
+ * então chega a zero apenas quando não há mais nada enfileirado nem em andamento.
+ *
+ * Data de criação: 16 de outubro de 2026
+ * Data de atualização: 16 de outubro de 2026
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "percurso.h"
+#include "iterador.h"
+#include "travas.h"
+
+// Tentativas de roubo sem sucesso antes de o trabalhador ocioso passar a dormir entre elas.
+#define PERCURSO_TENTATIVAS_ANTES_DE_DORMIR 64
+
+// Capacidade inicial da fila de cada trabalhador, em tarefas.
+#define PERCURSO_FILA_INICIAL 64
+
+// Configuração e contadores (compartilhados por todos os percursos).
+static uint32_t trabalhadores_configurados = 0;
+static estatisticas_percurso estatisticas_percursos;
+
+/*
+ * Um diretório a ler. O inode já foi lido por quem o encontrou.
+ */
+typedef struct {
+    uint32_t inode_num;
+    uint32_t profundidade;
+    inode ino;
+    char* caminho;                  // Alocado por quem enfileira, liberado por quem processa
+    void* dados;                    // Devolvido pelo visitante para este diretório
+} tarefa_percurso;
+
+/*
+ * Fila de um trabalhador: o dono usa o fim, os ladrões usam o começo.
+ */
+typedef struct {
+    pthread_mutex_t trava;
+    tarefa_percurso* tarefas;
+    size_t inicio;
+    size_t fim;
+    size_t capacidade;
+} fila_percurso;
+
+typedef struct {
+    int fd;
+    const superbloco* sb;
+    const group_desc* gdt;
+    visitante_percurso visitante;
+    void* contexto;
+    fila_percurso* filas;
+    uint32_t num_trabalhadores;
+    uint64_t pendentes;             // Tarefas enfileiradas ou em andamento (atômico)
+    uint64_t erros;                 // Diretórios ou entradas que não puderam ser lidos (atômico)
+} estado_percurso;
+
+typedef struct {
+    estado_percurso* estado;
+    uint32_t indice;
+    char* bloco;                    // Buffer de um bloco (quando a imagem não está mapeada)
+    char* caminho;                  // Caminho da entrada em montagem
+    size_t capacidade_caminho;
+} trabalhador_percurso;
+
+
+/*
+ * =================================================================================
+ * Filas de Tarefas
+ * =================================================================================
+ */
+
+/**
+ * @brief (Função Auxiliar Estática) Coloca uma tarefa no fim da fila (só o dono da fila chama).
+ * @return 0 em sucesso, -1 se faltou memória.
+ */
+static int fila_colocar(fila_percurso* fila, const tarefa_percurso* tarefa) {
+    pthread_mutex_lock(&fila->trava);
+    if (fila->fim == fila->capacidade) {
+        if (fila->inicio > 0) {
+            // Reaproveita o espaço deixado pelos roubos antes de crescer.
+            memmove(fila->tarefas, fila->tarefas + fila->inicio, (fila->fim - fila->inicio) * sizeof(tarefa_percurso));
+            fila->fim -= fila->inicio;
+            fila->inicio = 0;
+        } else {
+            size_t nova_capacidade = fila->capacidade ? fila->capacidade * 2 : PERCURSO_FILA_INICIAL;
+            tarefa_percurso* novas = realloc(fila->tarefas, nova_capacidade * sizeof(tarefa_percurso));
+            if (!novas) {
+                pthread_mutex_unlock(&fila->trava);
+                return -1;
+            }
+            fila->tarefas = novas;
+            fila->capacidade = nova_capacidade;
+        }
+    }
+    fila->tarefas[fila->fim++] = *tarefa;
+    pthread_mutex_unlock(&fila->trava);
+    return 0;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Tira a tarefa do fim da fila (a mais recente).
+ * @return 1 se havia uma tarefa, 0 se a fila estava vazia.
+ */
+static int fila_tirar_do_fim(fila_percurso* fila, tarefa_percurso* tarefa) {
+    int havia = 0;
+    pthread_mutex_lock(&fila->trava);
+    if (fila->fim > fila->inicio) {
+        *tarefa = fila->tarefas[--fila->fim];
+        havia = 1;
+    }
+    if (fila->fim == fila->inicio) fila->inicio = fila->fim = 0;
+    pthread_mutex_unlock(&fila->trava);
+    return havia;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Tira a tarefa do começo da fila (a mais antiga), para roubo.
+ * @return 1 se havia uma tarefa, 0 se a fila estava vazia.
+ */
+static int fila_tirar_do_inicio(fila_percurso* fila, tarefa_percurso* tarefa) {
+    int havia = 0;
+    pthread_mutex_lock(&fila->trava);
+    if (fila->fim > fila->inicio) {
+        *tarefa = fila->tarefas[fila->inicio++];
+        havia = 1;
+    }
+    if (fila->fim == fila->inicio) fila->inicio = fila->fim = 0;
+    pthread_mutex_unlock(&fila->trava);
+    return havia;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Procura uma tarefa nas filas dos outros trabalhadores.
+ * @return 1 se conseguiu roubar uma tarefa, 0 caso contrário.
+ */
+static int roubar_tarefa(estado_percurso* estado, uint32_t indice, tarefa_percurso* tarefa) {
+    for (uint32_t k = 1; k < estado->num_trabalhadores; ++k) {
+        uint32_t vitima = (indice + k) % estado->num_trabalhadores;
+        if (fila_tirar_do_inicio(&estado->filas[vitima], tarefa)) {
+            contador_somar(&estatisticas_percursos.roubos, 1);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/*
+ * =================================================================================
+ * Leitura dos Diretórios
+ * =================================================================================
+ */
+
+/**
+ * @brief (Função Auxiliar Estática) Monta em t->caminho o caminho de `nome` dentro de `pai`.
+ * @return 0 em sucesso, -1 se faltou memória.
+ */
+static int montar_caminho(trabalhador_percurso* t, const char* pai, const char* nome, size_t tamanho_nome) {
+    size_t tamanho_pai = strlen(pai);
+    int com_barra = (tamanho_pai == 0 || pai[tamanho_pai - 1] != '/');
+    size_t necessario = tamanho_pai + (size_t)com_barra + tamanho_nome + 1;
+    if (necessario > t->capacidade_caminho) {
+        char* novo = realloc(t->caminho, necessario * 2);
+        if (!novo) return -1;
+        t->caminho = novo;
+        t->capacidade_caminho = necessario * 2;
+    }
+    memcpy(t->caminho, pai, tamanho_pai);
+    if (com_barra) t->caminho[tamanho_pai] = '/';
+    memcpy(t->caminho + tamanho_pai + com_barra, nome, tamanho_nome);
+    t->caminho[necessario - 1] = '\0';
+    return 0;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Visita as entradas de um bloco do diretório da tarefa
+ * e enfileira os subdiretórios encontrados.
+ */
+static void visitar_entradas_do_bloco(trabalhador_percurso* t, const tarefa_percurso* tarefa, const char* bloco) {
+    estado_percurso* estado = t->estado;
+    uint32_t tamanho_bloco = calcular_tamanho_do_bloco(estado->sb);
+    uint32_t offset = 0;
+
+    while (offset + 8 <= tamanho_bloco) {
+        const ext2_dir_entry* entrada = (const ext2_dir_entry*)(bloco + offset);
+        if (entrada->rec_len < 8 || offset + entrada->rec_len > tamanho_bloco) break;
+        offset += entrada->rec_len;
+
+        if (entrada->inode == 0) continue;
+        if ((entrada->name_len == 1 && entrada->name[0] == '.') ||
+            (entrada->name_len == 2 && entrada->name[0] == '.' && entrada->name[1] == '.')) continue;
+
+        inode filho;
+        if (montar_caminho(t, tarefa->caminho, entrada->name, entrada->name_len) != 0 ||
+            ler_inode(estado->fd, estado->sb, estado->gdt, entrada->inode, &filho) != 0) {
+            contador_somar(&estado->erros, 1);
+            continue;
+        }
+
+        size_t tamanho_caminho = strlen(t->caminho);
+        entrada_percurso e = {
+            .inode_num = entrada->inode,
+            .inode_pai = tarefa->inode_num,
+            .profundidade = tarefa->profundidade + 1,
+            .caminho = t->caminho,
+            .nome = t->caminho + tamanho_caminho - entrada->name_len,
+            .ino = &filho,
+            .trabalhador = t->indice,
+        };
+        void* dados = estado->visitante(&e, tarefa->dados, estado->contexto);
+        contador_somar(&estatisticas_percursos.entradas, 1);
+        if (!EXT2_IS_DIR(filho.mode)) continue;
+
+        tarefa_percurso nova = {
+            .inode_num = entrada->inode,
+            .profundidade = e.profundidade,
+            .ino = filho,
+            .caminho = malloc(tamanho_caminho + 1),
+            .dados = dados,
+        };
+        if (!nova.caminho) {
+            contador_somar(&estado->erros, 1);
+            continue;
+        }
+        memcpy(nova.caminho, t->caminho, tamanho_caminho + 1);
+        __atomic_add_fetch(&estado->pendentes, 1, __ATOMIC_ACQ_REL);
+        if (fila_colocar(&estado->filas[t->indice], &nova) != 0) {
+            free(nova.caminho);
+            __atomic_sub_fetch(&estado->pendentes, 1, __ATOMIC_ACQ_REL);
+            contador_somar(&estado->erros, 1);
+        }
+    }
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Lê todas as entradas do diretório da tarefa, sob a trava
+ * de leitura do diretório.
+ */
+static void ler_diretorio(trabalhador_percurso* t, const tarefa_percurso* tarefa) {
+    estado_percurso* estado = t->estado;
+    if (tarefa->profundidade >= PERCURSO_PROFUNDIDADE_MAXIMA) {
+        fprintf(stderr, "Erro (percurso): '%s' está fundo demais; sub-árvore ignorada.\n", tarefa->caminho);
+        contador_somar(&estado->erros, 1);
+        return;
+    }
+
+    trava_diretorio_ler(tarefa->inode_num);
+    iterador_blocos it;
+    if (iterador_blocos_iniciar(&it, estado->fd, estado->sb, &tarefa->ino, ITER_ANTECIPAR) != 0) {
+        trava_diretorio_liberar(tarefa->inode_num);
+        contador_somar(&estado->erros, 1);
+        return;
+    }
+
+    uint32_t bloco_logico, bloco_fisico;
+    while (iterador_blocos_proximo(&it, &bloco_logico, &bloco_fisico)) {
+        const char* bloco = ler_bloco_ref(estado->fd, estado->sb, bloco_fisico, t->bloco);
+        if (!bloco) {
+            contador_somar(&estado->erros, 1);
+            continue;
+        }
+        visitar_entradas_do_bloco(t, tarefa, bloco);
+    }
+    if (it.erro) contador_somar(&estado->erros, 1);
+    iterador_blocos_finalizar(&it);
+    trava_diretorio_liberar(tarefa->inode_num);
+    contador_somar(&estatisticas_percursos.diretorios, 1);
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Laço de um trabalhador: processa a própria fila, rouba
+ * quando ela esvazia e termina quando não há mais tarefas pendentes em lugar nenhum.
+ */
+static void* executar_trabalhador(void* argumento) {
+    trabalhador_percurso* t = argumento;
+    estado_percurso* estado = t->estado;
+    uint32_t tentativas = 0;
+
+    for (;;) {
+        tarefa_percurso tarefa;
+        if (fila_tirar_do_fim(&estado->filas[t->indice], &tarefa) || roubar_tarefa(estado, t->indice, &tarefa)) {
+            tentativas = 0;
+            ler_diretorio(t, &tarefa);
+            free(tarefa.caminho);
+            __atomic_sub_fetch(&estado->pendentes, 1, __ATOMIC_ACQ_REL);
+            continue;
+        }
+        if (__atomic_load_n(&estado->pendentes, __ATOMIC_ACQUIRE) == 0) break;
+
+        // Há diretórios sendo lidos por outros trabalhadores, que ainda podem gerar tarefas.
+        if (++tentativas < PERCURSO_TENTATIVAS_ANTES_DE_DORMIR) {
+            sched_yield();
+        } else {
+            struct timespec pausa = { 0, 50 * 1000 };
+            nanosleep(&pausa, NULL);
+        }
+    }
+    return NULL;
+}
+
+
+/*
+ * =================================================================================
+ * Percurso
+ * =================================================================================
+ */
+
+/**
+ * @brief Visita a sub-árvore com raiz em `inode_raiz` usando vários trabalhadores.
+ *
+ * A raiz é visitada primeiro, na thread que chamou; se for um diretório, o restante
+ * é dividido entre os trabalhadores. A função só retorna quando todas as entradas
+ * foram visitadas.
+ *
+ * @param caminho_raiz Caminho usado como prefixo dos caminhos entregues ao visitante.
+ * @param dados_iniciais Valor de `dados_do_pai` para a raiz.
+ * @return 0 em sucesso, -1 se alguma parte da sub-árvore não pôde ser lida.
+ */
+int percurso_paralelo(int fd, const superbloco* sb, const group_desc* gdt, uint32_t inode_raiz, const char* caminho_raiz,
+                      visitante_percurso visitante, void* dados_iniciais, void* contexto) {
+    inode ino_raiz;
+    if (ler_inode(fd, sb, gdt, inode_raiz, &ino_raiz) != 0) return -1;
+    contador_somar(&estatisticas_percursos.percursos, 1);
+
+    const char* barra = strrchr(caminho_raiz, '/');
+    entrada_percurso raiz = {
+        .inode_num = inode_raiz,
+        .inode_pai = 0,
+        .profundidade = 0,
+        .caminho = caminho_raiz,
+        .nome = (barra && barra[1] != '\0') ? barra + 1 : caminho_raiz,
+        .ino = &ino_raiz,
+        .trabalhador = 0,
+    };
+    void* dados_raiz = visitante(&raiz, dados_iniciais, contexto);
+    contador_somar(&estatisticas_percursos.entradas, 1);
+    if (!EXT2_IS_DIR(ino_raiz.mode)) return 0;
+
+    uint32_t num_trabalhadores = percurso_num_trabalhadores();
+    estado_percurso estado = {
+        .fd = fd, .sb = sb, .gdt = gdt,
+        .visitante = visitante, .contexto = contexto,
+        .num_trabalhadores = num_trabalhadores,
+        .pendentes = 1,
+        .erros = 0,
+    };
+    estado.filas = calloc(num_trabalhadores, sizeof(fila_percurso));
+    trabalhador_percurso* trabalhadores = calloc(num_trabalhadores, sizeof(trabalhador_percurso));
+    pthread_t* threads = calloc(num_trabalhadores, sizeof(pthread_t));
+    tarefa_percurso primeira = { .inode_num = inode_raiz, .profundidade = 0, .ino = ino_raiz,
+                                 .caminho = strdup(caminho_raiz), .dados = dados_raiz };
+    int status = 0;
+    if (!estado.filas || !trabalhadores || !threads || !primeira.caminho) {
+        perror("Erro (percurso_paralelo): Falha ao alocar os trabalhadores");
+        status = -1;
+    }
+    for (uint32_t i = 0; status == 0 && i < num_trabalhadores; ++i) {
+        pthread_mutex_init(&estado.filas[i].trava, NULL);
+        trabalhadores[i].estado = &estado;
+        trabalhadores[i].indice = i;
+        trabalhadores[i].bloco = malloc(calcular_tamanho_do_bloco(sb));
+        if (!trabalhadores[i].bloco) {
+            perror("Erro (percurso_paralelo): Falha ao alocar os buffers dos trabalhadores");
+            status = -1;
+        }
+    }
+    if (status == 0 && fila_colocar(&estado.filas[0], &primeira) != 0) status = -1;
+
+    if (status == 0) {
+        // O trabalhador 0 é a própria thread que chamou; se alguma thread não puder
+        // ser criada, as tarefas ficam com os trabalhadores que existirem.
+        uint32_t criadas = 1;
+        for (uint32_t i = 1; i < num_trabalhadores; ++i) {
+            if (pthread_create(&threads[i], NULL, executar_trabalhador, &trabalhadores[i]) != 0) break;
+            criadas++;
+        }
+        executar_trabalhador(&trabalhadores[0]);
+        for (uint32_t i = 1; i < criadas; ++i) pthread_join(threads[i], NULL);
+        if (estado.erros > 0) status = -1;
+    } else {
+        free(primeira.caminho);
+    }
+
+    for (uint32_t i = 0; trabalhadores && estado.filas && i < num_trabalhadores; ++i) {
+        if (trabalhadores[i].estado) pthread_mutex_destroy(&estado.filas[i].trava);
+        free(estado.filas[i].tarefas);
+        free(trabalhadores[i].bloco);
+        free(trabalhadores[i].caminho);
+    }
+    free(threads);
+    free(trabalhadores);
+    free(estado.filas);
+    return status;
+}
+
+
+/*
+ * =================================================================================
+ * Configuração e Estatísticas
+ * =================================================================================
+ */
+
+/**
+ * @brief Define quantos trabalhadores os próximos percursos usam (0 = um por processador).
+ */
+void percurso_configurar_trabalhadores(uint32_t num_trabalhadores) {
+    trabalhadores_configurados = num_trabalhadores;
+}
+
+/**
+ * @brief Retorna quantos trabalhadores um percurso usa (entre 1 e PERCURSO_MAX_TRABALHADORES).
+ */
+uint32_t percurso_num_trabalhadores(void) {
+    long num = trabalhadores_configurados;
+    if (num == 0) num = sysconf(_SC_NPROCESSORS_ONLN);
+    if (num < 1) num = 1;
+    if (num > PERCURSO_MAX_TRABALHADORES) num = PERCURSO_MAX_TRABALHADORES;
+    return (uint32_t)num;
+}
+
+/**
+ * @brief Copia os contadores acumulados dos percursos.
+ */
+void percurso_obter_estatisticas(estatisticas_percurso* est) {
+    if (est) *est = estatisticas_percursos;
+}
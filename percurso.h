@@ -0,0 +1,77 @@
+/**
+ * @file       percurso.h
+ * @brief      Declaração do percurso paralelo e recursivo de diretórios (base de find, du e tree).
+ *
+ *  @author     Allan Custódio Diniz Marques (L33tSh4rk)
+ *
+ * O percurso visita uma sub-árvore inteira com vários trabalhadores (threads). Cada
+ * diretório encontrado vira uma tarefa na fila do trabalhador que o encontrou; o
+ * dono tira as tarefas do fim da própria fila (os diretórios mais recentes, como
+ * numa busca em profundidade) e os trabalhadores ociosos roubam do começo das filas
+ * alheias (os diretórios mais antigos, que tendem a ter as maiores sub-árvores).
+ *
+ * Cada diretório é lido por um único trabalhador, sob a trava de leitura do
+ * diretório (travas.h). Para cada entrada, o trabalhador lê o inode e chama o
+ * visitante. O ponteiro que o visitante devolve para um diretório é entregue de
+ * volta como `dados_do_pai` a cada um dos filhos desse diretório. Os filhos de um
+ * mesmo diretório são sempre visitados pelo mesmo trabalhador, então o visitante
+ * pode acumular totais nos dados do pai sem travas.
+ *
+ * A ordem de visita não é determinística; quem imprime resultados deve ordená-los.
+ * Links simbólicos não são seguidos.
+ *
+ * Data de criação: 16 de outubro de 2026
+ * Data de atualização: 16 de outubro de 2026
+ *
+ */
+
+#ifndef EXT2_PERCURSO_H
+#define EXT2_PERCURSO_H
+
+#include "headers.h"
+
+// Limite de trabalhadores de um percurso.
+#define PERCURSO_MAX_TRABALHADORES 64
+
+// Diretórios mais fundos que isto não são abertos (proteção contra imagens com ciclos).
+#define PERCURSO_PROFUNDIDADE_MAXIMA 4096
+
+/*
+ * Entrada entregue ao visitante. Os ponteiros só valem durante a chamada.
+ */
+typedef struct {
+    uint32_t inode_num;
+    uint32_t inode_pai;             // 0 para a raiz do percurso
+    uint32_t profundidade;          // 0 para a raiz do percurso
+    const char* caminho;            // Caminho completo, a partir do caminho da raiz
+    const char* nome;               // Último componente do caminho
+    const inode* ino;
+    uint32_t trabalhador;           // Índice do trabalhador (0 .. percurso_num_trabalhadores() - 1)
+} entrada_percurso;
+
+/*
+ * Chamado uma vez para cada entrada da sub-árvore, inclusive a raiz (com
+ * `dados_do_pai` igual aos dados iniciais do percurso). O valor devolvido para um
+ * diretório é repassado aos seus filhos; para as demais entradas é ignorado.
+ */
+typedef void* (*visitante_percurso)(const entrada_percurso* entrada, void* dados_do_pai, void* contexto);
+
+/*
+ * Contadores acumulados de todos os percursos (comando 'stats').
+ */
+typedef struct {
+    uint64_t percursos;             // Percursos executados
+    uint64_t diretorios;            // Diretórios lidos
+    uint64_t entradas;              // Entradas visitadas
+    uint64_t roubos;                // Tarefas tiradas da fila de outro trabalhador
+} estatisticas_percurso;
+
+int percurso_paralelo(int fd, const superbloco* sb, const group_desc* gdt, uint32_t inode_raiz, const char* caminho_raiz,
+                      visitante_percurso visitante, void* dados_iniciais, void* contexto);
+
+/* Configuração (0 = um trabalhador por processador) */
+void percurso_configurar_trabalhadores(uint32_t num_trabalhadores);
+uint32_t percurso_num_trabalhadores(void);
+void percurso_obter_estatisticas(estatisticas_percurso* est);
+
+#endif // EXT2_PERCURSO_H
@@ -0,0 +1,533 @@
+/**
+ * @file       servidor.c
+ * @brief      Implementação do modo servidor (socket Unix) e do cliente que conversa com ele.
+ *
+ * @author     Allan Custódio Diniz Marques (L33tSh4rk)
+ *
+ * O servidor espera pedidos com poll() e executa cada um com executar_comando, na
+ * sessão da conexão que o enviou. As conexões aceitas são não bloqueantes: cada uma
+ * acumula o seu pedido aos poucos, e o comando só roda quando o pedido chegou
+ * inteiro, de modo que um cliente lento ou parado no meio do envio não trava os demais. Durante a execução, stdout e stderr do processo
+ * são redirecionados (dup2) para dois arquivos temporários de captura; ao final, os
+ * tamanhos vão no cabeçalho da resposta e o conteúdo segue pelo socket com sendfile,
+ * sem passar pelo espaço do usuário. Assim os comandos continuam usando printf
+ * normalmente, sem saber que estão sendo atendidos remotamente.
+ *
+ * Data de criação: 16 de outubro de 2026
+ * Data de atualização: 16 de outubro de 2026
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <sys/sendfile.h>
+
+#include "servidor.h"
+#include "cache.h"
+
+/*
+ * Uma conexão aceita e a sessão do shell que pertence a ela.
+ */
+typedef struct {
+    int fd;
+    sessao_shell sessao;
+    cabecalho_pedido cabecalho;     // Cabeçalho do pedido em recepção
+    char* linha;                    // Linha do pedido (alocada quando o cabeçalho termina de chegar)
+    size_t recebidos;               // Bytes do pedido atual já recebidos (cabeçalho + linha)
+} conexao_cliente;
+
+/*
+ * Arquivos temporários que recebem o stdout e o stderr de um comando, e cópias dos
+ * descritores originais para restaurá-los depois.
+ */
+typedef struct {
+    FILE* saida;
+    FILE* erros;
+    int stdout_original;
+    int stderr_original;
+} captura_comando;
+
+// Ligado por SIGINT/SIGTERM: o servidor termina o pedido atual e encerra.
+static volatile sig_atomic_t parar_servidor = 0;
+
+
+/*
+ * =================================================================================
+ * Transferência pelo Socket
+ * =================================================================================
+ */
+
+/**
+ * @brief (Função Auxiliar Estática) Espera um socket não bloqueante aceitar mais dados.
+ * @return 0 quando há espaço, -1 se o outro lado não leu nada em SERVIDOR_ESPERA_ENVIO_MS.
+ */
+static int esperar_escrita(int fd) {
+    struct pollfd evento = { .fd = fd, .events = POLLOUT, .revents = 0 };
+    int prontos;
+    do {
+        prontos = poll(&evento, 1, SERVIDOR_ESPERA_ENVIO_MS);
+    } while (prontos == -1 && errno == EINTR);
+    return (prontos > 0) ? 0 : -1;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Escreve `tamanho` bytes, repetindo em escritas parciais.
+ * @return 0 em sucesso, -1 em erro.
+ */
+static int escrever_tudo(int fd, const void* dados, size_t tamanho) {
+    const char* p = dados;
+    while (tamanho > 0) {
+        ssize_t escritos = write(fd, p, tamanho);
+        if (escritos == -1) {
+            if (errno == EINTR) continue;
+            if ((errno == EAGAIN || errno == EWOULDBLOCK) && esperar_escrita(fd) == 0) continue;
+            return -1;
+        }
+        p += escritos;
+        tamanho -= (size_t)escritos;
+    }
+    return 0;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Lê exatamente `tamanho` bytes.
+ * @return 0 em sucesso, -1 em erro ou se a conexão fechar antes.
+ */
+static int ler_tudo(int fd, void* dados, size_t tamanho) {
+    char* p = dados;
+    while (tamanho > 0) {
+        ssize_t lidos = read(fd, p, tamanho);
+        if (lidos == -1 && errno == EINTR) continue;
+        if (lidos <= 0) return -1;
+        p += lidos;
+        tamanho -= (size_t)lidos;
+    }
+    return 0;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Envia os primeiros `tamanho` bytes de um arquivo pelo socket.
+ *
+ * Usa sendfile; se não for suportado, copia com read/write por um buffer.
+ * @return 0 em sucesso, -1 em erro.
+ */
+static int enviar_arquivo(int socket_fd, int arquivo_fd, uint64_t tamanho) {
+    off_t offset = 0;
+    while ((uint64_t)offset < tamanho) {
+        ssize_t enviados = sendfile(socket_fd, arquivo_fd, &offset, (size_t)(tamanho - (uint64_t)offset));
+        if (enviados == -1) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                if (esperar_escrita(socket_fd) != 0) return -1;
+                continue;
+            }
+            if (errno != EINVAL && errno != ENOSYS) return -1;
+            break;
+        }
+        if (enviados == 0) return -1; // O arquivo encolheu: não há como cumprir o cabeçalho
+    }
+
+    char buffer[65536];
+    while ((uint64_t)offset < tamanho) {
+        size_t pedido = (tamanho - (uint64_t)offset < sizeof(buffer)) ? (size_t)(tamanho - (uint64_t)offset) : sizeof(buffer);
+        ssize_t lidos = pread(arquivo_fd, buffer, pedido, offset);
+        if (lidos == -1 && errno == EINTR) continue;
+        if (lidos <= 0 || escrever_tudo(socket_fd, buffer, (size_t)lidos) != 0) return -1;
+        offset += lidos;
+    }
+    return 0;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Copia `tamanho` bytes do socket para um FILE* local.
+ * @return 0 em sucesso, -1 em erro.
+ */
+static int receber_para_arquivo(int socket_fd, FILE* destino, uint64_t tamanho) {
+    char buffer[65536];
+    while (tamanho > 0) {
+        size_t pedido = (tamanho < sizeof(buffer)) ? (size_t)tamanho : sizeof(buffer);
+        ssize_t lidos = read(socket_fd, buffer, pedido);
+        if (lidos == -1 && errno == EINTR) continue;
+        if (lidos <= 0) return -1;
+        fwrite(buffer, 1, (size_t)lidos, destino);
+        tamanho -= (uint64_t)lidos;
+    }
+    return 0;
+}
+
+
+/*
+ * =================================================================================
+ * Servidor
+ * =================================================================================
+ */
+
+/**
+ * @brief (Função Auxiliar Estática) Tratador de SIGINT/SIGTERM.
+ */
+static void ao_receber_sinal(int sinal) {
+    (void)sinal;
+    parar_servidor = 1;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Executa um comando com stdout e stderr redirecionados
+ * para os arquivos de captura.
+ */
+static int executar_capturando(sessao_shell* sessao, char* linha, captura_comando* captura) {
+    fflush(stdout);
+    fflush(stderr);
+    dup2(fileno(captura->saida), STDOUT_FILENO);
+    dup2(fileno(captura->erros), STDERR_FILENO);
+
+    // Outro cliente pode ter mudado a imagem desde o último comando desta sessão.
+    sessao_revalidar_diretorio_atual(sessao);
+    int status = executar_comando(sessao, linha);
+
+    fflush(stdout);
+    fflush(stderr);
+    dup2(captura->stdout_original, STDOUT_FILENO);
+    dup2(captura->stderr_original, STDERR_FILENO);
+    return status;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Lê o que já chegou do pedido atual, sem bloquear.
+ *
+ * Lê no máximo até o fim do pedido; o que o cliente já tiver enviado além disso
+ * fica no socket e é lido na próxima volta do poll().
+ *
+ * @return 1 se o pedido está completo em `cliente->linha`, 0 se ainda faltam bytes,
+ *         -1 se a conexão deve ser encerrada (fim, erro ou pedido grande demais).
+ */
+static int receber_pedido(conexao_cliente* cliente) {
+    for (;;) {
+        char* destino;
+        size_t faltam;
+        if (cliente->recebidos < sizeof(cliente->cabecalho)) {
+            destino = (char*)&cliente->cabecalho + cliente->recebidos;
+            faltam = sizeof(cliente->cabecalho) - cliente->recebidos;
+        } else {
+            size_t recebidos_linha = cliente->recebidos - sizeof(cliente->cabecalho);
+            if (recebidos_linha == cliente->cabecalho.tamanho) {
+                cliente->linha[recebidos_linha] = '\0';
+                return 1;
+            }
+            destino = cliente->linha + recebidos_linha;
+            faltam = cliente->cabecalho.tamanho - recebidos_linha;
+        }
+
+        ssize_t lidos = read(cliente->fd, destino, faltam);
+        if (lidos == -1) {
+            if (errno == EINTR) continue;
+            return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+        }
+        if (lidos == 0) return -1; // Cliente desconectou
+        cliente->recebidos += (size_t)lidos;
+
+        if (cliente->recebidos == sizeof(cliente->cabecalho)) {
+            if (cliente->cabecalho.tamanho > SERVIDOR_MAX_PEDIDO) {
+                fprintf(stderr, "Erro (servidor): pedido de %u bytes recusado.\n", cliente->cabecalho.tamanho);
+                return -1;
+            }
+            cliente->linha = malloc((size_t)cliente->cabecalho.tamanho + 1);
+            if (!cliente->linha) {
+                perror("Erro (servidor): falha ao alocar memória para o pedido");
+                return -1;
+            }
+        }
+    }
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Recebe o que chegou na conexão e, se o pedido estiver
+ * completo, executa o comando e envia a resposta.
+ * @return 0 se a conexão continua aberta, -1 se deve ser encerrada (fim, erro ou 'exit').
+ */
+static int atender_pedido(conexao_cliente* cliente, captura_comando* captura) {
+    int pronto = receber_pedido(cliente);
+    if (pronto <= 0) return pronto;
+
+    int status = executar_capturando(&cliente->sessao, cliente->linha, captura);
+    free(cliente->linha);
+    cliente->linha = NULL;
+    cliente->recebidos = 0;
+
+    // As capturas começam vazias a cada comando: o tamanho delas é a saída do comando.
+    int fd_saida = fileno(captura->saida), fd_erros = fileno(captura->erros);
+    off_t tamanho_saida = lseek(fd_saida, 0, SEEK_END);
+    off_t tamanho_erros = lseek(fd_erros, 0, SEEK_END);
+    cabecalho_resposta resposta = {
+        .status = status,
+        .reservado = 0,
+        .tamanho_saida = (tamanho_saida > 0) ? (uint64_t)tamanho_saida : 0,
+        .tamanho_erros = (tamanho_erros > 0) ? (uint64_t)tamanho_erros : 0
+    };
+    int falhou = escrever_tudo(cliente->fd, &resposta, sizeof(resposta)) != 0 ||
+                 enviar_arquivo(cliente->fd, fd_saida, resposta.tamanho_saida) != 0 ||
+                 enviar_arquivo(cliente->fd, fd_erros, resposta.tamanho_erros) != 0;
+
+    rewind(captura->saida);
+    rewind(captura->erros);
+    if (ftruncate(fd_saida, 0) != 0 || ftruncate(fd_erros, 0) != 0) {
+        perror("Erro (servidor): falha ao limpar a captura de saída");
+    }
+
+    return (falhou || status == COMANDO_SAIR) ? -1 : 0;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Cria o socket de escuta em `caminho_socket`.
+ *
+ * Um socket antigo no mesmo caminho (de um servidor que não encerrou direito) é
+ * substituído; qualquer outro tipo de arquivo é preservado e o servidor não sobe.
+ *
+ * @return O descritor do socket, ou -1 em erro.
+ */
+static int criar_socket_de_escuta(const char* caminho_socket) {
+    struct sockaddr_un endereco;
+    memset(&endereco, 0, sizeof(endereco));
+    endereco.sun_family = AF_UNIX;
+    if (strlen(caminho_socket) >= sizeof(endereco.sun_path)) {
+        fprintf(stderr, "Erro (servidor): caminho do socket longo demais: '%s'\n", caminho_socket);
+        return -1;
+    }
+    strcpy(endereco.sun_path, caminho_socket);
+
+    struct stat info;
+    if (lstat(caminho_socket, &info) == 0) {
+        if (!S_ISSOCK(info.st_mode)) {
+            fprintf(stderr, "Erro (servidor): '%s' já existe e não é um socket.\n", caminho_socket);
+            return -1;
+        }
+        unlink(caminho_socket);
+    }
+
+    int escuta = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (escuta == -1) {
+        perror("Erro (servidor): falha ao criar o socket");
+        return -1;
+    }
+    if (bind(escuta, (struct sockaddr*)&endereco, sizeof(endereco)) != 0 ||
+        listen(escuta, SERVIDOR_MAX_CLIENTES) != 0) {
+        perror("Erro (servidor): falha ao escutar no socket");
+        close(escuta);
+        return -1;
+    }
+    return escuta;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Fecha uma conexão e solta o diretório atual da sua sessão.
+ */
+static void encerrar_conexao(conexao_cliente* cliente) {
+    sessao_soltar_diretorio(cliente->sessao.diretorio_atual_inode);
+    close(cliente->fd);
+    cliente->fd = -1;
+    free(cliente->linha);
+    cliente->linha = NULL;
+    cliente->recebidos = 0;
+}
+
+/**
+ * @brief Atende comandos pelo socket Unix `caminho_socket` até receber SIGINT ou SIGTERM.
+ *
+ * Cada conexão começa uma sessão nova, copiada de `modelo` e posicionada na raiz.
+ * Os comandos das várias conexões são executados um de cada vez, na ordem em que
+ * terminam de chegar, sobre a mesma imagem e os mesmos caches.
+ *
+ * @param caminho_socket Onde criar o socket (é removido ao encerrar).
+ * @param modelo Sessão com a imagem já aberta (fd, superbloco, GDT).
+ * @return 0 quando encerrado por sinal, -1 se o servidor não pôde subir.
+ */
+int servidor_executar(const char* caminho_socket, const sessao_shell* modelo) {
+    captura_comando captura;
+    captura.saida = tmpfile();
+    captura.erros = tmpfile();
+    captura.stdout_original = dup(STDOUT_FILENO);
+    captura.stderr_original = dup(STDERR_FILENO);
+    if (!captura.saida || !captura.erros || captura.stdout_original == -1 || captura.stderr_original == -1) {
+        perror("Erro (servidor): falha ao preparar a captura de saída");
+        if (captura.saida) fclose(captura.saida);
+        if (captura.erros) fclose(captura.erros);
+        if (captura.stdout_original != -1) close(captura.stdout_original);
+        if (captura.stderr_original != -1) close(captura.stderr_original);
+        return -1;
+    }
+
+    int escuta = criar_socket_de_escuta(caminho_socket);
+    if (escuta == -1) {
+        fclose(captura.saida);
+        fclose(captura.erros);
+        close(captura.stdout_original);
+        close(captura.stderr_original);
+        return -1;
+    }
+
+    // Sem SA_RESTART: o sinal interrompe o poll() e o laço percebe o pedido de parada.
+    struct sigaction acao;
+    memset(&acao, 0, sizeof(acao));
+    acao.sa_handler = ao_receber_sinal;
+    sigemptyset(&acao.sa_mask);
+    sigaction(SIGINT, &acao, NULL);
+    sigaction(SIGTERM, &acao, NULL);
+    signal(SIGPIPE, SIG_IGN); // Cliente que some no meio da resposta vira erro de escrita, não sinal
+
+    printf("Servidor ouvindo em %s (Ctrl+C encerra).\n", caminho_socket);
+    fflush(stdout);
+
+    conexao_cliente clientes[SERVIDOR_MAX_CLIENTES];
+    for (int i = 0; i < SERVIDOR_MAX_CLIENTES; ++i) {
+        clientes[i].fd = -1;
+        clientes[i].linha = NULL;
+        clientes[i].recebidos = 0;
+    }
+    struct pollfd eventos[SERVIDOR_MAX_CLIENTES + 1];
+    int indice_cliente[SERVIDOR_MAX_CLIENTES + 1];
+
+    while (!parar_servidor) {
+        nfds_t num_eventos = 0;
+        eventos[num_eventos].fd = escuta;
+        eventos[num_eventos++].events = POLLIN;
+        for (int i = 0; i < SERVIDOR_MAX_CLIENTES; ++i) {
+            if (clientes[i].fd == -1) continue;
+            indice_cliente[num_eventos] = i;
+            eventos[num_eventos].fd = clientes[i].fd;
+            eventos[num_eventos++].events = POLLIN;
+        }
+
+        if (poll(eventos, num_eventos, -1) == -1) {
+            if (errno == EINTR) continue;
+            perror("Erro (servidor): poll");
+            break;
+        }
+
+        for (nfds_t e = 1; e < num_eventos && !parar_servidor; ++e) {
+            if (eventos[e].revents == 0) continue;
+            conexao_cliente* cliente = &clientes[indice_cliente[e]];
+            if (atender_pedido(cliente, &captura) != 0) encerrar_conexao(cliente);
+        }
+
+        if (eventos[0].revents & POLLIN) {
+            int nova = accept(escuta, NULL, NULL);
+            if (nova == -1) continue;
+            int livre = -1;
+            for (int i = 0; i < SERVIDOR_MAX_CLIENTES && livre == -1; ++i) {
+                if (clientes[i].fd == -1) livre = i;
+            }
+            if (livre == -1) {
+                fprintf(stderr, "Aviso (servidor): limite de %d conexões atingido; conexão recusada.\n", SERVIDOR_MAX_CLIENTES);
+                close(nova);
+                continue;
+            }
+            int flags = fcntl(nova, F_GETFL);
+            if (flags == -1 || fcntl(nova, F_SETFL, flags | O_NONBLOCK) == -1) {
+                perror("Erro (servidor): falha ao tornar a conexão não bloqueante");
+                close(nova);
+                continue;
+            }
+            if (sessao_fixar_diretorio(modelo->fd, modelo->sb, modelo->gdt, EXT2_ROOT_INO) != 0) {
+                close(nova);
+                continue;
+            }
+            clientes[livre].fd = nova;
+            clientes[livre].sessao = *modelo;
+            clientes[livre].sessao.diretorio_atual_inode = EXT2_ROOT_INO;
+            strcpy(clientes[livre].sessao.diretorio_atual_str, "/");
+        }
+    }
+
+    printf("Servidor encerrando.\n");
+    for (int i = 0; i < SERVIDOR_MAX_CLIENTES; ++i) {
+        if (clientes[i].fd != -1) encerrar_conexao(&clientes[i]);
+    }
+    close(escuta);
+    unlink(caminho_socket);
+    fclose(captura.saida);
+    fclose(captura.erros);
+    close(captura.stdout_original);
+    close(captura.stderr_original);
+    return 0;
+}
+
+
+/*
+ * =================================================================================
+ * Cliente
+ * =================================================================================
+ */
+
+/**
+ * @brief Conecta-se a um servidor escutando em `caminho_socket`.
+ * @return O descritor da conexão, ou -1 em erro.
+ */
+int cliente_conectar(const char* caminho_socket) {
+    struct sockaddr_un endereco;
+    memset(&endereco, 0, sizeof(endereco));
+    endereco.sun_family = AF_UNIX;
+    if (strlen(caminho_socket) >= sizeof(endereco.sun_path)) {
+        fprintf(stderr, "Erro (cliente): caminho do socket longo demais: '%s'\n", caminho_socket);
+        return -1;
+    }
+    strcpy(endereco.sun_path, caminho_socket);
+
+    int conexao = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (conexao == -1) {
+        perror("Erro (cliente): falha ao criar o socket");
+        return -1;
+    }
+    if (connect(conexao, (struct sockaddr*)&endereco, sizeof(endereco)) != 0) {
+        fprintf(stderr, "Erro (cliente): não foi possível conectar a '%s': %s\n", caminho_socket, strerror(errno));
+        close(conexao);
+        return -1;
+    }
+    return conexao;
+}
+
+/**
+ * @brief Envia uma linha de comando ao servidor e reproduz a resposta localmente.
+ *
+ * O stdout do comando vai para o stdout do cliente e o stderr para o stderr.
+ *
+ * @return O status do comando (0, 1 ou COMANDO_SAIR), ou SERVIDOR_SEM_CONEXAO se a
+ *         conexão falhar.
+ */
+int cliente_executar(int conexao, const char* linha) {
+    size_t tamanho = strlen(linha);
+    if (tamanho > SERVIDOR_MAX_PEDIDO) {
+        fprintf(stderr, "Erro (cliente): linha de comando longa demais (%zu bytes).\n", tamanho);
+        return 1;
+    }
+
+    cabecalho_pedido pedido = { .tamanho = (uint32_t)tamanho };
+    cabecalho_resposta resposta;
+    if (escrever_tudo(conexao, &pedido, sizeof(pedido)) != 0 ||
+        escrever_tudo(conexao, linha, tamanho) != 0 ||
+        ler_tudo(conexao, &resposta, sizeof(resposta)) != 0 ||
+        receber_para_arquivo(conexao, stdout, resposta.tamanho_saida) != 0) {
+        fprintf(stderr, "Erro (cliente): conexão com o servidor perdida.\n");
+        return SERVIDOR_SEM_CONEXAO;
+    }
+    fflush(stdout);
+    if (receber_para_arquivo(conexao, stderr, resposta.tamanho_erros) != 0) {
+        fprintf(stderr, "Erro (cliente): conexão com o servidor perdida.\n");
+        return SERVIDOR_SEM_CONEXAO;
+    }
+    return resposta.status;
+}
+
+/**
+ * @brief Encerra a conexão com o servidor.
+ */
+void cliente_desconectar(int conexao) {
+    if (conexao != -1) close(conexao);
+}
@@ -0,0 +1,62 @@
+/**
+ * @file       servidor.h
+ * @brief      Declaração do modo servidor (socket Unix) e do cliente que conversa com ele.
+ *
+ *  @author     Allan Custódio Diniz Marques (L33tSh4rk)
+ *
+ * Com `--servir <socket>` o shell abre a imagem uma única vez e passa a atender
+ * comandos de vários clientes locais por um socket Unix. Superbloco, GDT e caches
+ * ficam carregados entre um job e outro; cada conexão tem a sua própria sessão
+ * (diretório atual). Os comandos rodam um de cada vez, no processo do servidor.
+ *
+ * Protocolo (inteiros na ordem de bytes do host, já que o socket é local):
+ *   pedido:   cabecalho_pedido + `tamanho` bytes com a linha de comando (sem '\0')
+ *   resposta: cabecalho_resposta + `tamanho_saida` bytes do stdout do comando
+ *             + `tamanho_erros` bytes do seu stderr
+ * O status é o do comando (0 ou 1); COMANDO_SAIR responde a 'exit'/'quit' e
+ * encerra a conexão.
+ *
+ * Data de criação: 16 de outubro de 2026
+ * Data de atualização: 16 de outubro de 2026
+ *
+ */
+
+#ifndef EXT2_SERVIDOR_H
+#define EXT2_SERVIDOR_H
+
+#include <stdint.h>
+
+#include "commands.h"
+
+// Conexões atendidas ao mesmo tempo; as excedentes são recusadas.
+#define SERVIDOR_MAX_CLIENTES 64
+
+// Maior linha de comando aceita em um pedido.
+#define SERVIDOR_MAX_PEDIDO 65536
+
+// Tempo máximo (ms) que o servidor espera um cliente ler a resposta antes de desconectá-lo.
+#define SERVIDOR_ESPERA_ENVIO_MS 5000
+
+// Devolvido por cliente_executar quando a conexão com o servidor se perde.
+#define SERVIDOR_SEM_CONEXAO (-2)
+
+typedef struct {
+    uint32_t tamanho;               // Bytes da linha de comando que seguem o cabeçalho
+} cabecalho_pedido;
+
+typedef struct {
+    int32_t status;                 // Status do comando (0, 1 ou COMANDO_SAIR)
+    uint32_t reservado;
+    uint64_t tamanho_saida;         // Bytes do stdout que seguem o cabeçalho
+    uint64_t tamanho_erros;         // Bytes do stderr que seguem o stdout
+} cabecalho_resposta;
+
+/* Servidor */
+int servidor_executar(const char* caminho_socket, const sessao_shell* modelo);
+
+/* Cliente */
+int cliente_conectar(const char* caminho_socket);
+int cliente_executar(int conexao, const char* linha);
+void cliente_desconectar(int conexao);
+
+#endif // EXT2_SERVIDOR_H
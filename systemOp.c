@@ -10,7 +10,7 @@
  * entre o shell e o disco (imagem do sistema de arquivos).
  *
  * Data de criação: 24 de abril de 2025
- * Data de atualização: 6 de julho de 2025
+ * Data de atualização: 16 de outubro de 2026
  * 
  */
 
@@ -20,19 +20,45 @@
 #include <errno.h>
 #include <string.h>
 #include <time.h>
+#include <endian.h>
+#include <sys/stat.h>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
 #include "headers.h"
 #include "commands.h"
+#include "cache.h"
+#include "io.h"
+#include "htree.h"
+#include "iterador.h"
+#include "buffers.h"
+#include "travas.h"
 
 // A localização padrão (offset) do superbloco na imagem do disco.
 #define SUPERBLOCO_OFFSET 1024
 
 #define TAMANHO_CABECALHO_ENTRADA_DIR 8
 
+// Tamanho máximo de cada sequência contígua de blocos alocada pelo 'import'.
+#define IMPORTAR_BYTES_POR_SEQUENCIA (4u << 20)
+
+// Tamanho máximo de cada leitura grande feita ao percorrer uma sequência contígua de um arquivo.
+#define LEITURA_BYTES_POR_SEQUENCIA (256u << 10)
+
+// Blocos atendidos por vez em ler_blocos (vetor na pilha, sem malloc); pedidos maiores são divididos.
+#define LER_BLOCOS_POR_LOTE 64
+
 // Variável global estática para armazenar o tamanho do inode do sistema de arquivos atual.
 // É definida uma vez na leitura do superbloco para ser usada consistentemente.
 static uint16_t tamanho_inode_fs = EXT2_GOOD_OLD_INODE_SIZE;
 
+// Contadores das leituras de arquivos ('cat', 'cp'), exibidos pelo comando 'stats'.
+static estatisticas_leitura_arquivos estatisticas_leitura;
+
+// Contadores de ler_blocos, exibidos pelo comando 'stats'.
+static estatisticas_ler_blocos estatisticas_blocos_avulsos;
+
 
 /*
  * =================================================================================
@@ -43,7 +69,7 @@ static uint16_t tamanho_inode_fs = EXT2_GOOD_OLD_INODE_SIZE;
 /**
  * @brief Lê o superbloco do disco.
  *
- * Posiciona o leitor no offset padrão (1024 bytes) e lê os dados para a
+ * Lê o offset padrão (1024 bytes) da imagem com uma leitura posicional para a
  * estrutura `superbloco`. Em caso de sucesso, também atualiza a variável
  * global `tamanho_inode_fs`.
  *
@@ -57,14 +83,8 @@ int ler_superbloco(int fd, superbloco* sb) {
         return -1;
     }
 
-    // Posiciona o cursor no início do superbloco.
-    if (lseek(fd, SUPERBLOCO_OFFSET, SEEK_SET) == -1) {
-        perror("Erro (ler_superbloco): Falha ao posicionar (lseek) para o superbloco");
-        return -1;
-    }
-
-    // Lê os dados do superbloco do disco para a struct.
-    if (read(fd, sb, sizeof(superbloco)) != sizeof(superbloco)) {
+    // Lê os dados do superbloco (offset padrão de 1024 bytes) do disco para a struct.
+    if (io_ler_em(fd, sb, sizeof(superbloco), SUPERBLOCO_OFFSET) != sizeof(superbloco)) {
         perror("Erro (ler_superbloco): Falha ao ler os dados do superbloco");
         return -1;
     }
@@ -242,12 +262,7 @@ int escrever_superbloco(int fd, const superbloco* sb) {
         return -1;
     }
 
-    if (lseek(fd, SUPERBLOCO_OFFSET, SEEK_SET) == -1) {
-        perror("Erro (escrever_superbloco): Falha ao posicionar (lseek)");
-        return -1;
-    }
-
-    if (write(fd, sb, sizeof(superbloco)) != sizeof(superbloco)) {
+    if (io_escrever_em(fd, sb, sizeof(superbloco), SUPERBLOCO_OFFSET) != sizeof(superbloco)) {
         perror("Erro (escrever_superbloco): Falha ao escrever os dados");
         return -1;
     }
@@ -320,14 +335,8 @@ group_desc* ler_descritores_grupo(int fd, const superbloco* sb, uint32_t* num_gr
         return NULL;
     }
 
-    // Posiciona e lê a tabela inteira do disco.
-    if (lseek(fd, gdt_offset, SEEK_SET) == -1) {
-        perror("Erro (ler_descritores_grupo): Falha ao posicionar (lseek) para a GDT");
-        free(gdt);
-        return NULL;
-    }
-
-    if (read(fd, gdt, gdt_tamanho_total) != (ssize_t)gdt_tamanho_total) {
+    // Lê a tabela inteira do disco com uma única leitura posicional.
+    if (io_ler_em(fd, gdt, gdt_tamanho_total, gdt_offset) != (ssize_t)gdt_tamanho_total) {
         perror("Erro (ler_descritores_grupo): Falha ao ler os dados da GDT");
         free(gdt);
         return NULL;
@@ -336,6 +345,65 @@ group_desc* ler_descritores_grupo(int fd, const superbloco* sb, uint32_t* num_gr
     return gdt; // Sucesso
 }
 
+/*
+ * Contadores de blocos/inodes livres alterados pelos alocadores. O superbloco e os
+ * descritores sujos são gravados uma única vez por `sincronizar_metadados`, em vez de
+ * a cada bloco ou inode alocado/liberado.
+ */
+static int superbloco_sujo = 0;
+static uint8_t* descritores_sujos = NULL;
+static uint32_t num_descritores_sujos = 0;
+
+/**
+ * @brief (Função Auxiliar Estática) Marca o superbloco e o descritor de um grupo como alterados.
+ *
+ * Se a tabela de marcações não puder ser criada, grava os dois imediatamente, como
+ * era feito antes do adiamento.
+ */
+static void marcar_contadores_sujos(int fd, const superbloco* sb, const group_desc* gdt, uint32_t grupo) {
+    if (!descritores_sujos) {
+        uint32_t num_grupos = (sb->blocks_count + sb->blocks_per_group - 1) / sb->blocks_per_group;
+        descritores_sujos = calloc(num_grupos, sizeof(uint8_t));
+        if (!descritores_sujos) {
+            perror("Aviso (marcar_contadores_sujos): Falha ao alocar a tabela de descritores pendentes");
+            escrever_superbloco(fd, sb);
+            escrever_descritor_grupo(fd, sb, grupo, &gdt[grupo]);
+            return;
+        }
+        num_descritores_sujos = num_grupos;
+    }
+    superbloco_sujo = 1;
+    if (grupo < num_descritores_sujos) descritores_sujos[grupo] = 1;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Soma `blocos` e `inodes` (que podem ser negativos)
+ * aos contadores de livres do grupo e do superbloco.
+ *
+ * O chamador segura a trava do grupo; a do superbloco é adquirida aqui.
+ */
+static void ajustar_contadores_livres(int fd, superbloco* sb, group_desc* gdt, uint32_t grupo, int32_t blocos, int32_t inodes) {
+    gdt[grupo].free_blocks_count += blocos;
+    gdt[grupo].free_inodes_count += inodes;
+
+    trava_superbloco_adquirir();
+    sb->free_blocks_count += (uint32_t)blocos;
+    sb->free_inodes_count += (uint32_t)inodes;
+    // O superbloco e o descritor vão para o disco no próximo ponto de sincronização
+    marcar_contadores_sujos(fd, sb, gdt, grupo);
+    trava_superbloco_liberar();
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Lê do superbloco a quantidade de blocos ou de inodes livres.
+ */
+static uint32_t livres_no_superbloco(const superbloco* sb, tipo_bitmap tipo) {
+    trava_superbloco_adquirir();
+    uint32_t valor = (tipo == BITMAP_BLOCOS) ? sb->free_blocks_count : sb->free_inodes_count;
+    trava_superbloco_liberar();
+    return valor;
+}
+
 /**
  * @brief Escreve um descritor de grupo específico de volta no disco.
  *
@@ -357,12 +425,7 @@ int escrever_descritor_grupo(int fd, const superbloco* sb, uint32_t grupo_idx, c
     // Calcula o offset exato do descritor de grupo que queremos escrever.
     off_t gd_especifico_offset = gdt_base_offset + (grupo_idx * sizeof(group_desc));
 
-    if (lseek(fd, gd_especifico_offset, SEEK_SET) == -1) {
-        perror("Erro (escrever_descritor_grupo): Falha ao posicionar (lseek)");
-        return -1;
-    }
-
-    if (write(fd, gd, sizeof(group_desc)) != sizeof(group_desc)) {
+    if (io_escrever_em(fd, gd, sizeof(group_desc), gd_especifico_offset) != sizeof(group_desc)) {
         perror("Erro (escrever_descritor_grupo): Falha ao escrever os dados");
         return -1;
     }
@@ -379,6 +442,10 @@ void liberar_descritores_grupo(group_desc* gdt) {
     if (gdt) {
         free(gdt);
     }
+    // A marcação de descritores pendentes pertence à GDT que está sendo liberada.
+    free(descritores_sujos);
+    descritores_sujos = NULL;
+    num_descritores_sujos = 0;
 }
 
 
@@ -389,14 +456,14 @@ void liberar_descritores_grupo(group_desc* gdt) {
  */
 
 /**
- * @brief Lê um inode específico do disco.
+ * @brief Lê um inode, consultando primeiro o cache de inodes.
  *
- * Calcula a localização exata de um inode com base no seu número, lê os dados
- * do disco e preenche a estrutura 'inode_out' fornecida.
+ * Em caso de falta, o inode é lido da tabela de inodes (`ler_inode_disco`) e
+ * guardado no cache para as próximas consultas.
  *
  * @param fd O descritor de arquivo da imagem do disco.
- * @param sb O superbloco do sistema de arquivos (necessário para os cálculos).
- * @param gdt A tabela de descritores de grupo (para encontrar a tabela de inodes).
+ * @param sb O superbloco do sistema de arquivos.
+ * @param gdt A tabela de descritores de grupo.
  * @param inode_num O número do inode a ser lido (começando em 1).
  * @param inode_out Ponteiro para a estrutura 'inode' onde os dados serão armazenados.
  * @return 0 em caso de sucesso, -1 em caso de erro.
@@ -411,6 +478,70 @@ int ler_inode(int fd, const superbloco* sb, const group_desc* gdt, uint32_t inod
         return -1;
     }
 
+    if (cache_inodes_buscar(inode_num, inode_out)) return 0;
+
+    // A falta é lida sem a trava do inode: se uma escrita passou pelo cache durante a
+    // leitura, a cópia lida pode estar velha e o inode é lido de novo.
+    for (;;) {
+        uint64_t geracao = cache_inodes_geracao();
+        if (ler_inode_disco(fd, sb, gdt, inode_num, inode_out) != 0) return -1;
+        if (cache_inodes_guardar_lido(fd, sb, gdt, inode_num, inode_out, geracao) == 0) return 0;
+    }
+}
+
+/**
+ * @brief Escreve um inode, passando pelo cache de inodes.
+ *
+ * Em modo write-back, o inode apenas é atualizado no cache e marcado como sujo;
+ * a gravação acontece no despejo ou no 'sync'. Em modo write-through, o inode é
+ * gravado imediatamente e a cópia em cache é atualizada.
+ *
+ * @param fd O descritor de arquivo.
+ * @param sb O superbloco.
+ * @param gdt A tabela de descritores de grupo.
+ * @param inode_num O número do inode a ser escrito.
+ * @param inode_in Ponteiro para a estrutura 'inode' contendo os dados a serem escritos.
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int escrever_inode(int fd, const superbloco* sb, const group_desc* gdt, uint32_t inode_num, const inode* inode_in) {
+    if (inode_num == 0 || inode_num > sb->inodes_count) {
+        fprintf(stderr, "Erro (escrever_inode): Número de inode inválido: %u\n", inode_num);
+        return -1;
+    }
+    if (!inode_in) {
+        fprintf(stderr, "Erro (escrever_inode): A estrutura de entrada do inode é nula.\n");
+        return -1;
+    }
+
+    // A cópia do cache e a do disco são atualizadas juntas, sem outra escrita no meio.
+    int status = 0;
+    trava_inode_adquirir(inode_num);
+    if (cache_inodes_write_back() &&
+        cache_inodes_guardar(fd, sb, gdt, inode_num, inode_in, 1) == 0) {
+        status = 0;
+    } else if (escrever_inode_disco(fd, sb, gdt, inode_num, inode_in) != 0) {
+        status = -1;
+    } else {
+        cache_inodes_guardar(fd, sb, gdt, inode_num, inode_in, 0);
+    }
+    trava_inode_liberar(inode_num);
+    return status;
+}
+
+/**
+ * @brief Lê um inode específico do disco, sem passar pelo cache de inodes.
+ *
+ * Calcula a localização exata de um inode com base no seu número, lê os dados
+ * do disco e preenche a estrutura 'inode_out' fornecida.
+ *
+ * @param fd O descritor de arquivo da imagem do disco.
+ * @param sb O superbloco do sistema de arquivos (necessário para os cálculos).
+ * @param gdt A tabela de descritores de grupo (para encontrar a tabela de inodes).
+ * @param inode_num O número do inode a ser lido (começando em 1).
+ * @param inode_out Ponteiro para a estrutura 'inode' onde os dados serão armazenados.
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int ler_inode_disco(int fd, const superbloco* sb, const group_desc* gdt, uint32_t inode_num, inode* inode_out) {
     // Descobrir a qual grupo de blocos o inode pertence.
     uint32_t grupo_idx = (inode_num - 1) / sb->inodes_per_group;
 
@@ -428,14 +559,28 @@ int ler_inode(int fd, const superbloco* sb, const group_desc* gdt, uint32_t inod
     uint16_t tamanho_inode = obter_tamanho_inode(sb);
     off_t offset_final_inode = inicio_tabela_inodes + (indice_no_grupo * tamanho_inode);
 
-    // Posicionar o cursor e ler o inode.
-    if (lseek(fd, offset_final_inode, SEEK_SET) == -1) {
-        perror("Erro (ler_inode): Falha ao posicionar (lseek) para o inode");
-        return -1;
+    // Com o cache de blocos ativo, lê o bloco da tabela de inodes que contém o inode
+    // (vizinhos costumam ser lidos em seguida) e copia apenas a fatia desejada.
+    if (cache_blocos_ativo()) {
+        unsigned char* bloco_tabela = buffer_bloco_obter();
+        if (!bloco_tabela) {
+            perror("Erro (ler_inode_disco): Falha ao alocar buffer");
+            return -1;
+        }
+        uint32_t num_bloco_tabela = (uint32_t)(offset_final_inode / tamanho_bloco);
+        if (ler_bloco(fd, sb, num_bloco_tabela, bloco_tabela) != 0) {
+            fprintf(stderr, "Erro (ler_inode_disco): Falha ao ler o bloco %u da tabela de inodes.\n", num_bloco_tabela);
+            buffer_bloco_devolver(bloco_tabela);
+            return -1;
+        }
+        memcpy(inode_out, bloco_tabela + (offset_final_inode % tamanho_bloco), sizeof(inode));
+        buffer_bloco_devolver(bloco_tabela);
+        return 0;
     }
 
-    if (read(fd, inode_out, sizeof(inode)) != sizeof(inode)) {
-        perror("Erro (ler_inode): Falha ao ler os dados do inode");
+    // Lê o inode diretamente da sua posição na tabela.
+    if (io_ler_em(fd, inode_out, sizeof(inode), offset_final_inode) != sizeof(inode)) {
+        perror("Erro (ler_inode_disco): Falha ao ler os dados do inode");
         return -1;
     }
 
@@ -443,7 +588,7 @@ int ler_inode(int fd, const superbloco* sb, const group_desc* gdt, uint32_t inod
 }
 
 /**
- * @brief Escreve uma estrutura de inode de volta para o disco.
+ * @brief Escreve uma estrutura de inode de volta para o disco, sem passar pelo cache de inodes.
  *
  * Calcula a localização exata de um inode e escreve o conteúdo de 'inode_in'
  * para essa posição.
@@ -455,16 +600,7 @@ int ler_inode(int fd, const superbloco* sb, const group_desc* gdt, uint32_t inod
  * @param inode_in Ponteiro para a estrutura 'inode' contendo os dados a serem escritos.
  * @return 0 em caso de sucesso, -1 em caso de erro.
  */
-int escrever_inode(int fd, const superbloco* sb, const group_desc* gdt, uint32_t inode_num, const inode* inode_in) {
-    if (inode_num == 0 || inode_num > sb->inodes_count) {
-        fprintf(stderr, "Erro (escrever_inode): Número de inode inválido: %u\n", inode_num);
-        return -1;
-    }
-    if (!inode_in) {
-        fprintf(stderr, "Erro (escrever_inode): A estrutura de entrada do inode é nula.\n");
-        return -1;
-    }
-
+int escrever_inode_disco(int fd, const superbloco* sb, const group_desc* gdt, uint32_t inode_num, const inode* inode_in) {
     // A lógica para encontrar o offset do inode é idêntica à da função de leitura.
     uint32_t grupo_idx = (inode_num - 1) / sb->inodes_per_group;
     const group_desc* gd = &gdt[grupo_idx];
@@ -474,14 +610,32 @@ int escrever_inode(int fd, const superbloco* sb, const group_desc* gdt, uint32_t
     uint16_t tamanho_inode = obter_tamanho_inode(sb);
     off_t offset_final_inode = inicio_tabela_inodes + (indice_no_grupo * tamanho_inode);
 
-    // Posicionar o cursor e escrever o inode.
-    if (lseek(fd, offset_final_inode, SEEK_SET) == -1) {
-        perror("Erro (escrever_inode): Falha ao posicionar (lseek) para o inode");
-        return -1;
+    // Com o cache ativo, altera a fatia do inode dentro do bloco da tabela em memória.
+    // O bloco é compartilhado com os outros inodes dele: a trava do grupo impede que
+    // duas gravações simultâneas percam uma à outra.
+    if (cache_blocos_ativo()) {
+        unsigned char* bloco_tabela = buffer_bloco_obter();
+        if (!bloco_tabela) {
+            perror("Erro (escrever_inode_disco): Falha ao alocar buffer");
+            return -1;
+        }
+        uint32_t num_bloco_tabela = (uint32_t)(offset_final_inode / tamanho_bloco);
+        trava_grupo_adquirir(grupo_idx);
+        int status = ler_bloco(fd, sb, num_bloco_tabela, bloco_tabela);
+        if (status != 0) {
+            fprintf(stderr, "Erro (escrever_inode_disco): Falha ao ler o bloco %u da tabela de inodes.\n", num_bloco_tabela);
+        } else {
+            memcpy(bloco_tabela + (offset_final_inode % tamanho_bloco), inode_in, sizeof(inode));
+            status = escrever_bloco(fd, sb, num_bloco_tabela, bloco_tabela);
+        }
+        trava_grupo_liberar(grupo_idx);
+        buffer_bloco_devolver(bloco_tabela);
+        return status;
     }
-    
-    if (write(fd, inode_in, sizeof(inode)) != sizeof(inode)) {
-        perror("Erro (escrever_inode): Falha ao escrever os dados do inode");
+
+    // Escreve o inode diretamente na sua posição na tabela.
+    if (io_escrever_em(fd, inode_in, sizeof(inode), offset_final_inode) != sizeof(inode)) {
+        perror("Erro (escrever_inode_disco): Falha ao escrever os dados do inode");
         return -1;
     }
 
@@ -540,8 +694,9 @@ void print_inode(const inode* ino, uint32_t inode_num) {
  * @brief Aloca um inode livre no sistema de arquivos.
  *
  * Percorre os descritores de grupo em busca de um que tenha inodes livres.
- * Lê o bitmap de inodes correspondente, encontra o primeiro bit zero,
- * marca-o como um, atualiza os contadores e escreve tudo de volta no disco.
+ * Obtém o bitmap de inodes do grupo no cache de bitmaps, encontra o primeiro bit
+ * zero, marca-o como um e atualiza os contadores. O bitmap só é gravado no disco
+ * no próximo ponto de sincronização (ver `sincronizar_metadados`).
  *
  * @param fd O descritor de arquivo.
  * @param sb O superbloco (será modificado se um inode for alocado).
@@ -549,62 +704,43 @@ void print_inode(const inode* ino, uint32_t inode_num) {
  * @return O número do inode alocado em caso de sucesso, 0 em caso de falha.
  */
 uint32_t alocar_inode(int fd, superbloco* sb, group_desc* gdt) {
-    if (sb->free_inodes_count == 0) {
+    if (livres_no_superbloco(sb, BITMAP_INODES) == 0) {
         fprintf(stderr, "Erro (alocar_inode): Não há inodes livres no sistema de arquivos.\n");
         return 0; // Falha, sem inodes livres
     }
 
     uint32_t num_grupos = (sb->blocks_count + sb->blocks_per_group - 1) / sb->blocks_per_group;
-    uint32_t tamanho_bloco = calcular_tamanho_do_bloco(sb);
-    unsigned char* bitmap_buffer = (unsigned char*) malloc(tamanho_bloco);
-    if (!bitmap_buffer) {
-        perror("Erro (alocar_inode): Falha ao alocar buffer para o bitmap");
-        return 0;
-    }
 
-    // Itera por cada grupo de blocos
+    // Itera por cada grupo de blocos; bitmap e contadores do grupo só mudam com a trava dele
     for (uint32_t i = 0; i < num_grupos; ++i) {
+        trava_grupo_adquirir(i);
         // Otimização: só verifica este grupo se ele tiver inodes livres
         if (gdt[i].free_inodes_count > 0) {
-            // Lê o bitmap de inodes deste grupo
-            if (ler_bloco(fd, sb, gdt[i].inode_bitmap, bitmap_buffer) != 0) {
+            unsigned char* bitmap = cache_bitmaps_obter(fd, sb, gdt, i, BITMAP_INODES);
+            if (!bitmap) {
+                trava_grupo_liberar(i);
                 fprintf(stderr, "Aviso (alocar_inode): Falha ao ler o bitmap de inodes do grupo %u. Tentando próximo grupo.\n", i);
                 continue;
             }
 
             // Encontra o primeiro bit livre (0) no bitmap
-            for (uint32_t j = 0; j < sb->inodes_per_group; ++j) {
-                if (!bit_esta_setado(bitmap_buffer, j)) {
-                    // Bit livre encontrado!
-                    setar_bit(bitmap_buffer, j);
-
-                    // Escreve o bitmap modificado de volta no disco
-                    if (escrever_bloco(fd, sb, gdt[i].inode_bitmap, bitmap_buffer) != 0) {
-                        fprintf(stderr, "Erro (alocar_inode): Falha ao escrever o bitmap de inodes atualizado.\n");
-                        free(bitmap_buffer);
-                        return 0; // Falha crítica
-                    }
-
-                    // Atualiza os contadores em memória
-                    sb->free_inodes_count--;
-                    gdt[i].free_inodes_count--;
-
-                    // Salva as estruturas atualizadas no disco
-                    escrever_superbloco(fd, sb);
-                    escrever_descritor_grupo(fd, sb, i, &gdt[i]);
-                    
-                    free(bitmap_buffer);
-
-                    // Calcula e retorna o número global do inode (base 1)
-                    return (i * sb->inodes_per_group) + j + 1;
-                }
+            int32_t j = bitmap_procurar_zero(bitmap, 0, sb->inodes_per_group);
+            if (j >= 0) {
+                // Bit livre encontrado!
+                setar_bit(bitmap, j);
+                cache_bitmaps_marcar_sujo(i, BITMAP_INODES);
+                ajustar_contadores_livres(fd, sb, gdt, i, 0, -1);
+                trava_grupo_liberar(i);
+
+                // Calcula e retorna o número global do inode (base 1)
+                return (i * sb->inodes_per_group) + (uint32_t)j + 1;
             }
         }
+        trava_grupo_liberar(i);
     }
 
     // Se o loop terminar, algo está inconsistente (ex: contadores errados)
     fprintf(stderr, "Erro (alocar_inode): Inconsistência! Superbloco indica inodes livres, mas nenhum foi encontrado.\n");
-    free(bitmap_buffer);
     return 0; // Falha
 }
 
@@ -625,47 +761,34 @@ int liberar_inode(int fd, superbloco* sb, group_desc* gdt, uint32_t inode_num) {
 
     uint32_t grupo_idx = (inode_num - 1) / sb->inodes_per_group;
     uint32_t indice_no_bitmap = (inode_num - 1) % sb->inodes_per_group;
-    
-    uint32_t tamanho_bloco = calcular_tamanho_do_bloco(sb);
-    unsigned char* bitmap_buffer = (unsigned char*) malloc(tamanho_bloco);
-    if (!bitmap_buffer) {
-        perror("Erro (liberar_inode): Falha ao alocar buffer para o bitmap");
-        return -1;
-    }
-    
-    // Lê o bitmap de inodes do grupo correspondente
-    if (ler_bloco(fd, sb, gdt[grupo_idx].inode_bitmap, bitmap_buffer) != 0) {
+
+    // Obtém o bitmap de inodes do grupo correspondente (lido do disco só na primeira vez)
+    trava_grupo_adquirir(grupo_idx);
+    unsigned char* bitmap = cache_bitmaps_obter(fd, sb, gdt, grupo_idx, BITMAP_INODES);
+    if (!bitmap) {
+        trava_grupo_liberar(grupo_idx);
         fprintf(stderr, "Erro (liberar_inode): Falha ao ler o bitmap de inodes do grupo %u.\n", grupo_idx);
-        free(bitmap_buffer);
         return -1;
     }
 
     // Verifica se o inode já não estava livre
-    if (!bit_esta_setado(bitmap_buffer, indice_no_bitmap)) {
+    if (!bit_esta_setado(bitmap, indice_no_bitmap)) {
+        trava_grupo_liberar(grupo_idx);
         fprintf(stderr, "Aviso (liberar_inode): Inode %u já estava livre.\n", inode_num);
-        free(bitmap_buffer);
         return 0; // Não é um erro fatal, consideramos sucesso
     }
 
-    // Limpa o bit
-    limpar_bit(bitmap_buffer, indice_no_bitmap);
+    // Limpa o bit; a gravação fica para o próximo ponto de sincronização
+    limpar_bit(bitmap, indice_no_bitmap);
+    cache_bitmaps_marcar_sujo(grupo_idx, BITMAP_INODES);
 
-    // Escreve o bitmap modificado de volta
-    if (escrever_bloco(fd, sb, gdt[grupo_idx].inode_bitmap, bitmap_buffer) != 0) {
-        fprintf(stderr, "Erro (liberar_inode): Falha ao escrever o bitmap de inodes atualizado.\n");
-        free(bitmap_buffer);
-        return -1;
-    }
+    // O número pode ser reaproveitado por outro arquivo: nomes resolvidos dentro dele
+    // (ou que apontavam para ele) deixam de valer.
+    cache_dentries_invalidar_diretorio(inode_num);
 
-    // Atualiza os contadores em memória
-    sb->free_inodes_count++;
-    gdt[grupo_idx].free_inodes_count++;
-    
-    // Salva as estruturas atualizadas no disco
-    escrever_superbloco(fd, sb);
-    escrever_descritor_grupo(fd, sb, grupo_idx, &gdt[grupo_idx]);
+    ajustar_contadores_livres(fd, sb, gdt, grupo_idx, 0, 1);
+    trava_grupo_liberar(grupo_idx);
 
-    free(bitmap_buffer);
     return 0; // Sucesso
 }
 
@@ -677,7 +800,10 @@ int liberar_inode(int fd, superbloco* sb, group_desc* gdt, uint32_t inode_num) {
  */
 
 /**
- * @brief Lê o conteúdo de um único bloco do disco para um buffer.
+ * @brief Lê o conteúdo de um único bloco para um buffer.
+ *
+ * Se o cache de blocos estiver ativo, a leitura é atendida por ele e o disco só é
+ * acessado em caso de falta. Caso contrário, lê diretamente da imagem.
  *
  * @param fd O descritor de arquivo da imagem do disco.
  * @param sb O superbloco, usado para obter o tamanho do bloco.
@@ -698,17 +824,172 @@ int ler_bloco(int fd, const superbloco* sb, uint32_t num_bloco, void* buffer) {
         return -1;
     }
 
-    uint32_t tamanho_bloco = calcular_tamanho_do_bloco(sb);
-    off_t offset = (off_t)num_bloco * tamanho_bloco;
+    if (cache_blocos_ativo()) {
+        return cache_blocos_ler(fd, sb, num_bloco, buffer);
+    }
+    return ler_bloco_disco(fd, sb, num_bloco, buffer);
+}
+
+/*
+ * Um bloco pedido a ler_blocos: o número físico e a posição no vetor do chamador.
+ */
+typedef struct {
+    uint32_t num_bloco;
+    uint32_t indice;
+} bloco_pedido;
+
+static int comparar_blocos_pedidos(const void* a, const void* b) {
+    uint32_t ba = ((const bloco_pedido*)a)->num_bloco;
+    uint32_t bb = ((const bloco_pedido*)b)->num_bloco;
+    return (ba > bb) - (ba < bb);
+}
 
-    // Posiciona o cursor no início do bloco desejado.
-    if (lseek(fd, offset, SEEK_SET) == -1) {
-        perror("Erro (ler_bloco): Falha ao posicionar (lseek) para o bloco de dados");
+/**
+ * @brief Lê vários blocos avulsos de uma vez (ex: todos os endereçados por um bloco de ponteiros).
+ *
+ * Os blocos que estão no cache saem dele. Os demais são ordenados pelo número
+ * físico e cada sequência de blocos vizinhos no disco vira uma única preadv,
+ * espalhada direto pelos buffers do chamador; depois eles entram no cache como
+ * limpos, como aconteceria com `ler_bloco`. Números repetidos são lidos uma vez só.
+ *
+ * @param fd O descritor de arquivo da imagem do disco.
+ * @param sb O superbloco.
+ * @param nums Os números dos blocos, em qualquer ordem.
+ * @param quantidade Quantidade de blocos.
+ * @param buffers O buffer de destino de cada bloco (um bloco de tamanho cada).
+ * @return 0 se todos os blocos foram lidos, -1 se algum falhar (os demais ficam lidos).
+ */
+int ler_blocos(int fd, const superbloco* sb, const uint32_t* nums, uint32_t quantidade, void* const* buffers) {
+    if (!sb || !nums || !buffers) {
+        fprintf(stderr, "Erro (ler_blocos): Argumentos nulos.\n");
         return -1;
     }
+    if (quantidade == 0) return 0;
+    if (quantidade > LER_BLOCOS_POR_LOTE) {
+        int status = 0;
+        for (uint32_t inicio = 0; inicio < quantidade; inicio += LER_BLOCOS_POR_LOTE) {
+            uint32_t parte = quantidade - inicio;
+            if (parte > LER_BLOCOS_POR_LOTE) parte = LER_BLOCOS_POR_LOTE;
+            if (ler_blocos(fd, sb, nums + inicio, parte, buffers + inicio) != 0) status = -1;
+        }
+        return status;
+    }
+
+    uint32_t tamanho_bloco = calcular_tamanho_do_bloco(sb);
+    contador_somar(&estatisticas_blocos_avulsos.chamadas, 1);
+    contador_somar(&estatisticas_blocos_avulsos.blocos, quantidade);
+
+    bloco_pedido faltando[LER_BLOCOS_POR_LOTE];
+
+    // Os blocos que faltam são lidos por fora do cache; uma escrita no meio do caminho
+    // é percebida pela geração (cache_blocos_preencher) e o bloco é lido de novo.
+    uint64_t geracao = cache_blocos_geracao();
+    int status = 0;
+    uint32_t num_faltando = 0;
+    for (uint32_t i = 0; i < quantidade; ++i) {
+        if (nums[i] >= sb->blocks_count) {
+            fprintf(stderr, "Erro (ler_blocos): Tentativa de ler um bloco (%u) fora dos limites do disco (%u).\n",
+                    nums[i], sb->blocks_count);
+            status = -1;
+        } else if (cache_blocos_contem(nums[i])) {
+            if (cache_blocos_ler(fd, sb, nums[i], buffers[i]) != 0) status = -1;
+            contador_somar(&estatisticas_blocos_avulsos.do_cache, 1);
+        } else {
+            faltando[num_faltando].num_bloco = nums[i];
+            faltando[num_faltando].indice = i;
+            num_faltando++;
+        }
+    }
+    qsort(faltando, num_faltando, sizeof(bloco_pedido), comparar_blocos_pedidos);
+
+    struct iovec vetor[IO_MAX_VETOR];
+    uint32_t i = 0;
+    while (i < num_faltando) {
+        // Junta os blocos vizinhos no disco (repetições ficam fora do vetor).
+        uint32_t fim = i + 1;
+        int num_vetor = 1;
+        vetor[0].iov_base = buffers[faltando[i].indice];
+        vetor[0].iov_len = tamanho_bloco;
+        while (fim < num_faltando) {
+            uint32_t anterior = faltando[fim - 1].num_bloco;
+            if (faltando[fim].num_bloco == anterior) {
+                fim++;
+                continue;
+            }
+            if (faltando[fim].num_bloco != anterior + 1 || num_vetor == IO_MAX_VETOR) break;
+            vetor[num_vetor].iov_base = buffers[faltando[fim].indice];
+            vetor[num_vetor].iov_len = tamanho_bloco;
+            num_vetor++;
+            fim++;
+        }
+
+        off_t offset = (off_t)faltando[i].num_bloco * tamanho_bloco;
+        size_t esperado = (size_t)num_vetor * tamanho_bloco;
+        contador_somar(&estatisticas_blocos_avulsos.leituras, 1);
+        if (io_ler_vetor_em(fd, vetor, num_vetor, offset) != (ssize_t)esperado) {
+            fprintf(stderr, "Erro (ler_blocos): Falha ao ler os blocos %u a %u.\n",
+                    faltando[i].num_bloco, faltando[fim - 1].num_bloco);
+            status = -1;
+        } else {
+            for (uint32_t k = i; k < fim; ++k) {
+                void* destino = buffers[faltando[k].indice];
+                if (k > i && faltando[k].num_bloco == faltando[k - 1].num_bloco) {
+                    memcpy(destino, buffers[faltando[k - 1].indice], tamanho_bloco);
+                } else if (cache_blocos_preencher(fd, sb, faltando[k].num_bloco, destino, geracao) == 1 &&
+                           cache_blocos_ler(fd, sb, faltando[k].num_bloco, destino) != 0) {
+                    status = -1;
+                }
+            }
+        }
+        i = fim;
+    }
+    return status;
+}
+
+/**
+ * @brief Copia os contadores de ler_blocos.
+ */
+void obter_estatisticas_ler_blocos(estatisticas_ler_blocos* est) {
+    if (est) *est = estatisticas_blocos_avulsos;
+}
+
+/**
+ * @brief Obtém o conteúdo de um bloco para leitura, evitando cópias quando possível.
+ *
+ * No modo --mmap, retorna um ponteiro direto para o bloco dentro do mapeamento da
+ * imagem (nenhuma chamada de sistema e nenhuma cópia). Nos demais modos, lê o bloco
+ * com `ler_bloco` para `buffer_reserva` e retorna esse buffer.
+ *
+ * O ponteiro retornado é somente leitura e só é válido até a próxima escrita no bloco.
+ *
+ * @param buffer_reserva Buffer com um bloco de tamanho, usado quando não há mapeamento.
+ * @return Ponteiro para os dados do bloco, ou NULL em caso de erro.
+ */
+const void* ler_bloco_ref(int fd, const superbloco* sb, uint32_t num_bloco, void* buffer_reserva) {
+    if (io_imagem_mapeada(fd) && num_bloco < sb->blocks_count) {
+        uint32_t tamanho_bloco = calcular_tamanho_do_bloco(sb);
+        const void* bloco = io_ponteiro_em(fd, (off_t)num_bloco * tamanho_bloco, tamanho_bloco);
+        if (bloco) return bloco;
+    }
+
+    if (ler_bloco(fd, sb, num_bloco, buffer_reserva) != 0) return NULL;
+    return buffer_reserva;
+}
+
+/**
+ * @brief Lê um bloco diretamente da imagem, sem passar pelo cache.
+ *
+ * Usada por `ler_bloco` quando o cache está desligado e pelo próprio cache
+ * para buscar blocos em caso de falta. Não valida os argumentos.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int ler_bloco_disco(int fd, const superbloco* sb, uint32_t num_bloco, void* buffer) {
+    uint32_t tamanho_bloco = calcular_tamanho_do_bloco(sb);
+    off_t offset = (off_t)num_bloco * tamanho_bloco;
 
     // Lê o bloco inteiro para o buffer.
-    ssize_t bytes_lidos = read(fd, buffer, tamanho_bloco);
+    ssize_t bytes_lidos = io_ler_em(fd, buffer, tamanho_bloco, offset);
     if (bytes_lidos == -1) {
         perror("Erro (ler_bloco): Falha ao ler os dados do bloco");
         return -1;
@@ -725,7 +1006,10 @@ int ler_bloco(int fd, const superbloco* sb, uint32_t num_bloco, void* buffer) {
 
 
 /**
- * @brief Escreve o conteúdo de um buffer para um único bloco no disco.
+ * @brief Escreve o conteúdo de um buffer para um único bloco.
+ *
+ * Com o cache de blocos ativo, a escrita é adiada (write-back): o bloco fica sujo
+ * em memória até ser despejado ou até o próximo 'sync'.
  *
  * @param fd O descritor de arquivo da imagem do disco.
  * @param sb O superbloco, usado para obter o tamanho do bloco.
@@ -746,17 +1030,26 @@ int escrever_bloco(int fd, const superbloco* sb, uint32_t num_bloco, const void*
         return -1;
     }
 
+    if (cache_blocos_ativo()) {
+        return cache_blocos_escrever(fd, sb, num_bloco, buffer);
+    }
+    return escrever_bloco_disco(fd, sb, num_bloco, buffer);
+}
+
+/**
+ * @brief Escreve um bloco diretamente na imagem, sem passar pelo cache.
+ *
+ * Usada por `escrever_bloco` quando o cache está desligado e pelo cache ao
+ * gravar blocos sujos. Não valida os argumentos.
+ *
+ * @return 0 em caso de sucesso, -1 em caso de erro.
+ */
+int escrever_bloco_disco(int fd, const superbloco* sb, uint32_t num_bloco, const void* buffer) {
     uint32_t tamanho_bloco = calcular_tamanho_do_bloco(sb);
     off_t offset = (off_t)num_bloco * tamanho_bloco;
 
-    // Posiciona o cursor no início do bloco desejado.
-    if (lseek(fd, offset, SEEK_SET) == -1) {
-        perror("Erro (escrever_bloco): Falha ao posicionar (lseek) para o bloco de dados");
-        return -1;
-    }
-
     // Escreve o conteúdo do buffer para o disco.
-    ssize_t bytes_escritos = write(fd, buffer, tamanho_bloco);
+    ssize_t bytes_escritos = io_escrever_em(fd, buffer, tamanho_bloco, offset);
     if (bytes_escritos == -1) {
         perror("Erro (escrever_bloco): Falha ao escrever os dados no bloco");
         return -1;
@@ -844,6 +1137,125 @@ void limpar_bit(unsigned char* bitmap, int bit_idx) {
     bitmap[byte_idx] &= ~mascara;
 }
 
+/**
+ * @brief (Função Auxiliar Estática) Posição do bit 1 menos significativo de uma palavra não nula.
+ */
+static uint32_t contar_zeros_a_direita(uint64_t palavra) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint32_t)__builtin_ctzll(palavra);
+#else
+    uint32_t n = 0;
+    while (!(palavra & 1)) {
+        palavra >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Lê 64 bits do bitmap a partir de um byte.
+ *
+ * O ext2 numera os bits do bitmap do menos para o mais significativo de cada byte,
+ * com os bytes em ordem crescente; lendo a palavra como little-endian, o bit i do
+ * trecho vira o bit i da palavra em qualquer arquitetura.
+ */
+static uint64_t ler_palavra_bitmap(const unsigned char* bitmap, uint32_t byte_idx) {
+    uint64_t palavra;
+    memcpy(&palavra, bitmap + byte_idx, sizeof(palavra));
+    return le64toh(palavra);
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Procura o primeiro bit igual a `valor` em [inicio, fim).
+ *
+ * Os bits até o próximo múltiplo de 64 e a cauda final são testados um a um; o meio
+ * é percorrido de 64 em 64 bits (ou de 256 em 256 com AVX2), pulando palavras que não
+ * podem conter o bit procurado e usando "count trailing zeros" na primeira que pode.
+ *
+ * @return O índice do bit encontrado, ou -1 se não houver nenhum no intervalo.
+ */
+static int32_t procurar_bit(const unsigned char* bitmap, uint32_t inicio, uint32_t fim, int valor) {
+    // Procurando um 0, invertemos as palavras: o problema vira achar o primeiro bit 1.
+    const uint64_t inverter = valor ? 0 : UINT64_MAX;
+    uint32_t bit = inicio;
+
+    while (bit < fim && (bit % 64) != 0) {
+        if (bit_esta_setado(bitmap, bit) == valor) return (int32_t)bit;
+        bit++;
+    }
+
+#ifdef __AVX2__
+    // Vetores de 32 bytes inteiramente "cheios" (0xFF ao procurar 0, 0x00 ao procurar 1) são pulados.
+    const __m256i byte_ignorado = valor ? _mm256_setzero_si256() : _mm256_set1_epi8((char)0xFF);
+    while (bit + 256 <= fim) {
+        __m256i vetor = _mm256_loadu_si256((const __m256i*)(bitmap + bit / 8));
+        if ((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(vetor, byte_ignorado)) != 0xFFFFFFFFu) break;
+        bit += 256;
+    }
+#endif
+
+    while (bit + 64 <= fim) {
+        uint64_t palavra = ler_palavra_bitmap(bitmap, bit / 8) ^ inverter;
+        if (palavra != 0) return (int32_t)(bit + contar_zeros_a_direita(palavra));
+        bit += 64;
+    }
+
+    while (bit < fim) {
+        if (bit_esta_setado(bitmap, bit) == valor) return (int32_t)bit;
+        bit++;
+    }
+    return -1;
+}
+
+/**
+ * @brief Procura o primeiro bit livre (0) de um bitmap a partir de uma posição.
+ *
+ * @param bitmap Ponteiro para o buffer do bitmap.
+ * @param inicio Primeiro bit a ser considerado.
+ * @param total_bits Quantidade de bits válidos no bitmap.
+ * @return O índice do bit livre, ou -1 se todos em [inicio, total_bits) estiverem ocupados.
+ */
+int32_t bitmap_procurar_zero(const unsigned char* bitmap, uint32_t inicio, uint32_t total_bits) {
+    return procurar_bit(bitmap, inicio, total_bits, 0);
+}
+
+/**
+ * @brief Procura a primeira sequência de `quantidade` bits livres consecutivos.
+ *
+ * Usada para alocar trechos contíguos: acha um zero, mede até o próximo bit setado
+ * e, se a sequência for curta demais, recomeça logo depois desse bit.
+ *
+ * @param bitmap Ponteiro para o buffer do bitmap.
+ * @param inicio Primeiro bit a ser considerado.
+ * @param total_bits Quantidade de bits válidos no bitmap.
+ * @param quantidade Tamanho mínimo da sequência (em bits).
+ * @return O índice do primeiro bit da sequência, ou -1 se não houver nenhuma.
+ */
+int32_t bitmap_procurar_sequencia_zeros(const unsigned char* bitmap, uint32_t inicio, uint32_t total_bits, uint32_t quantidade) {
+    if (quantidade == 0 || quantidade > total_bits) return -1;
+
+    uint32_t bit = inicio;
+    while (bit < total_bits) {
+        int32_t zero = procurar_bit(bitmap, bit, total_bits, 0);
+        if (zero < 0 || (uint32_t)zero + quantidade > total_bits) return -1;
+
+        int32_t ocupado = procurar_bit(bitmap, (uint32_t)zero, (uint32_t)zero + quantidade, 1);
+        if (ocupado < 0) return zero;   // 'quantidade' zeros seguidos
+        bit = (uint32_t)ocupado + 1;
+    }
+    return -1;
+}
+
+/**
+ * @brief Compara dois números de 32 bits sem sinal (qsort/bsearch de números de blocos e de inodes).
+ */
+int comparar_uint32(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
 
 
 /**
@@ -897,7 +1309,7 @@ void imprimir_entradas_de_bloco_dir(const char* buffer, uint32_t tamanho_bloco)
     char nome_arquivo[EXT2_NAME_LEN + 1];
 
     while (offset < tamanho_bloco) {
-        ext2_dir_entry* entry = (ext2_dir_entry*)(buffer + offset);
+        const ext2_dir_entry* entry = (const ext2_dir_entry*)(buffer + offset);
 
         if (entry->rec_len == 0) {
             fprintf(stderr, "Aviso: Comprimento de registro inválido (0). Fim do bloco ou corrupção.\n");
@@ -943,7 +1355,7 @@ int listar_entradas_diretorio(int fd, const superbloco* sb, const inode* dir_ino
     }
 
     uint32_t tamanho_bloco = calcular_tamanho_do_bloco(sb);
-    char* buffer = malloc(tamanho_bloco);
+    char* buffer = buffer_bloco_obter();
     if (!buffer) {
         perror("ls: Falha ao alocar memória");
         return -1;
@@ -955,7 +1367,7 @@ int listar_entradas_diretorio(int fd, const superbloco* sb, const inode* dir_ino
     }
     printf("---------------------------------------------------------------------\n");
     
-    free(buffer);
+    buffer_bloco_devolver(buffer);
     return 0;
 }
 
@@ -967,18 +1379,21 @@ int listar_entradas_diretorio(int fd, const superbloco* sb, const inode* dir_ino
  * @param num_bloco O número do bloco a ser lido e verificado.
  * @param nome_procurado O nome da entrada a ser encontrada.
  * @param p_inode_encontrado Ponteiro para uma variável onde o inode encontrado será armazenado.
+ * @param buffer_reserva Buffer de um bloco, usado apenas quando a imagem não está mapeada.
  * @return 1 se encontrado, 0 se não encontrado, -1 em caso de erro de leitura.
  */
-static int buscar_nome_em_bloco(int fd, const superbloco* sb, uint32_t num_bloco, const char* nome_procurado, uint32_t* p_inode_encontrado, char* buffer_dados) {
+static int buscar_nome_em_bloco(int fd, const superbloco* sb, uint32_t num_bloco, const char* nome_procurado, uint32_t* p_inode_encontrado, char* buffer_reserva) {
     if (num_bloco == 0) return 0; // Bloco não alocado, não é um erro.
-    if (ler_bloco(fd, sb, num_bloco, buffer_dados) != 0) return -1; // Erro de leitura
+    // No modo --mmap as entradas são percorridas direto no mapeamento, sem cópia.
+    const char* buffer_dados = ler_bloco_ref(fd, sb, num_bloco, buffer_reserva);
+    if (!buffer_dados) return -1; // Erro de leitura
 
     uint32_t tamanho_bloco = calcular_tamanho_do_bloco(sb);
     uint32_t offset = 0;
     size_t tam_nome_procurado = strlen(nome_procurado);
 
     while (offset < tamanho_bloco) {
-        ext2_dir_entry* entry = (ext2_dir_entry*)(buffer_dados + offset);
+        const ext2_dir_entry* entry = (const ext2_dir_entry*)(buffer_dados + offset);
         if (entry->rec_len == 0) break;
 
         if (entry->inode != 0 && entry->name_len == tam_nome_procurado) {
@@ -995,76 +1410,80 @@ static int buscar_nome_em_bloco(int fd, const superbloco* sb, uint32_t num_bloco
 
 
 /**
- * @brief Procura por uma entrada de nome específico dentro de um diretório, varrendo
- * todos os seus blocos (diretos e indiretos), e retorna seu número de inode.
- *
- * @return O número do inode da entrada encontrada, ou 0 se não for encontrada ou em caso de erro.
+ * @brief (Função Auxiliar Estática) Corpo de `procurar_entrada_no_diretorio`, com o diretório já travado.
  */
-uint32_t procurar_entrada_no_diretorio(int fd, const superbloco* sb, const group_desc* gdt, uint32_t dir_inode_num, const char* nome_procurado) {
+static uint32_t procurar_entrada_sem_trava(int fd, const superbloco* sb, const group_desc* gdt, uint32_t dir_inode_num, const char* nome_procurado) {
+    // Consulta primeiro o cache de nomes, que também lembra buscas sem sucesso.
+    uint32_t inode_em_cache;
+    if (cache_dentries_buscar(dir_inode_num, nome_procurado, &inode_em_cache)) {
+        return inode_em_cache;
+    }
+
     inode dir_ino;
     if (ler_inode(fd, sb, gdt, dir_inode_num, &dir_ino) != 0 || !EXT2_IS_DIR(dir_ino.mode)) {
         return 0;
     }
 
-    uint32_t tamanho_bloco = calcular_tamanho_do_bloco(sb);
-    uint32_t ponteiros_por_bloco = tamanho_bloco / sizeof(uint32_t);
-    char* buffer_dados = malloc(tamanho_bloco);
-    uint32_t* buffer_ponteiros = malloc(tamanho_bloco); // Usado para L1, L2, e L3
+    // Diretórios indexados (dir_index) são consultados pelo hash do nome; a varredura
+    // linear abaixo só é usada se o índice não existir ou não puder ser lido.
+    uint32_t inode_indexado = 0;
+    int status_indice = htree_procurar(fd, sb, &dir_ino, nome_procurado, &inode_indexado);
+    if (status_indice >= 0) {
+        cache_dentries_guardar(dir_inode_num, nome_procurado, inode_indexado);
+        return inode_indexado;
+    }
+
+    char* buffer_dados = buffer_bloco_obter();
+    iterador_blocos it;
 
-    if (!buffer_dados || !buffer_ponteiros) {
+    if (!buffer_dados) {
         perror("procurar_entrada: falha ao alocar buffers");
-        free(buffer_dados); free(buffer_ponteiros);
+        return 0;
+    }
+    if (iterador_blocos_iniciar(&it, fd, sb, &dir_ino, ITER_ANTECIPAR) != 0) {
+        buffer_bloco_devolver(buffer_dados);
         return 0;
     }
 
     uint32_t inode_encontrado = 0;
     int status_busca = 0;
+    uint32_t bloco_logico, bloco_fisico;
 
-    // Busca nos Blocos Diretos
-    for (int i = 0; i < 12; ++i) {
-        status_busca = buscar_nome_em_bloco(fd, sb, dir_ino.block[i], nome_procurado, &inode_encontrado, buffer_dados);
-        if (status_busca != 0) goto cleanup; // Se encontrou (1) ou deu erro (-1), para a busca.
-    }
-
-    // Busca no Bloco de Indireção Simples
-    if (dir_ino.block[12] != 0) {
-        if (ler_bloco(fd, sb, dir_ino.block[12], buffer_ponteiros) == 0) {
-            for (uint32_t i = 0; i < ponteiros_por_bloco; ++i) {
-                status_busca = buscar_nome_em_bloco(fd, sb, buffer_ponteiros[i], nome_procurado, &inode_encontrado, buffer_dados);
-                if (status_busca != 0) goto cleanup;
-            }
-        }
+    // Percorre todos os blocos do diretório (diretos e indiretos, até a indireção tripla).
+    while (status_busca == 0 && iterador_blocos_proximo(&it, &bloco_logico, &bloco_fisico)) {
+        // Se encontrou (1) ou deu erro (-1), para a busca.
+        status_busca = buscar_nome_em_bloco(fd, sb, bloco_fisico, nome_procurado, &inode_encontrado, buffer_dados);
     }
+    if (status_busca == 0 && it.erro) status_busca = -1; // Algum bloco de ponteiros ficou sem ser lido
 
-    // Busca no Bloco de Indireção Dupla
-    if (dir_ino.block[13] != 0) {
-        if (ler_bloco(fd, sb, dir_ino.block[13], buffer_ponteiros) == 0) { // Lê L1
-            for (uint32_t i = 0; i < ponteiros_por_bloco; ++i) {
-                if (buffer_ponteiros[i] == 0) continue;
-                uint32_t* bloco_L2 = malloc(tamanho_bloco);
-                if (bloco_L2 && ler_bloco(fd, sb, buffer_ponteiros[i], bloco_L2) == 0) { // Lê L2
-                    for (uint32_t j = 0; j < ponteiros_por_bloco; ++j) {
-                        status_busca = buscar_nome_em_bloco(fd, sb, bloco_L2[j], nome_procurado, &inode_encontrado, buffer_dados);
-                        if (status_busca != 0) { free(bloco_L2); goto cleanup; }
-                    }
-                }
-                free(bloco_L2);
-            }
-        }
+    iterador_blocos_finalizar(&it);
+    buffer_bloco_devolver(buffer_dados);
+    // Só memoriza buscas concluídas; um erro de leitura (-1) não prova que o nome não existe.
+    if (status_busca != -1) {
+        cache_dentries_guardar(dir_inode_num, nome_procurado, inode_encontrado);
     }
-    
-    // NOTA: A busca em indireção tripla seguiria o mesmo padrão, mas é omitida
-    // pois a complexidade de código é enorme para um caso de uso extremamente raro.
-
-cleanup:
-    free(buffer_dados);
-    free(buffer_ponteiros);
     return inode_encontrado; // Retorna o inode se foi encontrado (status=1), ou 0 se não (status=0 ou -1)
 }
 
-
 /**
- * @brief Resolve uma string de caminho para seu número de inode correspondente.
+ * @brief Procura por uma entrada de nome específico dentro de um diretório, varrendo
+ * todos os seus blocos (diretos e indiretos), e retorna seu número de inode.
+ *
+ * Várias buscas no mesmo diretório podem ocorrer ao mesmo tempo (trava de leitura);
+ * inclusões e remoções de entradas esperam por elas.
+ *
+ * @return O número do inode da entrada encontrada, ou 0 se não for encontrada ou em caso de erro.
+ */
+uint32_t procurar_entrada_no_diretorio(int fd, const superbloco* sb, const group_desc* gdt, uint32_t dir_inode_num, const char* nome_procurado) {
+    trava_diretorio_ler(dir_inode_num);
+    uint32_t inode_encontrado = procurar_entrada_sem_trava(fd, sb, gdt, dir_inode_num, nome_procurado);
+    trava_diretorio_liberar(dir_inode_num);
+    return inode_encontrado;
+}
+
+
+/**
+ * @brief Resolve uma string de caminho para seu número de inode correspondente.
  *
  * Navega pela árvore de diretórios a partir de um ponto inicial (raiz ou diretório atual)
  * para encontrar o inode do alvo final.
@@ -1205,52 +1624,245 @@ void imprimir_formato_attr(const inode* ino) {
 
 
 /**
- * @brief (Função Auxiliar Estática) Copia um único bloco de dados para o buffer de conteúdo principal.
+ * @brief Copia os contadores de leitura de arquivos por sequências contíguas.
+ */
+void obter_estatisticas_leitura_arquivos(estatisticas_leitura_arquivos* est) {
+    if (est) *est = estatisticas_leitura;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Entrega `quantidade` bytes zerados ao consumidor
+ * (buracos do arquivo), em trechos do tamanho do buffer de zeros.
+ */
+static int entregar_zeros(consumidor_conteudo consumidor, void* contexto, const char* zeros,
+                          size_t tamanho_zeros, uint64_t quantidade) {
+    while (quantidade > 0) {
+        size_t trecho = (quantidade < tamanho_zeros) ? (size_t)quantidade : tamanho_zeros;
+        if (consumidor(zeros, trecho, contexto) != 0) return -1;
+        quantidade -= trecho;
+    }
+    return 0;
+}
+
+/*
+ * Estado de ler_arquivo_em_fluxo: trechos (sequências já limitadas ao tamanho do
+ * buffer) acumulados numa janela de blocos lógicos, lidos juntos como um lote.
+ */
+typedef struct {
+    uint32_t logico;
+    uint32_t fisico;
+    uint32_t quantidade;
+} trecho_de_leitura;
+
+typedef struct {
+    int fd;
+    const superbloco* sb;
+    uint32_t tamanho_arquivo;
+    uint32_t tamanho_bloco;
+    uint32_t blocos_por_leitura;        // Tamanho da janela (e do buffer) em blocos
+    consumidor_conteudo consumidor;
+    void* contexto;
+    char* buffer;
+    char* zeros;
+    size_t tamanho_buffers;
+    trecho_de_leitura* trechos;         // Até blocos_por_leitura trechos por janela
+    io_pedido* pedidos;
+    uint32_t num_trechos;
+    uint64_t entregues;                 // Bytes já entregues ao consumidor
+} leitura_em_fluxo;
+
+/**
+ * @brief (Função Auxiliar Estática) Lê os trechos acumulados e entrega a janela
+ * (precedida dos zeros de um buraco anterior, se houver) ao consumidor.
  *
- * Esta função é chamada repetidamente para ler um bloco de dados e anexá-lo ao
- * buffer que está sendo montado, atualizando os ponteiros e contadores necessários.
+ * Um trecho sozinho é lido como antes: um bloco isolado pelo cache de blocos e uma
+ * sequência por uma única leitura (ou direto do mapeamento no modo --mmap). Vários
+ * trechos viram um lote de leituras (io_lote_executar) para as posições certas do
+ * buffer; as lacunas entre eles (buracos) são zeradas.
+ */
+static int descarregar_janela(leitura_em_fluxo* l) {
+    if (l->num_trechos == 0) return 0;
+
+    const trecho_de_leitura* primeiro = &l->trechos[0];
+    const trecho_de_leitura* ultimo = &l->trechos[l->num_trechos - 1];
+    uint32_t blocos_janela = ultimo->logico + ultimo->quantidade - primeiro->logico;
+    uint64_t posicao = (uint64_t)primeiro->logico * l->tamanho_bloco;
+    size_t bytes_janela = (size_t)blocos_janela * l->tamanho_bloco;
+    uint64_t bytes_uteis = l->tamanho_arquivo - posicao;
+    if (bytes_uteis > bytes_janela) bytes_uteis = bytes_janela;
+
+    if (entregar_zeros(l->consumidor, l->contexto, l->zeros, l->tamanho_buffers, posicao - l->entregues) != 0) return -1;
+
+    const void* dados;
+    off_t offset = (off_t)primeiro->fisico * l->tamanho_bloco;
+    if (l->num_trechos == 1 && primeiro->quantidade == 1) {
+        dados = ler_bloco_ref(l->fd, l->sb, primeiro->fisico, l->buffer);
+    } else if (l->num_trechos == 1 && io_imagem_mapeada(l->fd)) {
+        dados = io_ponteiro_em(l->fd, offset, bytes_janela);
+    } else {
+        // As leituras vão direto à imagem: os blocos dos trechos ainda sujos no cache
+        // precisam ir antes (os demais blocos sujos continuam adiados).
+        for (uint32_t i = 0; i < l->num_trechos; ++i) {
+            if (cache_blocos_sincronizar_intervalo(l->fd, l->sb, l->trechos[i].fisico, l->trechos[i].quantidade) < 0) return -1;
+        }
+
+        if (l->num_trechos == 1) {
+            dados = (io_ler_em(l->fd, l->buffer, bytes_janela, offset) == (ssize_t)bytes_janela) ? l->buffer : NULL;
+        } else {
+            uint32_t fim_anterior = primeiro->logico;
+            for (uint32_t i = 0; i < l->num_trechos; ++i) {
+                const trecho_de_leitura* t = &l->trechos[i];
+                size_t deslocamento = (size_t)(t->logico - primeiro->logico) * l->tamanho_bloco;
+                if (t->logico > fim_anterior) {
+                    memset(l->buffer + (size_t)(fim_anterior - primeiro->logico) * l->tamanho_bloco, 0,
+                           (size_t)(t->logico - fim_anterior) * l->tamanho_bloco);
+                }
+                l->pedidos[i].escrita = 0;
+                l->pedidos[i].buffer = l->buffer + deslocamento;
+                l->pedidos[i].tamanho = (size_t)t->quantidade * l->tamanho_bloco;
+                l->pedidos[i].offset = (off_t)t->fisico * l->tamanho_bloco;
+                l->pedidos[i].marcador = i;
+                fim_anterior = t->logico + t->quantidade;
+            }
+            dados = (io_lote_executar(l->fd, l->pedidos, l->num_trechos, NULL, NULL) == 0) ? l->buffer : NULL;
+        }
+    }
+    contador_somar(&estatisticas_leitura.leituras, l->num_trechos);
+
+    int status = 0;
+    if (!dados) {
+        fprintf(stderr, "Erro ao ler os blocos lógicos %u a %u.\n", primeiro->logico, primeiro->logico + blocos_janela - 1);
+        status = -1;
+    } else if (l->consumidor(dados, (size_t)bytes_uteis, l->contexto) != 0) {
+        status = -1;
+    }
+    l->entregues = posicao + bytes_uteis;
+    l->num_trechos = 0;
+    return status;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Acrescenta um trecho à janela, descarregando-a
+ * antes se o trecho não couber nela.
+ */
+static int acumular_trecho(leitura_em_fluxo* l, uint32_t logico, uint32_t fisico, uint32_t quantidade) {
+    if (l->num_trechos > 0 &&
+        (uint64_t)logico + quantidade - l->trechos[0].logico > l->blocos_por_leitura) {
+        if (descarregar_janela(l) != 0) return -1;
+    }
+    trecho_de_leitura* t = &l->trechos[l->num_trechos++];
+    t->logico = logico;
+    t->fisico = fisico;
+    t->quantidade = quantidade;
+    return 0;
+}
+
+/**
+ * @brief Lê um arquivo sequência a sequência, entregando cada trecho a um consumidor.
+ *
+ * Blocos contíguos no disco (iterador_blocos_proxima_sequencia) são lidos com uma
+ * única chamada de até LEITURA_BYTES_POR_SEQUENCIA bytes, em vez de uma por bloco.
+ * Sequências curtas (arquivos fragmentados) que caem na mesma janela de
+ * LEITURA_BYTES_POR_SEQUENCIA bytes são lidas juntas, como um lote de E/S
+ * (io_uring, quando disponível). A memória usada é limitada por esse teto, qualquer
+ * que seja o tamanho do arquivo. No modo --mmap as sequências longas apontam direto
+ * para o mapeamento. Buracos são entregues como zeros, sem acesso ao disco.
  *
  * @param fd O descritor de arquivo.
  * @param sb O superbloco.
- * @param num_bloco O número do bloco de dados a ser lido.
- * @param file_ino O inode do arquivo (usado para checar o tamanho total).
- * @param ptr_buffer_atual_ptr Ponteiro para o ponteiro do buffer de conteúdo (para que possamos movê-lo).
- * @param bytes_lidos_ptr Ponteiro para o contador de bytes lidos (para que possamos incrementá-lo).
- * @param bloco_dado_temp Um buffer temporário pré-alocado para a leitura do bloco.
- * @return 0 em sucesso, -1 em erro.
+ * @param file_ino O inode JÁ LIDO do arquivo.
+ * @param consumidor Função chamada para cada trecho, em ordem.
+ * @param contexto Ponteiro repassado ao consumidor.
+ * @return 0 em sucesso, -1 em erro de leitura ou se o consumidor interromper.
  */
-static int copiar_bloco_de_dados(int fd, const superbloco* sb, uint32_t num_bloco,
-                                 const inode* file_ino, char** ptr_buffer_atual_ptr,
-                                 uint32_t* bytes_lidos_ptr, char* bloco_dado_temp) {
-    if (num_bloco == 0 || *bytes_lidos_ptr >= file_ino->size) {
-        return 0; // Pula blocos não alocados ou se já lemos o arquivo inteiro
-    }
-    
-    if (ler_bloco(fd, sb, num_bloco, bloco_dado_temp) != 0) {
-        fprintf(stderr, "Erro ao ler o bloco de dados %u.\n", num_bloco);
-        return -1; // Retorna erro
-    }
+int ler_arquivo_em_fluxo(int fd, const superbloco* sb, const inode* file_ino, consumidor_conteudo consumidor, void* contexto) {
+    if (!file_ino || !consumidor) return -1;
+    if (file_ino->size == 0) return 0;
+
+    leitura_em_fluxo l;
+    memset(&l, 0, sizeof(l));
+    l.fd = fd;
+    l.sb = sb;
+    l.tamanho_arquivo = file_ino->size;
+    l.tamanho_bloco = calcular_tamanho_do_bloco(sb);
+    l.consumidor = consumidor;
+    l.contexto = contexto;
+
+    uint64_t blocos_do_arquivo = ((uint64_t)file_ino->size + l.tamanho_bloco - 1) / l.tamanho_bloco;
+    l.blocos_por_leitura = LEITURA_BYTES_POR_SEQUENCIA / l.tamanho_bloco;
+    if (l.blocos_por_leitura == 0) l.blocos_por_leitura = 1;
+    if (l.blocos_por_leitura > blocos_do_arquivo) l.blocos_por_leitura = (uint32_t)blocos_do_arquivo;
+
+    // Buracos saem em trechos tão grandes quanto as leituras, de um buffer zerado só uma vez.
+    l.tamanho_buffers = (size_t)l.blocos_por_leitura * l.tamanho_bloco;
+    l.buffer = malloc(l.tamanho_buffers);
+    l.zeros = calloc(l.tamanho_buffers, 1);
+    l.trechos = malloc((size_t)l.blocos_por_leitura * sizeof(trecho_de_leitura));
+    l.pedidos = malloc((size_t)l.blocos_por_leitura * sizeof(io_pedido));
+    iterador_blocos it;
 
-    uint32_t tamanho_bloco = calcular_tamanho_do_bloco(sb);
-    uint32_t bytes_para_copiar = tamanho_bloco;
+    int status = 0;
+    if (!l.buffer || !l.zeros || !l.trechos || !l.pedidos) {
+        perror("Erro (ler_arquivo_em_fluxo): Falha ao alocar buffers");
+        status = -1;
+    } else if (iterador_blocos_iniciar(&it, fd, sb, file_ino, ITER_ANTECIPAR) != 0) {
+        status = -1;
+    } else {
+        uint32_t bloco_logico, bloco_fisico, quantidade;
+        contador_somar(&estatisticas_leitura.arquivos, 1);
+        while (status == 0 && iterador_blocos_proxima_sequencia(&it, &bloco_logico, &bloco_fisico, &quantidade)) {
+            contador_somar(&estatisticas_leitura.sequencias, 1);
+            contador_somar(&estatisticas_leitura.blocos, quantidade);
+
+            while (status == 0 && quantidade > 0) {
+                uint32_t blocos = (quantidade < l.blocos_por_leitura) ? quantidade : l.blocos_por_leitura;
+                status = acumular_trecho(&l, bloco_logico, bloco_fisico, blocos);
+                bloco_logico += blocos;
+                bloco_fisico += blocos;
+                quantidade -= blocos;
+            }
+        }
+        if (status == 0) status = descarregar_janela(&l);
 
-    if (*bytes_lidos_ptr + tamanho_bloco > file_ino->size) {
-        bytes_para_copiar = file_ino->size - *bytes_lidos_ptr;
+        // Um buraco no fim do arquivo também faz parte do conteúdo.
+        if (status == 0) {
+            status = entregar_zeros(consumidor, contexto, l.zeros, l.tamanho_buffers, file_ino->size - l.entregues);
+        }
+        iterador_blocos_finalizar(&it);
     }
 
-    memcpy(*ptr_buffer_atual_ptr, bloco_dado_temp, bytes_para_copiar);
-    
-    // Atualiza os contadores usando os ponteiros
-    *bytes_lidos_ptr += bytes_para_copiar;
-    *ptr_buffer_atual_ptr += bytes_para_copiar;
-    
-    return 0; // Sucesso
+    free(l.buffer);
+    free(l.zeros);
+    free(l.trechos);
+    free(l.pedidos);
+    return status;
+}
+
+/*
+ * Destino de ler_conteudo_arquivo: um buffer do tamanho do arquivo preenchido em ordem.
+ */
+typedef struct {
+    char* destino;
+    size_t preenchidos;
+} conteudo_em_memoria;
+
+/**
+ * @brief (Função Auxiliar Estática) Consumidor que copia cada trecho para o buffer.
+ */
+static int copiar_para_memoria(const void* dados, size_t tamanho, void* contexto) {
+    conteudo_em_memoria* conteudo = contexto;
+    memcpy(conteudo->destino + conteudo->preenchidos, dados, tamanho);
+    conteudo->preenchidos += tamanho;
+    return 0;
 }
 
 /**
  * @brief Lê o conteúdo completo de um arquivo, lidando com blocos diretos e indiretos,
  * para um buffer de memória.
  *
+ * Prefira `ler_arquivo_em_fluxo` quando o conteúdo puder ser consumido aos poucos:
+ * esta função precisa de memória proporcional ao tamanho do arquivo.
+ *
  * @param fd O descritor de arquivo.
  * @param sb O superbloco.
  * @param file_ino Um ponteiro para o inode JÁ LIDO do arquivo a ser lido.
@@ -1260,115 +1872,296 @@ static int copiar_bloco_de_dados(int fd, const superbloco* sb, uint32_t num_bloc
  */
 char* ler_conteudo_arquivo(int fd, const superbloco* sb, const inode* file_ino) {
     if (!file_ino) return NULL;
-    if (file_ino->size == 0) {
-        char* buffer_vazio = malloc(1);
-        if (buffer_vazio) buffer_vazio[0] = '\0';
-        return buffer_vazio;
-    }
 
-    char* buffer_conteudo = malloc(file_ino->size + 1);
-    uint32_t tamanho_bloco = calcular_tamanho_do_bloco(sb);
-    char* bloco_dado_temp = malloc(tamanho_bloco);
-    uint32_t* bloco_ponteiros_temp = malloc(tamanho_bloco);
-
-    if (!buffer_conteudo || !bloco_dado_temp || !bloco_ponteiros_temp) {
+    conteudo_em_memoria conteudo = { malloc((size_t)file_ino->size + 1), 0 };
+    if (!conteudo.destino) {
         perror("Erro (ler_conteudo): Falha ao alocar buffers");
-        free(buffer_conteudo); free(bloco_dado_temp); free(bloco_ponteiros_temp);
+        return NULL;
+    }
+    if (ler_arquivo_em_fluxo(fd, sb, file_ino, copiar_para_memoria, &conteudo) != 0) {
+        free(conteudo.destino);
         return NULL;
     }
 
-    uint32_t bytes_lidos = 0;
-    char* ptr_buffer_atual = buffer_conteudo;
-    uint32_t ponteiros_por_bloco = tamanho_bloco / sizeof(uint32_t);
+    // Adiciona o terminador nulo ao final do conteúdo.
+    conteudo.destino[conteudo.preenchidos] = '\0';
+    return conteudo.destino;
+}
+
+
+
+/**
+ * @brief Lê um intervalo de bytes de um arquivo, sem tocar no resto dele.
+ *
+ * O intervalo é convertido em blocos lógicos e o iterador desce só pelos blocos de
+ * ponteiros que levam a eles, de modo que ler o cabeçalho ou o fim de um arquivo
+ * enorme custa algumas leituras, não o arquivo inteiro. Cada sequência contígua
+ * vira uma única leitura (blocos isolados passam pelo cache de blocos) e buracos
+ * saem como zeros.
+ *
+ * @param fd O descritor de arquivo.
+ * @param sb O superbloco.
+ * @param file_ino O inode JÁ LIDO do arquivo.
+ * @param offset Posição do primeiro byte dentro do arquivo.
+ * @param tamanho Quantidade de bytes desejada.
+ * @param buffer Destino, com pelo menos `tamanho` bytes.
+ * @return O número de bytes lidos (menor que `tamanho` só no fim do arquivo), ou -1 em erro.
+ */
+ssize_t ler_intervalo_arquivo(int fd, const superbloco* sb, const inode* file_ino, uint64_t offset, size_t tamanho, void* buffer) {
+    if (!file_ino || !buffer) return -1;
+    if (offset >= file_ino->size || tamanho == 0) return 0;
+    if (tamanho > file_ino->size - offset) tamanho = (size_t)(file_ino->size - offset);
 
-    // Blocos Diretos
-    for (int i = 0; i < 12; ++i) {
-        if (copiar_bloco_de_dados(fd, sb, file_ino->block[i], file_ino, &ptr_buffer_atual, &bytes_lidos, bloco_dado_temp) != 0) goto erro;
+    uint32_t tamanho_bloco = calcular_tamanho_do_bloco(sb);
+    uint64_t fim = offset + tamanho;
+    char* destino = buffer;
+    memset(destino, 0, tamanho);    // Buracos
+
+    char* bloco_temp = buffer_bloco_obter();
+    iterador_blocos it;
+    if (!bloco_temp) {
+        perror("Erro (ler_intervalo_arquivo): Falha ao alocar buffer");
+        return -1;
     }
+    if (iterador_blocos_iniciar(&it, fd, sb, file_ino, ITER_ANTECIPAR) != 0) {
+        buffer_bloco_devolver(bloco_temp);
+        return -1;
+    }
+    iterador_blocos_restringir(&it, (uint32_t)(offset / tamanho_bloco), (uint32_t)((fim + tamanho_bloco - 1) / tamanho_bloco));
 
-    // Bloco de Indireção Simples (12)
-    if (bytes_lidos < file_ino->size && file_ino->block[12] != 0) {
-        if (ler_bloco(fd, sb, file_ino->block[12], bloco_ponteiros_temp) == 0) {
-            for (uint32_t i = 0; i < ponteiros_por_bloco; ++i) {
-                if (copiar_bloco_de_dados(fd, sb, bloco_ponteiros_temp[i], file_ino, &ptr_buffer_atual, &bytes_lidos, bloco_dado_temp) != 0) goto erro;
+    int status = 0;
+    uint32_t bloco_logico, bloco_fisico, quantidade;
+    while (status == 0 && iterador_blocos_proxima_sequencia(&it, &bloco_logico, &bloco_fisico, &quantidade)) {
+        // Parte da sequência que cai dentro do intervalo pedido.
+        uint64_t inicio_seq = (uint64_t)bloco_logico * tamanho_bloco;
+        uint64_t fim_seq = inicio_seq + (uint64_t)quantidade * tamanho_bloco;
+        uint64_t de = (inicio_seq > offset) ? inicio_seq : offset;
+        uint64_t ate = (fim_seq < fim) ? fim_seq : fim;
+        off_t posicao_disco = (off_t)bloco_fisico * tamanho_bloco + (off_t)(de - inicio_seq);
+
+        if (quantidade == 1) {
+            const char* dados = ler_bloco_ref(fd, sb, bloco_fisico, bloco_temp);
+            if (!dados) status = -1;
+            else memcpy(destino + (de - offset), dados + (de - inicio_seq), (size_t)(ate - de));
+        } else {
+            // A leitura grande vai direto à imagem: os blocos lidos ainda sujos no cache precisam ir antes.
+            uint32_t primeiro = bloco_fisico + (uint32_t)((de - inicio_seq) / tamanho_bloco);
+            uint32_t ultimo = bloco_fisico + (uint32_t)((ate - inicio_seq - 1) / tamanho_bloco);
+            if (cache_blocos_sincronizar_intervalo(fd, sb, primeiro, ultimo - primeiro + 1) < 0) {
+                status = -1;
+                break;
             }
+            if (io_ler_em(fd, destino + (de - offset), (size_t)(ate - de), posicao_disco) != (ssize_t)(ate - de)) status = -1;
         }
+        if (status != 0) fprintf(stderr, "Erro (ler_intervalo_arquivo): Falha ao ler os blocos a partir de %u.\n", bloco_fisico);
     }
+    if (it.erro) status = -1;
 
-    // Bloco de Indireção Dupla (13)
-    if (bytes_lidos < file_ino->size && file_ino->block[13] != 0) {
-        if (ler_bloco(fd, sb, file_ino->block[13], bloco_ponteiros_temp) == 0) {
-            for (uint32_t i = 0; i < ponteiros_por_bloco; ++i) {
-                if (bloco_ponteiros_temp[i] == 0) continue;
-                uint32_t* bloco_L2 = malloc(tamanho_bloco);
-                if (bloco_L2 && ler_bloco(fd, sb, bloco_ponteiros_temp[i], bloco_L2) == 0) {
-                    for (uint32_t j = 0; j < ponteiros_por_bloco; ++j) {
-                        if (copiar_bloco_de_dados(fd, sb, bloco_L2[j], file_ino, &ptr_buffer_atual, &bytes_lidos, bloco_dado_temp) != 0) { free(bloco_L2); goto erro; }
-                    }
-                }
-                free(bloco_L2);
-            }
-        }
+    iterador_blocos_finalizar(&it);
+    buffer_bloco_devolver(bloco_temp);
+    return (status == 0) ? (ssize_t)tamanho : -1;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Copia uma sequência de blocos fisicamente contíguos
+ * da imagem para a mesma posição lógica no arquivo de destino.
+ */
+static int exportar_sequencia(int fd, const superbloco* sb, const inode* file_ino, int fd_destino,
+                              uint32_t inicio_logico, uint32_t inicio_fisico, uint32_t num_blocos) {
+    uint32_t tamanho_bloco = calcular_tamanho_do_bloco(sb);
+    off_t posicao = (off_t)inicio_logico * tamanho_bloco;
+    uint64_t bytes = (uint64_t)num_blocos * tamanho_bloco;
+    if (bytes > file_ino->size - (uint64_t)posicao) bytes = file_ino->size - (uint64_t)posicao;
+
+    // A cópia no kernel lê direto da imagem: blocos da sequência ainda sujos no cache precisam ir antes.
+    if (cache_blocos_sincronizar_intervalo(fd, sb, inicio_fisico, num_blocos) < 0) return -1;
+
+    ssize_t copiados = io_copiar_intervalo(fd, (off_t)inicio_fisico * tamanho_bloco, fd_destino, posicao, (size_t)bytes);
+    if (copiados != (ssize_t)bytes) {
+        perror("Erro (exportar_arquivo_para_host): Falha ao copiar os dados");
+        return -1;
     }
+    return 0;
+}
 
-    // Bloco de Indireção Tripla (14)
-    /*
-    * IMPORTANTE: a lógica de busca em indireção tripla neste caso foi implementada caso o arquivo que esteja sendo tratado exista mas seja grande demais
-    *    apenas para não retornar erro de arquivo inexistente quando na verdade ele existe 
-    */
-    if (bytes_lidos < file_ino->size && file_ino->block[14] != 0) {
-        // Lê o bloco de ponteiros de Nível 1 (L1)
-        if (ler_bloco(fd, sb, file_ino->block[14], bloco_ponteiros_temp) == 0) {
-            // Itera sobre os ponteiros L1
-            for (uint32_t i = 0; i < ponteiros_por_bloco; ++i) {
-                if (bytes_lidos >= file_ino->size) break;
-                if (bloco_ponteiros_temp[i] == 0) continue;
-
-                // Aloca memória e lê o bloco de ponteiros de Nível 2 (L2)
-                uint32_t* bloco_ponteiros_L2 = malloc(tamanho_bloco);
-                if (bloco_ponteiros_L2 && ler_bloco(fd, sb, bloco_ponteiros_temp[i], bloco_ponteiros_L2) == 0) {
-                    // Itera sobre os ponteiros L2
-                    for (uint32_t j = 0; j < ponteiros_por_bloco; ++j) {
-                        if (bytes_lidos >= file_ino->size) break;
-                        if (bloco_ponteiros_L2[j] == 0) continue;
-
-                        // Aloca memória e lê o bloco de ponteiros de Nível 3 (L3), que aponta para os dados
-                        uint32_t* bloco_ponteiros_L3 = malloc(tamanho_bloco);
-                        if (bloco_ponteiros_L3 && ler_bloco(fd, sb, bloco_ponteiros_L2[j], bloco_ponteiros_L3) == 0) {
-                            // Itera sobre os ponteiros L3, que são os blocos de dados finais
-                            for (uint32_t k = 0; k < ponteiros_por_bloco; ++k) {
-                                if (bytes_lidos >= file_ino->size) break;
-                                // Chama a função auxiliar para copiar o bloco de dados
-                                if (copiar_bloco_de_dados(fd, sb, bloco_ponteiros_L3[k], file_ino, &ptr_buffer_atual, &bytes_lidos, bloco_dado_temp) != 0) {
-                                    free(bloco_ponteiros_L2);
-                                    free(bloco_ponteiros_L3);
-                                    goto erro; // Pula para a limpeza em caso de falha
-                                }
-                            }
-                        }
-                        free(bloco_ponteiros_L3); // Libera o buffer L3
-                    }
-                }
-                free(bloco_ponteiros_L2); // Libera o buffer L2
-            }
+/**
+ * @brief (Função Auxiliar Estática) Garante que o intervalo [inicio, fim) do destino, um
+ * buraco do arquivo, seja lido como zeros.
+ *
+ * Só a parte que já existia no destino (antes de `tamanho_existente`) precisa de
+ * atenção: ela vira um buraco de verdade no host. Além dela, o ftruncate final já
+ * produz buracos.
+ */
+static int recriar_buraco(int fd_destino, uint64_t inicio, uint64_t fim, uint64_t tamanho_existente) {
+    if (fim > tamanho_existente) fim = tamanho_existente;
+    if (inicio >= fim) return 0;
+    if (io_abrir_buraco(fd_destino, (off_t)inicio, (off_t)(fim - inicio)) != 0) {
+        perror("Erro (exportar_arquivo_para_host): Falha ao recriar um buraco no destino");
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Copia um arquivo da imagem para um descritor do host sem passar pelo espaço do usuário.
+ *
+ * Os blocos do inode são agrupados em sequências fisicamente contíguas
+ * (iterador_blocos_proxima_sequencia) e cada uma vira uma única chamada a
+ * `io_copiar_intervalo` (copy_file_range, com sendfile e pread/pwrite como
+ * alternativas). Buracos nunca são escritos: o iterador os pula inteiros, a região
+ * correspondente de um destino não vazio é liberada com io_abrir_buraco e o
+ * ftruncate final recria os demais. O tempo gasto é proporcional aos dados
+ * alocados, não ao tamanho lógico do arquivo.
+ *
+ * @param fd O descritor da imagem.
+ * @param sb O superbloco.
+ * @param file_ino O inode JÁ LIDO do arquivo.
+ * @param fd_destino O descritor do arquivo de destino, aberto para escrita.
+ * @return 0 em sucesso, -1 em erro.
+ */
+int exportar_arquivo_para_host(int fd, const superbloco* sb, const inode* file_ino, int fd_destino) {
+    // Dados antigos do destino que caírem em buracos do arquivo precisam sumir.
+    struct stat info_destino;
+    uint64_t tamanho_existente = (fstat(fd_destino, &info_destino) == 0 && S_ISREG(info_destino.st_mode))
+                               ? (uint64_t)info_destino.st_size : 0;
+
+    iterador_blocos it;
+    if (iterador_blocos_iniciar(&it, fd, sb, file_ino, 0) != 0) return -1;
+
+    uint32_t tamanho_bloco = calcular_tamanho_do_bloco(sb);
+    int status = 0;
+    uint64_t copiado_ate = 0;
+    uint32_t bloco_logico, bloco_fisico, quantidade;
+    contador_somar(&estatisticas_leitura.arquivos, 1);
+    while (iterador_blocos_proxima_sequencia(&it, &bloco_logico, &bloco_fisico, &quantidade)) {
+        contador_somar(&estatisticas_leitura.sequencias, 1);
+        contador_somar(&estatisticas_leitura.blocos, quantidade);
+        contador_somar(&estatisticas_leitura.leituras, 1);
+
+        uint64_t posicao = (uint64_t)bloco_logico * tamanho_bloco;
+        if (recriar_buraco(fd_destino, copiado_ate, posicao, tamanho_existente) != 0 ||
+            exportar_sequencia(fd, sb, file_ino, fd_destino, bloco_logico, bloco_fisico, quantidade) != 0) {
+            status = -1;
+            break;
         }
+        copiado_ate = posicao + (uint64_t)quantidade * tamanho_bloco;
     }
+    if (it.erro) status = -1;
+    iterador_blocos_finalizar(&it);
 
-    // Adiciona o terminador nulo ao final do conteúdo.
-    *ptr_buffer_atual = '\0';
-    free(bloco_dado_temp);
-    free(bloco_ponteiros_temp);
-    return buffer_conteudo;
+    // Buraco no fim do arquivo.
+    if (status == 0 && copiado_ate < file_ino->size) {
+        status = recriar_buraco(fd_destino, copiado_ate, file_ino->size, tamanho_existente);
+    }
+    if (status == 0 && ftruncate(fd_destino, (off_t)file_ino->size) != 0) {
+        perror("Erro (exportar_arquivo_para_host): Falha ao ajustar o tamanho do destino");
+        status = -1;
+    }
+    return status;
+}
 
-erro:
-// Limpeza em caso de falha em qualquer uma das etapas
-    free(buffer_conteudo);
-    free(bloco_dado_temp);
-    free(bloco_ponteiros_temp);
-    return NULL;
+/**
+ * @brief (Função Auxiliar Estática) Zera o fim do último bloco de uma sequência importada,
+ * que pode conter restos de um arquivo apagado.
+ */
+static int zerar_resto_do_bloco(int fd, off_t posicao, uint32_t tamanho) {
+    void* zeros = buffer_bloco_obter_zerado();
+    if (!zeros) {
+        perror("Erro (importar_arquivo_do_host): Falha ao alocar buffer");
+        return -1;
+    }
+    ssize_t escritos = io_escrever_em(fd, zeros, tamanho, posicao);
+    buffer_bloco_devolver(zeros);
+    return (escritos == (ssize_t)tamanho) ? 0 : -1;
 }
 
+/**
+ * @brief Preenche um inode de arquivo regular (ainda sem blocos) com o conteúdo de um
+ * arquivo do host.
+ *
+ * Só os trechos com dados são copiados (io_procurar_dados): buracos de um arquivo
+ * esparso do host continuam buracos na imagem, sem blocos alocados.
+ * Os blocos são reservados em sequências contíguas de até IMPORTAR_BYTES_POR_SEQUENCIA
+ * (alocar_blocos_contiguos, começando no grupo do inode e continuando onde a
+ * sequência anterior terminou). Cada sequência recebe os dados com uma única
+ * chamada a `io_copiar_intervalo`, direto do arquivo do host para a imagem, e é
+ * registrada no mapa de blocos de uma vez (definir_blocos_logicos).
+ *
+ * Em caso de erro, os blocos já ligados ao inode continuam nele: cabe ao chamador
+ * liberá-los com liberar_blocos_do_inode.
+ *
+ * IMPORTANTE: Modifica 'ino' (size, blocks e mapa de blocos). O chamador DEVE escrevê-lo no disco.
+ *
+ * @param fd O descritor da imagem.
+ * @param sb O superbloco (será modificado).
+ * @param gdt A tabela de descritores de grupo (será modificada).
+ * @param ino O inode de destino, sem blocos.
+ * @param inode_num O número desse inode.
+ * @param fd_origem O descritor do arquivo do host, aberto para leitura.
+ * @param tamanho O tamanho do arquivo do host em bytes.
+ * @return 0 em sucesso, -1 em erro.
+ */
+int importar_arquivo_do_host(int fd, superbloco* sb, group_desc* gdt, inode* ino, uint32_t inode_num,
+                             int fd_origem, uint32_t tamanho) {
+    uint32_t tamanho_bloco = calcular_tamanho_do_bloco(sb);
+    uint32_t total_blocos = (uint32_t)(((uint64_t)tamanho + tamanho_bloco - 1) / tamanho_bloco);
+    uint32_t blocos_por_sequencia = IMPORTAR_BYTES_POR_SEQUENCIA / tamanho_bloco;
+    if (blocos_por_sequencia == 0) blocos_por_sequencia = 1;
+
+    uint32_t bloco_logico = 0, objetivo = 0;
+    uint32_t fim_dos_dados = 0;     // Fim (em blocos) do trecho de dados atual da origem
+    while (bloco_logico < total_blocos) {
+        // Buracos da origem continuam buracos: nenhum bloco é alocado para eles.
+        if (bloco_logico >= fim_dos_dados) {
+            off_t fim;
+            off_t inicio = io_procurar_dados(fd_origem, (off_t)bloco_logico * tamanho_bloco, (off_t)tamanho, &fim);
+            if (inicio >= (off_t)tamanho) break;
+            bloco_logico = (uint32_t)(inicio / tamanho_bloco);
+            fim_dos_dados = (uint32_t)(((uint64_t)fim + tamanho_bloco - 1) / tamanho_bloco);
+        }
+
+        uint32_t faltam = fim_dos_dados - bloco_logico;
+        uint32_t obtidos;
+        uint32_t inicio = alocar_blocos_contiguos(fd, sb, gdt, inode_num, objetivo,
+                                                  (faltam < blocos_por_sequencia) ? faltam : blocos_por_sequencia, &obtidos);
+        if (inicio == 0) return -1;
+
+        // Os blocos são escritos por fora do cache: cópias antigas dele não podem sobreviver.
+        cache_blocos_descartar(inicio, obtidos);
+
+        off_t posicao_origem = (off_t)bloco_logico * tamanho_bloco;
+        off_t posicao_destino = (off_t)inicio * tamanho_bloco;
+        uint64_t bytes = (uint64_t)obtidos * tamanho_bloco;
+        if (bytes > (uint64_t)tamanho - (uint64_t)posicao_origem) bytes = (uint64_t)tamanho - (uint64_t)posicao_origem;
+
+        int status = 0;
+        ssize_t copiados = io_copiar_intervalo(fd_origem, posicao_origem, fd, posicao_destino, (size_t)bytes);
+        if (copiados != (ssize_t)bytes) {
+            if (copiados >= 0) fprintf(stderr, "Erro (importar_arquivo_do_host): O arquivo de origem diminuiu durante a cópia.\n");
+            else perror("Erro (importar_arquivo_do_host): Falha ao copiar os dados");
+            status = -1;
+        } else if (bytes < (uint64_t)obtidos * tamanho_bloco) {
+            status = zerar_resto_do_bloco(fd, posicao_destino + (off_t)bytes, (uint32_t)((uint64_t)obtidos * tamanho_bloco - bytes));
+        }
 
+        // Os blocos entram no inode mesmo em erro, para que o chamador os libere junto com o resto.
+        if (definir_blocos_logicos(fd, sb, gdt, ino, inode_num, bloco_logico, inicio, obtidos) != 0) {
+            // Só os blocos que não chegaram ao mapa ficam de fora de liberar_blocos_do_inode.
+            for (uint32_t i = 0; i < obtidos; ++i) {
+                if (mapear_bloco_logico(fd, sb, ino, bloco_logico + i) != inicio + i) liberar_bloco(fd, sb, gdt, inicio + i);
+            }
+            return -1;
+        }
+        ino->blocks += obtidos * (tamanho_bloco / 512);
+        if (status != 0) return -1;
+
+        bloco_logico += obtidos;
+        objetivo = inicio + obtidos;
+    }
+
+    ino->size = tamanho;
+    return 0;
+}
 
 /**
  * @brief Imprime um resumo formatado e amigável das informações do sistema de arquivos.
@@ -1406,284 +2199,139 @@ void imprimir_formato_info(const superbloco* sb, uint32_t num_grupos) {
 
 
 /**
- * @brief Adiciona uma nova entrada de diretório a um diretório pai.
+ * @brief (Função Auxiliar Estática) Tenta acomodar uma nova entrada na folga da última
+ * entrada de um bloco de diretório.
  *
- * Procura espaço nos blocos existentes (diretos). Se não encontrar, tenta alocar um novo
- * bloco de dados, primeiro nos ponteiros diretos e depois no bloco de indireção simples.
- *
- * IMPORTANTE: Modifica 'inode_pai' em memória. O chamador DEVE escrevê-lo de volta ao disco.
- * @return 0 em sucesso, -1 em erro.
+ * @return 1 se a entrada foi inserida no buffer (que deve então ser gravado), 0 se não coube.
  */
-int adicionar_entrada_diretorio(int fd, superbloco* sb, group_desc* gdt, inode* inode_pai, uint32_t inode_pai_num, uint32_t inode_filho, const char* nome_filho, uint8_t tipo_arquivo) {
-    uint32_t tamanho_bloco = calcular_tamanho_do_bloco(sb);
-    uint32_t ponteiros_por_bloco = tamanho_bloco / sizeof(uint32_t);
-    char* buffer_dados = malloc(tamanho_bloco);
-    uint32_t* buffer_ponteiros_l1 = malloc(tamanho_bloco);
-    uint32_t* buffer_ponteiros_l2 = malloc(tamanho_bloco);
+static int inserir_entrada_no_fim_do_bloco(char* buffer_dados, uint32_t tamanho_bloco, uint32_t inode_filho,
+                                           const char* nome_filho, uint16_t tam_nome_novo, uint8_t tipo_arquivo,
+                                           uint16_t rec_len_necessario) {
+    uint32_t offset = 0;
+    while (offset < tamanho_bloco) {
+        ext2_dir_entry* entry = (ext2_dir_entry*)(buffer_dados + offset);
+        if (entry->rec_len == 0) break;
 
-    if (!buffer_dados || !buffer_ponteiros_l1 || !buffer_ponteiros_l2) {
-        perror("adicionar_entrada: falha ao alocar buffers");
-        goto falha;
+        // se por acaso for a última entrada no bloco
+        if (offset + entry->rec_len >= tamanho_bloco) {
+            uint16_t rec_len_real_atual = (TAMANHO_CABECALHO_ENTRADA_DIR + entry->name_len + 3) & ~3;
+            if ((entry->rec_len - rec_len_real_atual) < rec_len_necessario) return 0;
+
+            uint16_t rec_len_antigo = entry->rec_len;
+            entry->rec_len = rec_len_real_atual;
+
+            offset += entry->rec_len;
+            ext2_dir_entry *nova_entry = (ext2_dir_entry*)(buffer_dados + offset);
+            nova_entry->inode = inode_filho;
+            nova_entry->name_len = tam_nome_novo;
+            nova_entry->file_type = tipo_arquivo;
+            memcpy(nova_entry->name, nome_filho, tam_nome_novo);
+            nova_entry->rec_len = rec_len_antigo - entry->rec_len;
+            return 1;
+        }
+        offset += entry->rec_len;
     }
+    return 0;
+}
 
-    uint16_t tam_nome_novo = strlen(nome_filho);
-    uint16_t rec_len_necessario = (TAMANHO_CABECALHO_ENTRADA_DIR + tam_nome_novo + 3) & ~3;
-
-    // fase 1
-    // tenta encontrar espaço em blocos existentes
-
-    // busca nos 12 blocos diretos
-    for (int i = 0; i < 12; ++i) {
-        uint32_t num_bloco = inode_pai->block[i];
-        if (num_bloco == 0) continue; // pula blocos não alocados
-
-        if (ler_bloco(fd, sb, num_bloco, buffer_dados) == 0) {
-            uint32_t offset = 0;
-            ext2_dir_entry* entry;
-            while (offset < tamanho_bloco) {
-                entry = (ext2_dir_entry*)(buffer_dados + offset);
-                if (entry->rec_len == 0) break;
-
-                // se por acaso for a última entrada no bloco
-                if (offset + entry->rec_len >= tamanho_bloco) {
-                    uint16_t rec_len_real_atual = (TAMANHO_CABECALHO_ENTRADA_DIR + entry->name_len + 3) & ~3;
-                    if ((entry->rec_len - rec_len_real_atual) >= rec_len_necessario) {
-                        uint16_t rec_len_antigo = entry->rec_len;
-                        entry->rec_len = rec_len_real_atual;
-                        
-                        offset += entry->rec_len;
-                        ext2_dir_entry *nova_entry = (ext2_dir_entry*)(buffer_dados + offset);
-                        nova_entry->inode = inode_filho;
-                        nova_entry->name_len = tam_nome_novo;
-                        nova_entry->file_type = tipo_arquivo;
-                        memcpy(nova_entry->name, nome_filho, tam_nome_novo);
-                        nova_entry->rec_len = rec_len_antigo - entry->rec_len;
-                        
-                        escrever_bloco(fd, sb, num_bloco, buffer_dados);
-                        free(buffer_dados); free(buffer_ponteiros_l1); free(buffer_ponteiros_l2);
-                        return 0; // sucesso
-                    }
-                }
-                offset += entry->rec_len;
-            }
+/**
+ * @brief (Função Auxiliar Estática) Corpo de `adicionar_entrada_diretorio`, com o diretório já travado.
+ */
+static int adicionar_entrada_sem_trava(int fd, superbloco* sb, group_desc* gdt, inode* inode_pai, uint32_t inode_pai_num, uint32_t inode_filho, const char* nome_filho, uint8_t tipo_arquivo) {
+    // Em diretórios indexados a entrada vai direto para a folha do seu hash. Se o índice
+    // não puder ser mantido, ele é desligado e o diretório passa a ser linear.
+    if (htree_diretorio_indexado(sb, inode_pai)) {
+        if (htree_adicionar(fd, sb, gdt, inode_pai, inode_pai_num, inode_filho, nome_filho, tipo_arquivo) == 0) {
+            cache_dentries_guardar(inode_pai_num, nome_filho, inode_filho);
+            return 0;
         }
+        inode_pai->flags &= ~EXT2_INDEX_FL;
     }
 
-    // se não achou, busca nos blocos de indireção simples (block[12])
-    if (inode_pai->block[12] != 0) {
-        if (ler_bloco(fd, sb, inode_pai->block[12], buffer_ponteiros_l1) == 0) {
-            for (uint32_t i = 0; i < ponteiros_por_bloco; i++) {
-                uint32_t num_bloco = buffer_ponteiros_l1[i];
-                if (num_bloco == 0) continue;
-                
-                if (ler_bloco(fd, sb, num_bloco, buffer_dados) == 0) {
-                    uint32_t offset = 0;
-                    ext2_dir_entry* entry;
-                    while (offset < tamanho_bloco) {
-                        entry = (ext2_dir_entry*)(buffer_dados + offset);
-                        if (entry->rec_len == 0) break;
-                        
-                        if (offset + entry->rec_len >= tamanho_bloco) {
-                            uint16_t rec_len_real_atual = (TAMANHO_CABECALHO_ENTRADA_DIR + entry->name_len + 3) & ~3;
-                            if ((entry->rec_len - rec_len_real_atual) >= rec_len_necessario) {
-                                uint16_t rec_len_antigo = entry->rec_len;
-                                entry->rec_len = rec_len_real_atual;
-                                
-                                offset += entry->rec_len;
-                                ext2_dir_entry *nova_entry = (ext2_dir_entry*)(buffer_dados + offset);
-                                nova_entry->inode = inode_filho;
-                                nova_entry->name_len = tam_nome_novo;
-                                nova_entry->file_type = tipo_arquivo;
-                                memcpy(nova_entry->name, nome_filho, tam_nome_novo);
-                                nova_entry->rec_len = rec_len_antigo - entry->rec_len;
-                                
-                                escrever_bloco(fd, sb, num_bloco, buffer_dados);
-                                free(buffer_dados); free(buffer_ponteiros_l1); free(buffer_ponteiros_l2);
-                                return 0; // sucesso
-                            }
-                        }
-                        offset += entry->rec_len;
-                    }
-                }
-            }
-        }
+    uint32_t tamanho_bloco = calcular_tamanho_do_bloco(sb);
+    char* buffer_dados = buffer_bloco_obter();
+    if (!buffer_dados) {
+        perror("adicionar_entrada: falha ao alocar buffers");
+        fprintf(stderr, "Erro: Falha ao alocar novo bloco ou diretório está completamente cheio.\n");
+        return -1;
     }
 
-    // se ainda não achou, busca nos blocos de indireção dupla (block[13])
-    if (inode_pai->block[13] != 0) {
-        if (ler_bloco(fd, sb, inode_pai->block[13], buffer_ponteiros_l1) == 0) { // Lê L1
-            for (uint32_t i = 0; i < ponteiros_por_bloco; i++) {
-                if (buffer_ponteiros_l1[i] == 0) continue;
-                if (ler_bloco(fd, sb, buffer_ponteiros_l1[i], buffer_ponteiros_l2) == 0) { // Lê L2
-                    for (uint32_t j = 0; j < ponteiros_por_bloco; j++) {
-                        uint32_t num_bloco = buffer_ponteiros_l2[j];
-                        if (num_bloco == 0) continue;
-                        
-                        if (ler_bloco(fd, sb, num_bloco, buffer_dados) == 0) {
-                            uint32_t offset = 0;
-                            ext2_dir_entry* entry;
-                            while (offset < tamanho_bloco) {
-                                entry = (ext2_dir_entry*)(buffer_dados + offset);
-                                if (entry->rec_len == 0) break;
-                                
-                                if (offset + entry->rec_len >= tamanho_bloco) {
-                                    uint16_t rec_len_real_atual = (TAMANHO_CABECALHO_ENTRADA_DIR + entry->name_len + 3) & ~3;
-                                    if ((entry->rec_len - rec_len_real_atual) >= rec_len_necessario) {
-                                        uint16_t rec_len_antigo = entry->rec_len;
-                                        entry->rec_len = rec_len_real_atual;
-                                        
-                                        offset += entry->rec_len;
-                                        ext2_dir_entry *nova_entry = (ext2_dir_entry*)(buffer_dados + offset);
-                                        nova_entry->inode = inode_filho;
-                                        nova_entry->name_len = tam_nome_novo;
-                                        nova_entry->file_type = tipo_arquivo;
-                                        memcpy(nova_entry->name, nome_filho, tam_nome_novo);
-                                        nova_entry->rec_len = rec_len_antigo - entry->rec_len;
-                                        
-                                        escrever_bloco(fd, sb, num_bloco, buffer_dados);
-                                        free(buffer_dados); free(buffer_ponteiros_l1); free(buffer_ponteiros_l2);
-                                        return 0; // sucesso
-                                    }
-                                }
-                                offset += entry->rec_len;
-                            }
-                        }
-                    }
-                }
+    uint16_t tam_nome_novo = strlen(nome_filho);
+    uint16_t rec_len_necessario = (TAMANHO_CABECALHO_ENTRADA_DIR + tam_nome_novo + 3) & ~3;
+
+    // fase 1
+    // tenta encontrar espaço em blocos existentes (diretos e indiretos)
+    iterador_blocos it;
+    if (iterador_blocos_iniciar(&it, fd, sb, inode_pai, ITER_ANTECIPAR) == 0) {
+        uint32_t bloco_logico, num_bloco;
+        while (iterador_blocos_proximo(&it, &bloco_logico, &num_bloco)) {
+            if (ler_bloco(fd, sb, num_bloco, buffer_dados) != 0) continue;
+            if (inserir_entrada_no_fim_do_bloco(buffer_dados, tamanho_bloco, inode_filho, nome_filho,
+                                                tam_nome_novo, tipo_arquivo, rec_len_necessario)) {
+                iterador_blocos_finalizar(&it);
+                escrever_bloco(fd, sb, num_bloco, buffer_dados);
+                cache_dentries_guardar(inode_pai_num, nome_filho, inode_filho);
+                buffer_bloco_devolver(buffer_dados);
+                return 0; // sucesso
             }
         }
+        iterador_blocos_finalizar(&it);
     }
 
     // fase 2
-    // se não achou espaço tenta alocar novo bloco
-
+    // se não achou espaço, aloca um novo bloco e o anexa ao fim do diretório
+    uint32_t bloco_logico_novo = inode_pai->size / tamanho_bloco;
     uint32_t novo_bloco_dados = alocar_bloco(fd, sb, gdt, inode_pai_num);
     if (novo_bloco_dados == 0) goto falha;
 
-    // prepara o conteúdo do novo bloco de dados
-    memset(buffer_dados, 0, tamanho_bloco);
-    ext2_dir_entry* nova_entry = (ext2_dir_entry*)buffer_dados;
-    nova_entry->inode = inode_filho;
-    nova_entry->name_len = tam_nome_novo;
-    nova_entry->rec_len = tamanho_bloco;
-    nova_entry->file_type = tipo_arquivo;
-    memcpy(nova_entry->name, nome_filho, tam_nome_novo);
-    escrever_bloco(fd, sb, novo_bloco_dados, buffer_dados);
-
-    // tenta linkar o novo bloco em um ponteiro direto livre
-    for (int i = 0; i < 12; i++) {
-        if (inode_pai->block[i] == 0) {
-            inode_pai->block[i] = novo_bloco_dados;
-            goto sucesso;
-        }
-    }
-
-    // tenta linkar no bloco de indireção simples
-    if (inode_pai->block[12] == 0) {
-        uint32_t bloco_indireto = alocar_bloco(fd, sb, gdt, inode_pai_num);
-        if (bloco_indireto == 0) { liberar_bloco(fd, sb, gdt, novo_bloco_dados); goto falha; }
-        inode_pai->block[12] = bloco_indireto;
-        inode_pai->blocks += (tamanho_bloco / 512);
-        memset(buffer_ponteiros_l1, 0, tamanho_bloco);
-        buffer_ponteiros_l1[0] = novo_bloco_dados;
-        escrever_bloco(fd, sb, bloco_indireto, buffer_ponteiros_l1);
-        goto sucesso;
-    } else {
-        ler_bloco(fd, sb, inode_pai->block[12], buffer_ponteiros_l1);
-        for (uint32_t i = 0; i < ponteiros_por_bloco; i++) {
-            if (buffer_ponteiros_l1[i] == 0) {
-                buffer_ponteiros_l1[i] = novo_bloco_dados;
-                escrever_bloco(fd, sb, inode_pai->block[12], buffer_ponteiros_l1);
-                goto sucesso;
-            }
-        }
-    }
-
-    // tenta alocar no bloco de indireção dupla (block[13])
-    // essa condição é rara mas optamos por manter a lógica caso seja necessário - pois para o projeto não vamos ter uma imagem tão grande
-    if (inode_pai->block[13] == 0) {
-        
-        // cenário A: A árvore de indireção dupla ainda não existe -> criamos tudo do zero
-        // precisamos alocar 3 blocos: L1, o primeiro L2, e o bloco de dados
-        uint32_t num_bloco_l1 = alocar_bloco(fd, sb, gdt, inode_pai_num);
-        if (num_bloco_l1 == 0) { liberar_bloco(fd, sb, gdt, novo_bloco_dados); goto falha; }
-
-        uint32_t num_bloco_l2 = alocar_bloco(fd, sb, gdt, inode_pai_num);
-        if (num_bloco_l2 == 0) { liberar_bloco(fd, sb, gdt, num_bloco_l1); liberar_bloco(fd, sb, gdt, novo_bloco_dados); goto falha; }
-
-        // se todas as alocações foram bem-sucedidas, começamos entao a linkar e escrever
-        inode_pai->block[13] = num_bloco_l1;
-        inode_pai->blocks += (tamanho_bloco / 512); // conta o novo bloco L1
-
-        // prepara e escreve o novo bloco L2. Ele aponta para nosso bloco de dados
-        memset(buffer_ponteiros_l2, 0, tamanho_bloco);
-        buffer_ponteiros_l2[0] = novo_bloco_dados;
-        escrever_bloco(fd, sb, num_bloco_l2, buffer_ponteiros_l2);
-        inode_pai->blocks += (tamanho_bloco / 512); // conta o novo bloco L2
-
-        // prepara e escreve o novo bloco L1 - ele aponta para nosso novo bloco L2
-        memset(buffer_ponteiros_l1, 0, tamanho_bloco);
-        buffer_ponteiros_l1[0] = num_bloco_l2;
-        escrever_bloco(fd, sb, num_bloco_l1, buffer_ponteiros_l1);
-        
-        goto preparar_e_escrever_novo_bloco; // Pula para a parte final que prepara o bloco de dados
-    } else {
-        // cenário B: O bloco L1 já existe -> recisamos percorrer ele
-
-        ler_bloco(fd, sb, inode_pai->block[13], buffer_ponteiros_l1); // Lê o bloco L1
-        for (uint32_t i = 0; i < ponteiros_por_bloco; i++) {
-            if (buffer_ponteiros_l1[i] == 0) {
-                // se encontramos um slot livre em L1 - podemos criar um novo bloco L2 
-                uint32_t num_bloco_l2 = alocar_bloco(fd, sb, gdt, inode_pai_num);
-                if (num_bloco_l2 == 0) { liberar_bloco(fd, sb, gdt, novo_bloco_dados); goto falha; }
-                
-                buffer_ponteiros_l1[i] = num_bloco_l2; // linka o novo L2 no L1
-                escrever_bloco(fd, sb, inode_pai->block[13], buffer_ponteiros_l1);      //   salva o L1 modificado
-                inode_pai->blocks += (tamanho_bloco / 512); // conta o novo bloco L2
-                
-                // prepara o novo bloco L2
-                memset(buffer_ponteiros_l2, 0, tamanho_bloco);
-                buffer_ponteiros_l2[0] = novo_bloco_dados;
-                escrever_bloco(fd, sb, num_bloco_l2, buffer_ponteiros_l2);
-                goto preparar_e_escrever_novo_bloco;
-            }
-
-            // se o ponteiro L1 não for nulo, verifica o bloco L2 que ele aponta
-            if (ler_bloco(fd, sb, buffer_ponteiros_l1[i], buffer_ponteiros_l2) == 0) {
-                for (uint32_t j = 0; j < ponteiros_por_bloco; j++) {
-                    if (buffer_ponteiros_l2[j] == 0) { // encontrou slot livre em um bloco L2 existente
-                        buffer_ponteiros_l2[j] = novo_bloco_dados;
-                        escrever_bloco(fd, sb, buffer_ponteiros_l1[i], buffer_ponteiros_l2); // salva L2 modificado
-                        goto preparar_e_escrever_novo_bloco;
-                    }
-                }
-            }
-        }
+    // definir_bloco_logico cria (e contabiliza em i_blocks) os blocos de ponteiros que faltarem
+    if (definir_bloco_logico(fd, sb, gdt, inode_pai, inode_pai_num, bloco_logico_novo, novo_bloco_dados) != 0) {
+        liberar_bloco(fd, sb, gdt, novo_bloco_dados);
+        goto falha;
     }
-
-preparar_e_escrever_novo_bloco:
     inode_pai->size += tamanho_bloco;
     inode_pai->blocks += (tamanho_bloco / 512);
+
+    // prepara o conteúdo do novo bloco de dados: uma única entrada ocupando o bloco todo
     memset(buffer_dados, 0, tamanho_bloco);
-    nova_entry = (ext2_dir_entry*)buffer_dados;
+    ext2_dir_entry* nova_entry = (ext2_dir_entry*)buffer_dados;
     nova_entry->inode = inode_filho;
     nova_entry->name_len = tam_nome_novo;
     nova_entry->rec_len = tamanho_bloco;
     nova_entry->file_type = tipo_arquivo;
     memcpy(nova_entry->name, nome_filho, tam_nome_novo);
     escrever_bloco(fd, sb, novo_bloco_dados, buffer_dados);
-    goto sucesso;
+
+    cache_dentries_guardar(inode_pai_num, nome_filho, inode_filho);
+    buffer_bloco_devolver(buffer_dados);
+    return 0;
 
 falha:
-    free(buffer_dados); free(buffer_ponteiros_l1); free(buffer_ponteiros_l2);
+    buffer_bloco_devolver(buffer_dados);
     fprintf(stderr, "Erro: Falha ao alocar novo bloco ou diretório está completamente cheio.\n");
     return -1;
+}
 
-sucesso:
-    free(buffer_dados); free(buffer_ponteiros_l1); free(buffer_ponteiros_l2);
-    return 0;
-
-
+/**
+ * @brief Adiciona uma nova entrada de diretório a um diretório pai.
+ *
+ * Procura espaço nos blocos existentes (diretos). Se não encontrar, tenta alocar um novo
+ * bloco de dados, primeiro nos ponteiros diretos e depois no bloco de indireção simples.
+ *
+ * Segura a trava do inode pai e a de escrita do diretório. Com várias threads, quem
+ * lê o inode pai, chama esta função e depois o grava deve segurar a trava do inode
+ * pai (trava_inode_adquirir, recursiva) durante toda a sequência.
+ *
+ * IMPORTANTE: Modifica 'inode_pai' em memória. O chamador DEVE escrevê-lo de volta ao disco.
+ * @return 0 em sucesso, -1 em erro.
+ */
+int adicionar_entrada_diretorio(int fd, superbloco* sb, group_desc* gdt, inode* inode_pai, uint32_t inode_pai_num, uint32_t inode_filho, const char* nome_filho, uint8_t tipo_arquivo) {
+    trava_inode_adquirir(inode_pai_num);
+    trava_diretorio_escrever(inode_pai_num);
+    int status = adicionar_entrada_sem_trava(fd, sb, gdt, inode_pai, inode_pai_num, inode_filho, nome_filho, tipo_arquivo);
+    trava_diretorio_liberar(inode_pai_num);
+    trava_inode_liberar(inode_pai_num);
+    return status;
 }
 
 
@@ -1696,12 +2344,48 @@ sucesso:
  * =================================================================================
  */
 
+/**
+ * @brief Quantidade de blocos de um grupo (o último pode ser menor que blocks_per_group).
+ *
+ * @param sb O superbloco.
+ * @param grupo O índice do grupo.
+ * @return O número de bits válidos no bitmap de blocos do grupo.
+ */
+uint32_t blocos_no_grupo(const superbloco* sb, uint32_t grupo) {
+    uint32_t primeiro = grupo * sb->blocks_per_group + sb->first_data_block;
+    uint32_t restantes = sb->blocks_count - primeiro;
+    return (restantes < sb->blocks_per_group) ? restantes : sb->blocks_per_group;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Aloca o primeiro bloco livre de um grupo, com a trava do grupo.
+ * @return O número absoluto do bloco, ou 0 se o grupo não tiver bloco livre.
+ */
+static uint32_t alocar_bloco_no_grupo(int fd, superbloco* sb, group_desc* gdt, uint32_t grupo) {
+    uint32_t bloco = 0;
+    trava_grupo_adquirir(grupo);
+    if (gdt[grupo].free_blocks_count > 0) {
+        unsigned char* bitmap = cache_bitmaps_obter(fd, sb, gdt, grupo, BITMAP_BLOCOS);
+        int32_t i = bitmap ? bitmap_procurar_zero(bitmap, 0, blocos_no_grupo(sb, grupo)) : -1;
+        if (i >= 0) {
+            setar_bit(bitmap, i);
+            cache_bitmaps_marcar_sujo(grupo, BITMAP_BLOCOS);
+            ajustar_contadores_livres(fd, sb, gdt, grupo, -1, 0);
+            // Calcula o número absoluto do bloco
+            bloco = (grupo * sb->blocks_per_group) + sb->first_data_block + (uint32_t)i;
+        }
+    }
+    trava_grupo_liberar(grupo);
+    return bloco;
+}
+
 /**
  * @brief Aloca um bloco de dados livre no sistema de arquivos.
  *
  * Tenta alocar um bloco no mesmo grupo do inode fornecido para otimizar o
  * posicionamento dos dados (localidade). Se não houver espaço, procura em
- * outros grupos.
+ * outros grupos. Os bitmaps vêm do cache de bitmaps e só são gravados no
+ * próximo ponto de sincronização.
  *
  * @param fd O descritor de arquivo.
  * @param sb O superbloco (será modificado).
@@ -1710,65 +2394,138 @@ sucesso:
  * @return O número do bloco alocado em caso de sucesso, 0 em caso de falha.
  */
 uint32_t alocar_bloco(int fd, superbloco* sb, group_desc* gdt, uint32_t inode_num) {
-    if (sb->free_blocks_count == 0) {
+    if (livres_no_superbloco(sb, BITMAP_BLOCOS) == 0) {
         fprintf(stderr, "Erro (alocar_bloco): Não há blocos livres no sistema de arquivos.\n");
         return 0;
     }
 
     uint32_t num_grupos = (sb->blocks_count + sb->blocks_per_group - 1) / sb->blocks_per_group;
-    uint32_t tamanho_bloco = calcular_tamanho_do_bloco(sb);
-    unsigned char* bitmap_buffer = malloc(tamanho_bloco);
-    if (!bitmap_buffer) {
-        perror("Erro (alocar_bloco): Falha ao alocar buffer para o bitmap");
-        return 0;
-    }
 
     // Estratégia de alocação:
     // Tentar alocar no mesmo grupo do inode.
     uint32_t grupo_ideal = (inode_num - 1) / sb->inodes_per_group;
-    if (gdt[grupo_ideal].free_blocks_count > 0) {
-        if (ler_bloco(fd, sb, gdt[grupo_ideal].block_bitmap, bitmap_buffer) == 0) {
-            for (uint32_t i = 0; i < sb->blocks_per_group; ++i) {
-                if (!bit_esta_setado(bitmap_buffer, i)) {
-                    setar_bit(bitmap_buffer, i);
-                    escrever_bloco(fd, sb, gdt[grupo_ideal].block_bitmap, bitmap_buffer);
-                    sb->free_blocks_count--;
-                    gdt[grupo_ideal].free_blocks_count--;
-                    escrever_superbloco(fd, sb);
-                    escrever_descritor_grupo(fd, sb, grupo_ideal, &gdt[grupo_ideal]);
-                    free(bitmap_buffer);
-                    // Calcula o número absoluto do bloco
-                    return (grupo_ideal * sb->blocks_per_group) + sb->first_data_block + i;
-                }
-            }
-        }
-    }
+    uint32_t bloco = alocar_bloco_no_grupo(fd, sb, gdt, grupo_ideal);
+    if (bloco != 0) return bloco;
 
     // Se não deu certo, procurar em qualquer outro grupo.
     for (uint32_t i = 0; i < num_grupos; ++i) {
-        if (gdt[i].free_blocks_count > 0) {
-            if (ler_bloco(fd, sb, gdt[i].block_bitmap, bitmap_buffer) != 0) continue;
-            for (uint32_t j = 0; j < sb->blocks_per_group; ++j) {
-                if (!bit_esta_setado(bitmap_buffer, j)) {
-                    setar_bit(bitmap_buffer, j);
-                    escrever_bloco(fd, sb, gdt[i].block_bitmap, bitmap_buffer);
-                    sb->free_blocks_count--;
-                    gdt[i].free_blocks_count--;
-                    escrever_superbloco(fd, sb);
-                    escrever_descritor_grupo(fd, sb, i, &gdt[i]);
-                    free(bitmap_buffer);
-                    return (i * sb->blocks_per_group) + sb->first_data_block + j;
-                }
-            }
-        }
+        if (i == grupo_ideal) continue;
+        bloco = alocar_bloco_no_grupo(fd, sb, gdt, i);
+        if (bloco != 0) return bloco;
     }
     
-    free(bitmap_buffer);
     fprintf(stderr, "Erro (alocar_bloco): Inconsistência! Superbloco indica blocos livres, mas nenhum foi encontrado.\n");
     return 0;
 }
 
 
+/**
+ * @brief (Função Auxiliar Estática) Reserva `quantidade` blocos livres consecutivos de um
+ * grupo, a partir do bit `inicio`, e atualiza os contadores. O chamador segura a trava do grupo.
+ * @return O número absoluto do primeiro bloco reservado.
+ */
+static uint32_t reservar_sequencia(int fd, superbloco* sb, group_desc* gdt, uint32_t grupo,
+                                   unsigned char* bitmap, uint32_t inicio, uint32_t quantidade) {
+    for (uint32_t i = 0; i < quantidade; ++i) {
+        setar_bit(bitmap, (int)(inicio + i));
+    }
+    cache_bitmaps_marcar_sujo(grupo, BITMAP_BLOCOS);
+    ajustar_contadores_livres(fd, sb, gdt, grupo, -(int32_t)quantidade, 0);
+    return (grupo * sb->blocks_per_group) + sb->first_data_block + inicio;
+}
+
+/**
+ * @brief Aloca uma sequência de blocos contíguos, de até `desejados` blocos.
+ *
+ * Os grupos são visitados a partir do grupo de `objetivo` (ou, se ele for 0, do grupo
+ * do inode, como em alocar_bloco). Primeiro procura-se uma sequência livre com o
+ * tamanho pedido inteiro, começando em `objetivo`, para que chamadas sucessivas
+ * continuem a sequência anterior. Se nenhum grupo tiver uma, a maior parte possível é
+ * tirada da primeira região livre encontrada: o chamador pede o restante em seguida.
+ *
+ * @param fd O descritor de arquivo.
+ * @param sb O superbloco (será modificado).
+ * @param gdt A tabela de descritores de grupo (será modificada).
+ * @param inode_num O número do inode que possuirá os blocos (dica de localidade).
+ * @param objetivo Bloco onde a sequência deveria começar (normalmente o seguinte ao último alocado), ou 0.
+ * @param desejados Quantidade máxima de blocos.
+ * @param obtidos Recebe a quantidade de blocos efetivamente alocados (>= 1 em sucesso).
+ * @return O número do primeiro bloco da sequência, ou 0 em caso de falha.
+ */
+uint32_t alocar_blocos_contiguos(int fd, superbloco* sb, group_desc* gdt, uint32_t inode_num,
+                                 uint32_t objetivo, uint32_t desejados, uint32_t* obtidos) {
+    *obtidos = 0;
+    uint32_t livres = livres_no_superbloco(sb, BITMAP_BLOCOS);
+    if (livres == 0) {
+        fprintf(stderr, "Erro (alocar_blocos_contiguos): Não há blocos livres no sistema de arquivos.\n");
+        return 0;
+    }
+    if (desejados == 0) desejados = 1;
+    if (desejados > livres) desejados = livres;
+
+    uint32_t num_grupos = (sb->blocks_count + sb->blocks_per_group - 1) / sb->blocks_per_group;
+    uint32_t grupo_inicial, bit_inicial = 0;
+    if (objetivo >= sb->first_data_block && objetivo < sb->blocks_count) {
+        grupo_inicial = (objetivo - sb->first_data_block) / sb->blocks_per_group;
+        bit_inicial = (objetivo - sb->first_data_block) % sb->blocks_per_group;
+    } else {
+        grupo_inicial = (inode_num - 1) / sb->inodes_per_group;
+    }
+
+    // 1ª passada: uma sequência do tamanho pedido, preferindo o grupo inicial.
+    for (uint32_t n = 0; n < num_grupos; ++n) {
+        uint32_t grupo = (grupo_inicial + n) % num_grupos;
+        trava_grupo_adquirir(grupo);
+        unsigned char* bitmap = (gdt[grupo].free_blocks_count < desejados) ? NULL
+                              : cache_bitmaps_obter(fd, sb, gdt, grupo, BITMAP_BLOCOS);
+        if (!bitmap) {
+            trava_grupo_liberar(grupo);
+            continue;
+        }
+
+        uint32_t total = blocos_no_grupo(sb, grupo);
+        int32_t i = -1;
+        if (n == 0 && bit_inicial > 0) {
+            i = bitmap_procurar_sequencia_zeros(bitmap, bit_inicial, total, desejados);
+        }
+        if (i < 0) i = bitmap_procurar_sequencia_zeros(bitmap, 0, total, desejados);
+        if (i >= 0) {
+            *obtidos = desejados;
+            uint32_t inicio = reservar_sequencia(fd, sb, gdt, grupo, bitmap, (uint32_t)i, desejados);
+            trava_grupo_liberar(grupo);
+            return inicio;
+        }
+        trava_grupo_liberar(grupo);
+    }
+
+    // 2ª passada: o espaço está fragmentado; usa a primeira região livre, até onde ela for.
+    for (uint32_t n = 0; n < num_grupos; ++n) {
+        uint32_t grupo = (grupo_inicial + n) % num_grupos;
+        trava_grupo_adquirir(grupo);
+        unsigned char* bitmap = (gdt[grupo].free_blocks_count == 0) ? NULL
+                              : cache_bitmaps_obter(fd, sb, gdt, grupo, BITMAP_BLOCOS);
+        uint32_t total = blocos_no_grupo(sb, grupo);
+        int32_t i = bitmap ? bitmap_procurar_zero(bitmap, (n == 0) ? bit_inicial : 0, total) : -1;
+        if (bitmap && i < 0 && n == 0 && bit_inicial > 0) i = bitmap_procurar_zero(bitmap, 0, total);
+        if (i < 0) {
+            trava_grupo_liberar(grupo);
+            continue;
+        }
+
+        uint32_t limite = ((uint64_t)i + desejados < total) ? (uint32_t)i + desejados : total;
+        int32_t ocupado = procurar_bit(bitmap, (uint32_t)i, limite, 1);
+        uint32_t quantidade = ((ocupado >= 0) ? (uint32_t)ocupado : limite) - (uint32_t)i;
+        *obtidos = quantidade;
+        uint32_t inicio = reservar_sequencia(fd, sb, gdt, grupo, bitmap, (uint32_t)i, quantidade);
+        trava_grupo_liberar(grupo);
+        return inicio;
+    }
+
+    fprintf(stderr, "Erro (alocar_blocos_contiguos): Inconsistência! Superbloco indica blocos livres, mas nenhum foi encontrado.\n");
+    return 0;
+}
+
+
 /**
  * @brief Libera um bloco de dados, marcando-o como livre no bitmap.
  *
@@ -1786,42 +2543,439 @@ int liberar_bloco(int fd, superbloco* sb, group_desc* gdt, uint32_t num_bloco) {
 
     uint32_t grupo_idx = (num_bloco - sb->first_data_block) / sb->blocks_per_group;
     uint32_t indice_no_bitmap = (num_bloco - sb->first_data_block) % sb->blocks_per_group;
-    
-    uint32_t tamanho_bloco = calcular_tamanho_do_bloco(sb);
-    unsigned char* bitmap_buffer = malloc(tamanho_bloco);
-    if (!bitmap_buffer) {
-        perror("Erro (liberar_bloco): Falha ao alocar buffer para o bitmap");
-        return -1;
-    }
 
-    if (ler_bloco(fd, sb, gdt[grupo_idx].block_bitmap, bitmap_buffer) != 0) {
+    trava_grupo_adquirir(grupo_idx);
+    unsigned char* bitmap = cache_bitmaps_obter(fd, sb, gdt, grupo_idx, BITMAP_BLOCOS);
+    if (!bitmap) {
+        trava_grupo_liberar(grupo_idx);
         fprintf(stderr, "Erro (liberar_bloco): Falha ao ler o bitmap de blocos do grupo %u.\n", grupo_idx);
-        free(bitmap_buffer);
         return -1;
     }
 
-    if (!bit_esta_setado(bitmap_buffer, indice_no_bitmap)) {
+    if (!bit_esta_setado(bitmap, indice_no_bitmap)) {
+        trava_grupo_liberar(grupo_idx);
         fprintf(stderr, "Aviso (liberar_bloco): Bloco %u já estava livre.\n", num_bloco);
-        free(bitmap_buffer);
         return 0;
     }
 
-    limpar_bit(bitmap_buffer, indice_no_bitmap);
+    limpar_bit(bitmap, indice_no_bitmap);
+    cache_bitmaps_marcar_sujo(grupo_idx, BITMAP_BLOCOS);
+    ajustar_contadores_livres(fd, sb, gdt, grupo_idx, 1, 0);
+    trava_grupo_liberar(grupo_idx);
+
+    return 0; // Sucesso
+}
+
+
+/**
+ * @brief Libera todos os blocos de um inode: dados e blocos de ponteiros, nos três
+ * níveis de indireção.
+ *
+ * O inode em si não é alterado; cabe ao chamador liberá-lo ou zerar seu mapa de blocos.
+ *
+ * @param fd O descritor de arquivo.
+ * @param sb O superbloco (será modificado).
+ * @param gdt A tabela de descritores de grupo (será modificada).
+ * @param ino O inode cujos blocos serão liberados.
+ * @return O número de blocos liberados, ou -1 em erro.
+ */
+int liberar_blocos_do_inode(int fd, superbloco* sb, group_desc* gdt, const inode* ino) {
+    iterador_blocos it;
+    if (iterador_blocos_iniciar(&it, fd, sb, ino, ITER_BLOCOS_INDIRETOS | ITER_IGNORAR_TAMANHO) != 0) return -1;
+
+    int liberados = 0;
+    uint32_t bloco_logico, bloco_fisico;
+    while (iterador_blocos_proximo(&it, &bloco_logico, &bloco_fisico)) {
+        if (liberar_bloco(fd, sb, gdt, bloco_fisico) == 0) liberados++;
+    }
+    iterador_blocos_finalizar(&it);
+    return liberados;
+}
+
+
+/**
+ * @brief (Função Auxiliar Estática) Limpa no bitmap do grupo os bits dos números de
+ * `nums[*i]` em diante que pertencem ao grupo, avançando *i.
+ *
+ * Números repetidos são ignorados; os que já estavam livres são contados em *ja_livres.
+ * O chamador segura a trava do grupo.
+ *
+ * @param primeiro Primeiro número coberto pelo grupo (bit 0 do bitmap).
+ * @param por_grupo Quantidade de números por grupo.
+ * @return Quantos bits foram limpos.
+ */
+static uint32_t limpar_bits_do_grupo(unsigned char* bitmap, const uint32_t* nums, size_t quantidade, size_t* i,
+                                     uint32_t primeiro, uint32_t por_grupo, uint32_t* ja_livres) {
+    uint32_t limpos = 0;
+    for (; *i < quantidade && nums[*i] - primeiro < por_grupo; ++*i) {
+        if (*i > 0 && nums[*i] == nums[*i - 1]) continue;
+        uint32_t indice = nums[*i] - primeiro;
+        if (!bit_esta_setado(bitmap, indice)) {
+            (*ja_livres)++;
+            continue;
+        }
+        limpar_bit(bitmap, indice);
+        limpos++;
+    }
+    return limpos;
+}
+
+/**
+ * @brief Libera de uma vez um conjunto de blocos e de inodes (ex: uma sub-árvore inteira).
+ *
+ * Os números são ordenados e tratados grupo a grupo: para cada grupo de blocos a
+ * trava é adquirida uma vez, os bitmaps são obtidos do cache uma vez e os
+ * contadores do descritor e do superbloco são ajustados uma única vez, em vez de
+ * uma vez por bloco como em `liberar_bloco`. Os inodes não são alterados; cabe ao
+ * chamador marcá-los como apagados.
+ *
+ * @param blocos Blocos a liberar (de dados e de ponteiros); o vetor é reordenado.
+ * @param inodes Inodes a liberar; o vetor é reordenado.
+ * @return 0 em sucesso, -1 se algum número era inválido ou algum bitmap não pôde ser lido.
+ */
+int liberar_em_lote(int fd, superbloco* sb, group_desc* gdt, uint32_t* blocos, size_t num_blocos, uint32_t* inodes, size_t num_inodes) {
+    int status = 0;
+    qsort(blocos, num_blocos, sizeof(uint32_t), comparar_uint32);
+    qsort(inodes, num_inodes, sizeof(uint32_t), comparar_uint32);
+
+    // Números fora da imagem ficam nas pontas dos vetores ordenados.
+    size_t i = 0, fim_blocos = num_blocos, k = 0, fim_inodes = num_inodes;
+    while (i < fim_blocos && blocos[i] < sb->first_data_block) i++;
+    while (fim_blocos > i && blocos[fim_blocos - 1] >= sb->blocks_count) fim_blocos--;
+    while (k < fim_inodes && inodes[k] == 0) k++;
+    while (fim_inodes > k && inodes[fim_inodes - 1] > sb->inodes_count) fim_inodes--;
+    if (i > 0 || fim_blocos < num_blocos || k > 0 || fim_inodes < num_inodes) {
+        fprintf(stderr, "Erro (liberar_em_lote): %zu bloco(s) e %zu inode(s) com números inválidos foram ignorados.\n",
+                i + (num_blocos - fim_blocos), k + (num_inodes - fim_inodes));
+        status = -1;
+    }
+
+    // Os números dos inodes podem ser reaproveitados: os nomes ligados a eles deixam de valer.
+    cache_dentries_invalidar_inodes(inodes + k, fim_inodes - k);
+
+    while (i < fim_blocos || k < fim_inodes) {
+        uint32_t grupo_bloco = (i < fim_blocos) ? (blocos[i] - sb->first_data_block) / sb->blocks_per_group : UINT32_MAX;
+        uint32_t grupo_inode = (k < fim_inodes) ? (inodes[k] - 1) / sb->inodes_per_group : UINT32_MAX;
+        uint32_t grupo = (grupo_bloco < grupo_inode) ? grupo_bloco : grupo_inode;
+        uint32_t blocos_limpos = 0, inodes_limpos = 0, ja_livres = 0;
+
+        trava_grupo_adquirir(grupo);
+        if (grupo_bloco == grupo) {
+            uint32_t primeiro = sb->first_data_block + grupo * sb->blocks_per_group;
+            unsigned char* bitmap = cache_bitmaps_obter(fd, sb, gdt, grupo, BITMAP_BLOCOS);
+            if (bitmap) {
+                blocos_limpos = limpar_bits_do_grupo(bitmap, blocos, fim_blocos, &i, primeiro, sb->blocks_per_group, &ja_livres);
+                if (blocos_limpos > 0) cache_bitmaps_marcar_sujo(grupo, BITMAP_BLOCOS);
+            } else {
+                fprintf(stderr, "Erro (liberar_em_lote): Falha ao ler o bitmap de blocos do grupo %u.\n", grupo);
+                status = -1;
+                while (i < fim_blocos && blocos[i] - primeiro < sb->blocks_per_group) i++;
+            }
+        }
+        if (grupo_inode == grupo) {
+            uint32_t primeiro = 1 + grupo * sb->inodes_per_group;
+            unsigned char* bitmap = cache_bitmaps_obter(fd, sb, gdt, grupo, BITMAP_INODES);
+            if (bitmap) {
+                inodes_limpos = limpar_bits_do_grupo(bitmap, inodes, fim_inodes, &k, primeiro, sb->inodes_per_group, &ja_livres);
+                if (inodes_limpos > 0) cache_bitmaps_marcar_sujo(grupo, BITMAP_INODES);
+            } else {
+                fprintf(stderr, "Erro (liberar_em_lote): Falha ao ler o bitmap de inodes do grupo %u.\n", grupo);
+                status = -1;
+                while (k < fim_inodes && inodes[k] - primeiro < sb->inodes_per_group) k++;
+            }
+        }
+        if (blocos_limpos > 0 || inodes_limpos > 0) {
+            ajustar_contadores_livres(fd, sb, gdt, grupo, (int32_t)blocos_limpos, (int32_t)inodes_limpos);
+        }
+        trava_grupo_liberar(grupo);
+
+        if (ja_livres > 0) fprintf(stderr, "Aviso (liberar_em_lote): %u bloco(s)/inode(s) do grupo %u já estavam livres.\n", ja_livres, grupo);
+    }
+    return status;
+}
+
+/**
+ * @brief Grava os metadados de alocação mantidos em memória.
+ *
+ * Chamada ao fim de cada comando, pelo 'sync' e no encerramento do shell. Cada
+ * bitmap alterado é gravado uma única vez, por mais alocações que tenha sofrido; os
+ * descritores de grupo sujos vão juntos em uma só escrita (do primeiro ao último
+ * alterado, já que ficam contíguos na GDT) e o superbloco por último.
+ *
+ * Segura as travas de todos os grupos e a do superbloco durante a gravação, para
+ * que nenhuma alocação simultânea deixe bitmaps e contadores gravados pela metade.
+ *
+ * @param fd O descritor de arquivo.
+ * @param sb O superbloco.
+ * @param gdt A tabela de descritores de grupo.
+ * @return 0 em sucesso, -1 se alguma gravação falhar.
+ */
+int sincronizar_metadados(int fd, const superbloco* sb, const group_desc* gdt) {
+    int status = 0;
+    trava_todos_grupos_adquirir();
+    trava_superbloco_adquirir();
+
+    if (cache_bitmaps_sincronizar(fd, sb, gdt) < 0) {
+        fprintf(stderr, "Erro (sincronizar_metadados): Falha ao gravar os bitmaps de alocação.\n");
+        status = -1;
+    }
+
+    uint32_t primeiro = num_descritores_sujos, ultimo = 0;
+    for (uint32_t i = 0; i < num_descritores_sujos; ++i) {
+        if (descritores_sujos[i]) {
+            if (primeiro == num_descritores_sujos) primeiro = i;
+            ultimo = i;
+        }
+    }
+    if (primeiro < num_descritores_sujos) {
+        size_t tamanho = (size_t)(ultimo - primeiro + 1) * sizeof(group_desc);
+        off_t offset = (off_t)(sb->first_data_block + 1) * calcular_tamanho_do_bloco(sb)
+                     + (off_t)primeiro * sizeof(group_desc);
+        if (io_escrever_em(fd, &gdt[primeiro], tamanho, offset) != (ssize_t)tamanho) {
+            perror("Erro (sincronizar_metadados): Falha ao gravar os descritores de grupo");
+            status = -1;
+        } else {
+            memset(descritores_sujos + primeiro, 0, ultimo - primeiro + 1);
+        }
+    }
+
+    if (superbloco_sujo) {
+        if (escrever_superbloco(fd, sb) != 0) status = -1;
+        else superbloco_sujo = 0;
+    }
+
+    trava_superbloco_liberar();
+    trava_todos_grupos_liberar();
+    return status;
+}
+
+
+/*
+ * =================================================================================
+ * Mapeamento de Blocos Lógicos
+ * =================================================================================
+ */
 
-    if (escrever_bloco(fd, sb, gdt[grupo_idx].block_bitmap, bitmap_buffer) != 0) {
-        fprintf(stderr, "Erro (liberar_bloco): Falha ao escrever o bitmap de blocos atualizado.\n");
-        free(bitmap_buffer);
+/**
+ * @brief Traduz o índice lógico de um bloco do arquivo (0, 1, 2...) para o número do
+ * bloco físico no disco, seguindo os ponteiros diretos e de indireção simples, dupla e tripla.
+ *
+ * @param fd O descritor de arquivo.
+ * @param sb O superbloco.
+ * @param ino O inode do arquivo.
+ * @param bloco_logico O índice do bloco dentro do arquivo.
+ * @return O número do bloco físico, ou 0 se o bloco for um "buraco" ou em caso de erro.
+ */
+uint32_t mapear_bloco_logico(int fd, const superbloco* sb, const inode* ino, uint32_t bloco_logico) {
+    uint32_t tamanho_bloco = calcular_tamanho_do_bloco(sb);
+    uint32_t ponteiros_por_bloco = tamanho_bloco / sizeof(uint32_t);
+
+    if (bloco_logico < 12) {
+        return ino->block[bloco_logico];
+    }
+
+    uint32_t* buffer_ponteiros = buffer_bloco_obter();
+    if (!buffer_ponteiros) {
+        perror("Erro (mapear_bloco_logico): Falha ao alocar buffer");
+        return 0;
+    }
+
+    uint32_t fisico = 0;
+    bloco_logico -= 12;
+    if (bloco_logico < ponteiros_por_bloco) {
+        // Indireção simples
+        if (ino->block[12] != 0 && ler_bloco(fd, sb, ino->block[12], buffer_ponteiros) == 0) {
+            fisico = buffer_ponteiros[bloco_logico];
+        }
+    } else {
+        bloco_logico -= ponteiros_por_bloco;
+        if (bloco_logico < ponteiros_por_bloco * ponteiros_por_bloco) {
+            // Indireção dupla: L1 aponta para blocos L2, que apontam para os dados
+            if (ino->block[13] != 0 && ler_bloco(fd, sb, ino->block[13], buffer_ponteiros) == 0) {
+                uint32_t bloco_l2 = buffer_ponteiros[bloco_logico / ponteiros_por_bloco];
+                if (bloco_l2 != 0 && ler_bloco(fd, sb, bloco_l2, buffer_ponteiros) == 0) {
+                    fisico = buffer_ponteiros[bloco_logico % ponteiros_por_bloco];
+                }
+            }
+        } else {
+            // Indireção tripla: um nível de ponteiros a mais antes do L2
+            uint64_t deslocamento = (uint64_t)bloco_logico - (uint64_t)ponteiros_por_bloco * ponteiros_por_bloco;
+            uint64_t por_l1 = (uint64_t)ponteiros_por_bloco * ponteiros_por_bloco;
+            if (deslocamento < por_l1 * ponteiros_por_bloco && ino->block[14] != 0 &&
+                ler_bloco(fd, sb, ino->block[14], buffer_ponteiros) == 0) {
+                uint32_t bloco_l2 = buffer_ponteiros[deslocamento / por_l1];
+                deslocamento %= por_l1;
+                if (bloco_l2 != 0 && ler_bloco(fd, sb, bloco_l2, buffer_ponteiros) == 0) {
+                    uint32_t bloco_l3 = buffer_ponteiros[deslocamento / ponteiros_por_bloco];
+                    if (bloco_l3 != 0 && ler_bloco(fd, sb, bloco_l3, buffer_ponteiros) == 0) {
+                        fisico = buffer_ponteiros[deslocamento % ponteiros_por_bloco];
+                    }
+                }
+            }
+        }
+    }
+
+    buffer_bloco_devolver(buffer_ponteiros);
+    return fisico;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Garante que um bloco de ponteiros exista, alocando-o
+ * (zerado) se `bloco_atual` for 0. O bloco novo é contabilizado em `ino->blocks`.
+ * @return O número do bloco de ponteiros, ou 0 em erro.
+ */
+static uint32_t garantir_bloco_ponteiros(int fd, superbloco* sb, group_desc* gdt, inode* ino, uint32_t inode_num, uint32_t bloco_atual) {
+    if (bloco_atual != 0) return bloco_atual;
+
+    uint32_t tamanho_bloco = calcular_tamanho_do_bloco(sb);
+    uint32_t novo_bloco = alocar_bloco(fd, sb, gdt, inode_num);
+    if (novo_bloco == 0) return 0;
+
+    void* zeros = buffer_bloco_obter_zerado();
+    if (!zeros || escrever_bloco(fd, sb, novo_bloco, zeros) != 0) {
+        buffer_bloco_devolver(zeros);
+        liberar_bloco(fd, sb, gdt, novo_bloco);
+        return 0;
+    }
+    buffer_bloco_devolver(zeros);
+
+    ino->blocks += tamanho_bloco / 512;
+    return novo_bloco;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Garante que exista toda a cadeia de blocos de ponteiros
+ * até a folha que endereça o bloco lógico `bloco_logico` (>= 12).
+ *
+ * @param buffer Buffer de trabalho com um bloco de tamanho.
+ * @param indice_na_folha Recebe a posição do bloco lógico dentro da folha.
+ * @return O número do bloco de ponteiros folha, ou 0 em erro.
+ */
+static uint32_t garantir_folha_de_ponteiros(int fd, superbloco* sb, group_desc* gdt, inode* ino, uint32_t inode_num,
+                                            uint32_t bloco_logico, uint32_t* buffer, uint32_t* indice_na_folha) {
+    const uint64_t p = calcular_tamanho_do_bloco(sb) / sizeof(uint32_t);
+
+    // Descobre a região (simples, dupla ou tripla) e o deslocamento dentro dela.
+    uint64_t deslocamento = (uint64_t)bloco_logico - 12;
+    uint64_t cobertura = p;
+    int niveis_indiretos = 1;
+    while (niveis_indiretos < 3 && deslocamento >= cobertura) {
+        deslocamento -= cobertura;
+        niveis_indiretos++;
+        cobertura *= p;
+    }
+    if (deslocamento >= cobertura) {
+        fprintf(stderr, "Erro (definir_bloco_logico): Bloco lógico %u além do endereçável.\n", bloco_logico);
+        return 0;
+    }
+
+    int raiz = 11 + niveis_indiretos;
+    ino->block[raiz] = garantir_bloco_ponteiros(fd, sb, gdt, ino, inode_num, ino->block[raiz]);
+    uint32_t bloco = ino->block[raiz];
+
+    // Desce pelos níveis intermediários, criando os blocos de ponteiros que faltarem.
+    for (int nivel = 1; nivel < niveis_indiretos && bloco != 0; ++nivel) {
+        cobertura /= p;
+        uint32_t indice = (uint32_t)((deslocamento / cobertura) % p);
+        if (ler_bloco(fd, sb, bloco, buffer) != 0) return 0;
+
+        uint32_t filho = buffer[indice];
+        if (filho == 0) {
+            filho = garantir_bloco_ponteiros(fd, sb, gdt, ino, inode_num, 0);
+            if (filho == 0) return 0;
+            buffer[indice] = filho;
+            if (escrever_bloco(fd, sb, bloco, buffer) != 0) return 0;
+        }
+        bloco = filho;
+    }
+
+    *indice_na_folha = (uint32_t)(deslocamento % p);
+    return bloco;
+}
+
+/**
+ * @brief (Função Auxiliar Estática) Corpo de `definir_blocos_logicos`, com o inode já travado.
+ */
+static int definir_blocos_sem_trava(int fd, superbloco* sb, group_desc* gdt, inode* ino, uint32_t inode_num,
+                                    uint32_t bloco_logico, uint32_t bloco_fisico, uint32_t quantidade) {
+    uint32_t tamanho_bloco = calcular_tamanho_do_bloco(sb);
+    uint32_t ponteiros_por_bloco = tamanho_bloco / sizeof(uint32_t);
+
+    for (; quantidade > 0 && bloco_logico < 12; --quantidade) {
+        ino->block[bloco_logico++] = bloco_fisico++;
+    }
+    if (quantidade == 0) return 0;
+
+    uint32_t* buffer_ponteiros = buffer_bloco_obter();
+    if (!buffer_ponteiros) {
+        perror("Erro (definir_bloco_logico): Falha ao alocar buffer");
         return -1;
     }
 
-    sb->free_blocks_count++;
-    gdt[grupo_idx].free_blocks_count++;
-    
-    escrever_superbloco(fd, sb);
-    escrever_descritor_grupo(fd, sb, grupo_idx, &gdt[grupo_idx]);
+    int status = 0;
+    while (quantidade > 0) {
+        uint32_t indice;
+        uint32_t folha = garantir_folha_de_ponteiros(fd, sb, gdt, ino, inode_num, bloco_logico, buffer_ponteiros, &indice);
+        if (folha == 0 || ler_bloco(fd, sb, folha, buffer_ponteiros) != 0) {
+            status = -1;
+            break;
+        }
 
-    free(bitmap_buffer);
-    return 0; // Sucesso
+        uint32_t nesta_folha = ponteiros_por_bloco - indice;
+        if (nesta_folha > quantidade) nesta_folha = quantidade;
+        for (uint32_t i = 0; i < nesta_folha; ++i) {
+            buffer_ponteiros[indice + i] = bloco_fisico + i;
+        }
+        if (escrever_bloco(fd, sb, folha, buffer_ponteiros) != 0) {
+            status = -1;
+            break;
+        }
+
+        bloco_logico += nesta_folha;
+        bloco_fisico += nesta_folha;
+        quantidade -= nesta_folha;
+    }
+
+    buffer_bloco_devolver(buffer_ponteiros);
+    return status;
+}
+
+/**
+ * @brief Faz os blocos lógicos [bloco_logico, bloco_logico + quantidade) do arquivo
+ * apontarem para os blocos físicos consecutivos a partir de `bloco_fisico`, criando os
+ * blocos de indireção (simples, dupla ou tripla) que faltarem.
+ *
+ * Cada bloco de ponteiros tocado é lido e gravado uma única vez por chamada, por
+ * maior que seja a sequência.
+ *
+ * Os blocos de ponteiros criados entram em `ino->blocks`; os blocos de dados
+ * não (o chamador decide como contabilizá-los).
+ *
+ * Os blocos de ponteiros do inode são alterados com a trava do inode.
+ *
+ * IMPORTANTE: Modifica 'ino' em memória. O chamador DEVE escrevê-lo de volta ao disco.
+ * @return 0 em sucesso, -1 em erro.
+ */
+int definir_blocos_logicos(int fd, superbloco* sb, group_desc* gdt, inode* ino, uint32_t inode_num,
+                           uint32_t bloco_logico, uint32_t bloco_fisico, uint32_t quantidade) {
+    trava_inode_adquirir(inode_num);
+    int status = definir_blocos_sem_trava(fd, sb, gdt, ino, inode_num, bloco_logico, bloco_fisico, quantidade);
+    trava_inode_liberar(inode_num);
+    return status;
+}
+
+/**
+ * @brief Faz o índice lógico `bloco_logico` do arquivo apontar para o bloco físico
+ * `bloco_fisico`, criando os blocos de indireção que faltarem.
+ *
+ * Os blocos de ponteiros criados entram em `ino->blocks`; o próprio bloco de dados
+ * não (o chamador decide como contabilizá-lo).
+ *
+ * IMPORTANTE: Modifica 'ino' em memória. O chamador DEVE escrevê-lo de volta ao disco.
+ * @return 0 em sucesso, -1 em erro.
+ */
+int definir_bloco_logico(int fd, superbloco* sb, group_desc* gdt, inode* ino, uint32_t inode_num, uint32_t bloco_logico, uint32_t bloco_fisico) {
+    return definir_blocos_logicos(fd, sb, gdt, ino, inode_num, bloco_logico, bloco_fisico, 1);
 }
 
 /**
@@ -1830,11 +2984,11 @@ int liberar_bloco(int fd, superbloco* sb, group_desc* gdt, uint32_t num_bloco) {
  */
 static int remover_entrada_em_bloco(int fd, const superbloco* sb, uint32_t num_bloco, const char* nome_filho) {
     uint32_t tamanho_bloco = calcular_tamanho_do_bloco(sb);
-    char* buffer = malloc(tamanho_bloco);
+    char* buffer = buffer_bloco_obter();
     if (!buffer) return -1;
 
     if (ler_bloco(fd, sb, num_bloco, buffer) != 0) {
-        free(buffer);
+        buffer_bloco_devolver(buffer);
         return -1;
     }
 
@@ -1856,73 +3010,64 @@ static int remover_entrada_em_bloco(int fd, const superbloco* sb, uint32_t num_b
             }
 
             escrever_bloco(fd, sb, num_bloco, buffer);
-            free(buffer);
+            buffer_bloco_devolver(buffer);
             return 1; // Encontrado e removido!
         }
         entry_anterior = entry_atual;
         offset += entry_atual->rec_len;
     }
     
-    free(buffer);
+    buffer_bloco_devolver(buffer);
     return 0; // Não encontrado neste bloco
 }
 
 
 /**
- * @brief Remove uma entrada de um diretório pai, procurando nos blocos diretos e indiretos.
- * @return 0 em sucesso, -1 em erro.
+ * @brief (Função Auxiliar Estática) Corpo de `remover_entrada_diretorio`, com o diretório já travado.
  */
-int remover_entrada_diretorio(int fd, superbloco* sb, inode* inode_pai, const char* nome_filho) {
+static int remover_entrada_sem_trava(int fd, superbloco* sb, inode* inode_pai, uint32_t inode_pai_num, const char* nome_filho) {
     int status = 0;
-    uint32_t tamanho_bloco = calcular_tamanho_do_bloco(sb);
-    uint32_t ponteiros_por_bloco = tamanho_bloco / sizeof(uint32_t);
-    uint32_t* buffer_ponteiros = malloc(tamanho_bloco);
-    if (!buffer_ponteiros) {
-        perror("remover_entrada: falha ao alocar buffer");
-        return -1;
-    }
 
-    // Procura nos blocos diretos
-    for (int i = 0; i < 12; i++) {
-        if (inode_pai->block[i] == 0) continue;
-        status = remover_entrada_em_bloco(fd, sb, inode_pai->block[i], nome_filho);
-        if (status != 0) goto cleanup; // Se encontrou (1) ou deu erro (-1), termina.
+    // Em diretórios indexados, tenta primeiro a folha indicada pelo hash do nome.
+    uint32_t folha_indexada = htree_localizar_folha(fd, sb, inode_pai, nome_filho);
+    if (folha_indexada != 0) {
+        status = remover_entrada_em_bloco(fd, sb, folha_indexada, nome_filho);
     }
 
-    // Procura no bloco de indireção simples
-    if (inode_pai->block[12] != 0) {
-        if (ler_bloco(fd, sb, inode_pai->block[12], buffer_ponteiros) == 0) {
-            for (uint32_t i = 0; i < ponteiros_por_bloco; i++) {
-                if (buffer_ponteiros[i] == 0) continue;
-                status = remover_entrada_em_bloco(fd, sb, buffer_ponteiros[i], nome_filho);
-                if (status != 0) goto cleanup;
-            }
-        }
-    }
+    // Senão, procura em todos os blocos do diretório
+    if (status == 0) {
+        iterador_blocos it;
+        if (iterador_blocos_iniciar(&it, fd, sb, inode_pai, ITER_ANTECIPAR) != 0) return -1;
 
-    // Procura no bloco de indireção dupla
-    if (inode_pai->block[13] != 0) {
-        if (ler_bloco(fd, sb, inode_pai->block[13], buffer_ponteiros) == 0) { // Lê L1
-            for (uint32_t i = 0; i < ponteiros_por_bloco; i++) {
-                if (buffer_ponteiros[i] == 0) continue;
-                uint32_t* bloco_L2 = malloc(tamanho_bloco);
-                if (bloco_L2 && ler_bloco(fd, sb, buffer_ponteiros[i], bloco_L2) == 0) { // Lê L2
-                    for (uint32_t j = 0; j < ponteiros_por_bloco; j++) {
-                        if (bloco_L2[j] == 0) continue;
-                        status = remover_entrada_em_bloco(fd, sb, bloco_L2[j], nome_filho);
-                        if (status != 0) { free(bloco_L2); goto cleanup; }
-                    }
-                }
-                free(bloco_L2);
-            }
+        uint32_t bloco_logico, bloco_fisico;
+        while (status == 0 && iterador_blocos_proximo(&it, &bloco_logico, &bloco_fisico)) {
+            // Se encontrou (1) ou deu erro (-1), termina.
+            status = remover_entrada_em_bloco(fd, sb, bloco_fisico, nome_filho);
         }
+        iterador_blocos_finalizar(&it);
     }
 
-cleanup:
-    free(buffer_ponteiros);
+    if (status == 1) {
+        cache_dentries_guardar(inode_pai_num, nome_filho, 0); // O nome passa a não existir
+    }
     return (status == 1) ? 0 : -1; // Retorna 0 para sucesso, -1 se não encontrou ou deu erro.
 }
 
+/**
+ * @brief Remove uma entrada de um diretório pai, procurando nos blocos diretos e indiretos.
+ *
+ * Segura a trava do inode pai e a de escrita do diretório (ver adicionar_entrada_diretorio).
+ * @return 0 em sucesso, -1 em erro.
+ */
+int remover_entrada_diretorio(int fd, superbloco* sb, inode* inode_pai, uint32_t inode_pai_num, const char* nome_filho) {
+    trava_inode_adquirir(inode_pai_num);
+    trava_diretorio_escrever(inode_pai_num);
+    int status = remover_entrada_sem_trava(fd, sb, inode_pai, inode_pai_num, nome_filho);
+    trava_diretorio_liberar(inode_pai_num);
+    trava_inode_liberar(inode_pai_num);
+    return status;
+}
+
 
 
 
@@ -1931,15 +3076,16 @@ cleanup:
  * @param num_bloco O número do bloco de dados a ser verificado.
  * @return 1 se encontrar outras entradas, 0 se estiver "limpo", -1 em erro de leitura.
  */
-static int bloco_dir_contem_entradas(int fd, const superbloco* sb, uint32_t num_bloco, char* buffer) {
+static int bloco_dir_contem_entradas(int fd, const superbloco* sb, uint32_t num_bloco, char* buffer_reserva) {
     if (num_bloco == 0) return 0; // Bloco não alocado é considerado limpo.
-    if (ler_bloco(fd, sb, num_bloco, buffer) != 0) return -1; // Erro
+    const char* buffer = ler_bloco_ref(fd, sb, num_bloco, buffer_reserva);
+    if (!buffer) return -1; // Erro
 
     uint32_t tamanho_bloco = calcular_tamanho_do_bloco(sb);
     uint32_t offset = 0;
 
     while (offset < tamanho_bloco) {
-        ext2_dir_entry* entry = (ext2_dir_entry*)(buffer + offset);
+        const ext2_dir_entry* entry = (const ext2_dir_entry*)(buffer + offset);
         if (entry->rec_len == 0) break;
         
         if (entry->inode != 0) {
@@ -1970,57 +3116,29 @@ static int bloco_dir_contem_entradas(int fd, const superbloco* sb, uint32_t num_
 int diretorio_esta_vazio(int fd, const superbloco* sb, const inode* dir_ino) {
     if (!dir_ino || !EXT2_IS_DIR(dir_ino->mode)) return -1;
 
-    uint32_t tamanho_bloco = calcular_tamanho_do_bloco(sb);
-    uint32_t ponteiros_por_bloco = tamanho_bloco / sizeof(uint32_t);
-    char* buffer_dados = malloc(tamanho_bloco);
-    uint32_t* buffer_ponteiros = malloc(tamanho_bloco);
+    char* buffer_dados = buffer_bloco_obter();
+    iterador_blocos it;
 
-    if (!buffer_dados || !buffer_ponteiros) {
+    if (!buffer_dados) {
         perror("diretorio_esta_vazio: falha ao alocar buffers");
-        free(buffer_dados); free(buffer_ponteiros);
         return -1;
     }
-
-    int status_busca = 0;
-
-    // Verifica os blocos diretos
-    for (int i = 0; i < 12; i++) {
-        status_busca = bloco_dir_contem_entradas(fd, sb, dir_ino->block[i], buffer_dados);
-        if (status_busca != 0) goto cleanup; // Se encontrou (1) ou deu erro (-1), para a busca.
+    if (iterador_blocos_iniciar(&it, fd, sb, dir_ino, ITER_ANTECIPAR) != 0) {
+        buffer_bloco_devolver(buffer_dados);
+        return -1;
     }
 
-    // Verifica o bloco de indireção simples
-    if (dir_ino->block[12] != 0) {
-        if (ler_bloco(fd, sb, dir_ino->block[12], buffer_ponteiros) == 0) {
-            for (uint32_t i = 0; i < ponteiros_por_bloco; i++) {
-                status_busca = bloco_dir_contem_entradas(fd, sb, buffer_ponteiros[i], buffer_dados);
-                if (status_busca != 0) goto cleanup;
-            }
-        }
-    }
+    int status_busca = 0;
+    uint32_t bloco_logico, bloco_fisico;
 
-    // Verifica o bloco de indireção dupla
-    if (dir_ino->block[13] != 0) {
-        if (ler_bloco(fd, sb, dir_ino->block[13], buffer_ponteiros) == 0) { // Lê L1
-            for (uint32_t i = 0; i < ponteiros_por_bloco; i++) {
-                if (buffer_ponteiros[i] == 0) continue;
-                uint32_t* bloco_L2 = malloc(tamanho_bloco);
-                if (bloco_L2 && ler_bloco(fd, sb, buffer_ponteiros[i], bloco_L2) == 0) { // Lê L2
-                    for (uint32_t j = 0; j < ponteiros_por_bloco; j++) {
-                        status_busca = bloco_dir_contem_entradas(fd, sb, bloco_L2[j], buffer_dados);
-                        if (status_busca != 0) { free(bloco_L2); goto cleanup; }
-                    }
-                }
-                free(bloco_L2);
-            }
-        }
+    // Verifica todos os blocos do diretório; para no primeiro que tiver entradas (1) ou der erro (-1).
+    while (status_busca == 0 && iterador_blocos_proximo(&it, &bloco_logico, &bloco_fisico)) {
+        status_busca = bloco_dir_contem_entradas(fd, sb, bloco_fisico, buffer_dados);
     }
+    if (status_busca == 0 && it.erro) status_busca = -1;
 
-    // A verificação de indireção tripla seguiria o mesmo padrão mas optamos por omitir devido raridade do uso
-
-cleanup:
-    free(buffer_dados);
-    free(buffer_ponteiros);
+    iterador_blocos_finalizar(&it);
+    buffer_bloco_devolver(buffer_dados);
     // Se status_busca for 1, significa que não está vazio, então retornamos 0.
     // Se status_busca for 0, significa que está vazio, então retornamos 1.
     // Se status_busca for -1 (erro), retornamos -1.
@@ -0,0 +1,43 @@
+#!/bin/bash
+#
+# Funções compartilhadas pelos testes (tests/teste_*.sh).
+#
+# Cada teste monta uma imagem ext2 a partir de um diretório do host (mke2fs -d),
+# roda comandos do shell em lote (-c) e confere a saída e a imagem (e2fsck).
+#
+# Autor: Allan Custódio Diniz Marques (L33tSh4rk)
+# Data de criação: 16 de outubro de 2026
+# Data de atualização: 16 de outubro de 2026
+#
+
+RAIZ_REPO="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+EXT2SHELL="$RAIZ_REPO/bin/ext2shell"
+TEMP="$(mktemp -d)"
+trap 'rm -rf "$TEMP"' EXIT
+
+# Sem as ferramentas do e2fsprogs não há como montar nem conferir as imagens.
+if ! command -v mke2fs >/dev/null || ! command -v e2fsck >/dev/null; then
+    echo "$(basename "$0"): pulado (mke2fs/e2fsck não encontrados)"
+    exit 0
+fi
+
+# falhar <mensagem>: encerra o teste com erro.
+falhar() {
+    echo "$(basename "$0"): FALHOU: $1" >&2
+    exit 1
+}
+
+# criar_imagem <diretório de origem> <imagem>: imagem ext2 de 8 MiB com blocos de 1 KiB.
+criar_imagem() {
+    rm -f "$2"
+    mke2fs -q -F -t ext2 -b 1024 -d "$1" "$2" 8M >/dev/null 2>&1 || falhar "mke2fs não conseguiu criar $2"
+}
+
+# verificar_imagem <imagem>: e2fsck não pode apontar nada além da contagem de
+# diretórios por grupo, que o shell não mantém (limitação conhecida).
+verificar_imagem() {
+    local problemas
+    problemas="$(e2fsck -fn "$1" 2>&1 | grep -v -E '^(e2fsck |Pass [0-9]|Fix\? no|$|.*WARNING|Directories count wrong|.*: [0-9]+/[0-9]+ files)')"
+    [ -z "$problemas" ] || falhar "e2fsck encontrou problemas em $1:
+$problemas"
+}
@@ -0,0 +1,26 @@
+#!/bin/bash
+#
+# 'du' imprime cada diretório depois do seu conteúdo, inclusive quando a raiz do
+# percurso é "/" (um caminho que já termina em barra).
+#
+# Data de criação: 16 de outubro de 2026
+# Data de atualização: 16 de outubro de 2026
+#
+
+source "$(dirname "$0")/comum.sh"
+
+mkdir -p "$TEMP/origem/a/b" "$TEMP/origem/c"
+echo "x" > "$TEMP/origem/a/b/f"
+echo "y" > "$TEMP/origem/c/g"
+criar_imagem "$TEMP/origem" "$TEMP/img"
+
+for raiz in / /a; do
+    saida="$("$EXT2SHELL" -j 4 -c "du $raiz" "$TEMP/img" 2>/dev/null | grep -v '^\[')"
+    ultima="$(echo "$saida" | tail -n 1 | cut -f 2)"
+    [ "$ultima" = "$raiz" ] || falhar "'du $raiz' não imprimiu a raiz por último:
+$saida"
+    total="$("$EXT2SHELL" -c "du -s $raiz" "$TEMP/img" 2>/dev/null | grep -v '^\[' | cut -f 1)"
+    [ "$(echo "$saida" | tail -n 1 | cut -f 1)" = "$total" ] || falhar "'du $raiz' e 'du -s $raiz' discordam"
+done
+
+echo "$(basename "$0"): ok"
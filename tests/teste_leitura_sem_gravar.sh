@@ -0,0 +1,36 @@
+#!/bin/bash
+#
+# Comandos de leitura não gravam os blocos sujos do cache (write-back) que não têm
+# nada a ver com o arquivo lido; só os blocos do próprio arquivo iriam antes de uma
+# leitura direta da imagem.
+#
+# Data de criação: 16 de outubro de 2026
+# Data de atualização: 16 de outubro de 2026
+#
+
+source "$(dirname "$0")/comum.sh"
+
+mkdir -p "$TEMP/origem"
+head -c 4500 /dev/urandom | base64 > "$TEMP/origem/dados"
+criar_imagem "$TEMP/origem" "$TEMP/img"
+
+# blocos_gravados_apos <comando>: cria um diretório e um arquivo (blocos sujos no
+# cache), roda o comando de leitura e devolve o contador 'blocos gravados'.
+blocos_gravados_apos() {
+    "$EXT2SHELL" -c "mkdir x; touch y; $1; stats" "$TEMP/img" 2>/dev/null |
+        awk -F: '/blocos gravados/ { gsub(/ /, "", $2); print $2 }'
+}
+
+for comando in "cat dados" "cp dados $TEMP/copia" "head -c 3000 dados" "tail -c 3000 dados"; do
+    gravados="$(blocos_gravados_apos "$comando")"
+    [ "$gravados" = "0" ] || falhar "'$comando' gravou $gravados bloco(s) sujos de outros arquivos"
+    criar_imagem "$TEMP/origem" "$TEMP/img"
+done
+
+"$EXT2SHELL" -c "cat dados" "$TEMP/img" 2>/dev/null | grep -v '^\[' | head -c "$(stat -c %s "$TEMP/origem/dados")" | cmp -s - "$TEMP/origem/dados" ||
+    falhar "'cat' devolveu um conteúdo diferente do original"
+cmp -s "$TEMP/copia" "$TEMP/origem/dados" || falhar "'cp' gerou uma cópia diferente do original"
+"$EXT2SHELL" -c "tail -c 3000 dados" "$TEMP/img" 2>/dev/null | grep -v '^\[' | cmp -s - <(tail -c 3000 "$TEMP/origem/dados") ||
+    falhar "'tail' devolveu um conteúdo diferente do original"
+
+echo "$(basename "$0"): ok"
@@ -0,0 +1,27 @@
+#!/bin/bash
+#
+# rm -r de uma sub-árvore com links físicos: um arquivo com um link fora da árvore
+# (deve sobreviver, com um link a menos) e um com todos os links dentro dela (deve
+# ser liberado). A imagem precisa continuar consistente.
+#
+# Data de criação: 16 de outubro de 2026
+# Data de atualização: 16 de outubro de 2026
+#
+
+source "$(dirname "$0")/comum.sh"
+
+mkdir -p "$TEMP/origem/a/b" "$TEMP/origem/c"
+echo "fora da árvore" > "$TEMP/origem/a/b/f"
+ln "$TEMP/origem/a/b/f" "$TEMP/origem/c/f2"
+head -c 3000 /dev/zero > "$TEMP/origem/a/g"
+ln "$TEMP/origem/a/g" "$TEMP/origem/a/g2"
+echo "comum" > "$TEMP/origem/a/h"
+criar_imagem "$TEMP/origem" "$TEMP/img"
+
+saida="$("$EXT2SHELL" -c "rm -r /a; cat /c/f2; ls /a" "$TEMP/img" 2>&1)"
+echo "$saida" | grep -q "status 0: rm -r /a" || falhar "rm -r /a falhou: $saida"
+echo "$saida" | grep -q "^fora da árvore$" || falhar "o arquivo com link fora da árvore foi perdido: $saida"
+echo "$saida" | grep -q "status 1: ls /a" || falhar "/a ainda existe: $saida"
+verificar_imagem "$TEMP/img"
+
+echo "$(basename "$0"): ok"
@@ -0,0 +1,76 @@
+#!/bin/bash
+#
+# No servidor, um cliente não pode remover ('rm -r' ou 'rmdir') o diretório atual
+# de outro cliente conectado: o outro continuaria criando entradas em um inode já
+# liberado e a imagem ficaria corrompida.
+#
+# Data de criação: 16 de outubro de 2026
+# Data de atualização: 16 de outubro de 2026
+#
+
+source "$(dirname "$0")/comum.sh"
+
+mkdir -p "$TEMP/origem/d/e"
+echo "x" > "$TEMP/origem/d/f"
+criar_imagem "$TEMP/origem" "$TEMP/img"
+
+SOCKET="$TEMP/sock"
+"$EXT2SHELL" --servir "$SOCKET" "$TEMP/img" >"$TEMP/servidor.log" 2>&1 &
+PID_SERVIDOR=$!
+PID_CLIENTE_A=""
+trap 'exec 3>&- 2>/dev/null; kill $PID_CLIENTE_A "$PID_SERVIDOR" 2>/dev/null; wait 2>/dev/null; rm -rf "$TEMP"' EXIT
+
+for _ in $(seq 50); do
+    [ -S "$SOCKET" ] && break
+    sleep 0.1
+done
+[ -S "$SOCKET" ] || falhar "o servidor não criou o socket"
+
+# O cliente A fica conectado, lendo comandos de um FIFO.
+mkfifo "$TEMP/comandos_a"
+"$EXT2SHELL" --conectar "$SOCKET" <"$TEMP/comandos_a" >"$TEMP/cliente_a.txt" 2>&1 &
+PID_CLIENTE_A=$!
+exec 3>"$TEMP/comandos_a"
+
+# enviar_a <comando>: manda um comando ao cliente A e espera o seu status.
+NUMERO_A=0
+enviar_a() {
+    NUMERO_A=$((NUMERO_A + 1))
+    echo "$1" >&3
+    for _ in $(seq 100); do
+        grep -q "^\[$NUMERO_A\] status" "$TEMP/cliente_a.txt" && break
+        sleep 0.05
+    done
+    grep -q "^\[$NUMERO_A\] status 0: $1" "$TEMP/cliente_a.txt" || falhar "o cliente A falhou em '$1':
+$(cat "$TEMP/cliente_a.txt")"
+}
+
+# cliente_b <comandos>: executa comandos em outra conexão e devolve a saída.
+cliente_b() {
+    timeout 10 "$EXT2SHELL" --conectar "$SOCKET" -c "$1" 2>&1
+}
+
+enviar_a "cd /d/e"
+
+cliente_b "rmdir /d/e" >/dev/null && falhar "'rmdir' removeu o diretório atual de outra sessão"
+cliente_b "rm -r /d" >/dev/null && falhar "'rm -r' removeu uma árvore com o diretório atual de outra sessão"
+
+enviar_a "touch novo"
+enviar_a "mkdir z"
+saida="$(cliente_b "ls /d/e")" || falhar "'ls /d/e' falhou:
+$saida"
+echo "$saida" | grep -qx "novo" && echo "$saida" | grep -qx "z" || falhar "o conteúdo criado pelo cliente A sumiu:
+$saida"
+
+# Fora do diretório, a remoção volta a ser permitida.
+enviar_a "cd /"
+cliente_b "rm -r /d" >/dev/null || falhar "'rm -r /d' falhou depois que o cliente A saiu do diretório"
+
+exec 3>&-
+wait "$PID_CLIENTE_A"
+PID_CLIENTE_A=""
+kill "$PID_SERVIDOR"
+wait "$PID_SERVIDOR"
+verificar_imagem "$TEMP/img"
+
+echo "$(basename "$0"): ok"
@@ -0,0 +1,82 @@
+#!/bin/bash
+#
+# Um cliente que para no meio do envio de um pedido não pode travar o servidor:
+# os outros clientes continuam sendo atendidos e, quando o resto do pedido chega,
+# o cliente lento também recebe a sua resposta.
+#
+# Data de criação: 16 de outubro de 2026
+# Data de atualização: 16 de outubro de 2026
+#
+
+source "$(dirname "$0")/comum.sh"
+
+# O cliente parcial precisa falar o protocolo byte a byte.
+if ! command -v python3 >/dev/null; then
+    echo "$(basename "$0"): pulado (python3 não encontrado)"
+    exit 0
+fi
+
+mkdir -p "$TEMP/origem/a"
+echo "x" > "$TEMP/origem/a/f"
+criar_imagem "$TEMP/origem" "$TEMP/img"
+
+SOCKET="$TEMP/sock"
+"$EXT2SHELL" --servir "$SOCKET" "$TEMP/img" >"$TEMP/servidor.log" 2>&1 &
+PID_SERVIDOR=$!
+PID_PARADO=""
+# O cliente parcial sai primeiro: um servidor preso esperando por ele não atenderia o sinal.
+trap 'kill $PID_PARADO "$PID_SERVIDOR" 2>/dev/null; wait 2>/dev/null; rm -rf "$TEMP"' EXIT
+
+for _ in $(seq 50); do
+    [ -S "$SOCKET" ] && break
+    sleep 0.1
+done
+[ -S "$SOCKET" ] || falhar "o servidor não criou o socket"
+
+# Envia metade do cabeçalho de "pwd", espera o arquivo 'liberar' e só então manda o
+# resto; imprime o status e o stdout da resposta.
+python3 - "$SOCKET" "$TEMP/enviado" "$TEMP/liberar" >"$TEMP/parado.txt" 2>&1 <<'FIM' &
+import os, socket, struct, sys, time
+
+def receber(s, n):
+    dados = b""
+    while len(dados) < n:
+        parte = s.recv(n - len(dados))
+        if not parte:
+            raise SystemExit("conexão fechada")
+        dados += parte
+    return dados
+
+s = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+s.connect(sys.argv[1])
+linha = b"pwd"
+pedido = struct.pack("=I", len(linha)) + linha
+s.sendall(pedido[:2])
+open(sys.argv[2], "w").close()
+while not os.path.exists(sys.argv[3]):
+    time.sleep(0.05)
+s.sendall(pedido[2:])
+status, _, tamanho_saida, tamanho_erros = struct.unpack("=iIQQ", receber(s, 24))
+print(status, receber(s, tamanho_saida).decode(), end="")
+FIM
+PID_PARADO=$!
+
+for _ in $(seq 50); do
+    [ -e "$TEMP/enviado" ] && break
+    sleep 0.1
+done
+[ -e "$TEMP/enviado" ] || falhar "o cliente parcial não conseguiu se conectar"
+
+saida="$(timeout 10 "$EXT2SHELL" --conectar "$SOCKET" -c "ls /a" 2>&1)" ||
+    falhar "o servidor não atendeu um cliente enquanto outro estava parado:
+$saida"
+echo "$saida" | grep -qx "f" || falhar "resposta inesperada para 'ls /a':
+$saida"
+
+touch "$TEMP/liberar"
+timeout 10 tail --pid="$PID_PARADO" -f /dev/null || falhar "o cliente parcial não recebeu resposta"
+wait "$PID_PARADO" || falhar "o cliente parcial falhou: $(cat "$TEMP/parado.txt")"
+[ "$(cat "$TEMP/parado.txt")" = "0 /" ] || falhar "resposta inesperada para o pedido parcial:
+$(cat "$TEMP/parado.txt")"
+
+echo "$(basename "$0"): ok"
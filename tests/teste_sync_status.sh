@@ -0,0 +1,23 @@
+#!/bin/bash
+#
+# 'sync' sem nada a gravar (cache de blocos desativado) é um sucesso, não uma falha.
+#
+# Data de criação: 16 de outubro de 2026
+# Data de atualização: 16 de outubro de 2026
+#
+
+source "$(dirname "$0")/comum.sh"
+
+mkdir -p "$TEMP/origem"
+echo "x" > "$TEMP/origem/f"
+criar_imagem "$TEMP/origem" "$TEMP/img"
+
+numero=0
+for opcoes in "--cache 0" "--cache 64" "--cache 64 --inodes-write-back"; do
+    numero=$((numero + 1))
+    saida="$("$EXT2SHELL" $opcoes -c "touch g$numero; sync" "$TEMP/img" 2>&1)" || falhar "'sync' com '$opcoes' falhou:
+$saida"
+done
+verificar_imagem "$TEMP/img"
+
+echo "$(basename "$0"): ok"
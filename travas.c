@@ -0,0 +1,171 @@
+/**
+ * @file       travas.c
+ * @brief      Implementação das travas do núcleo (POSIX threads).
+ *
+ * @author     Allan Custódio Diniz Marques (L33tSh4rk)
+ *
+ * Antes de `travas_inicializar` (e depois de `travas_finalizar`) todas as funções
+ * são inofensivas e não travam nada, de modo que o núcleo continua utilizável por
+ * um único chamador sem nenhuma preparação.
+ *
+ * Data de criação: 16 de outubro de 2026
+ * Data de atualização: 16 de outubro de 2026
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "travas.h"
+
+static pthread_mutex_t* travas_grupos = NULL;
+static uint32_t num_travas_grupos = 0;
+static pthread_mutex_t trava_sb = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t travas_inodes[TRAVAS_FAIXAS_INODES];
+static pthread_rwlock_t travas_diretorios[TRAVAS_FAIXAS_INODES];
+static int travas_prontas = 0;
+
+
+/*
+ * =================================================================================
+ * Ciclo de Vida
+ * =================================================================================
+ */
+
+/**
+ * @brief Cria as travas para uma imagem com `num_grupos` grupos de blocos.
+ * @return 0 em sucesso, -1 em erro.
+ */
+int travas_inicializar(uint32_t num_grupos) {
+    travas_finalizar();
+
+    travas_grupos = malloc((size_t)(num_grupos ? num_grupos : 1) * sizeof(pthread_mutex_t));
+    if (!travas_grupos) {
+        perror("Erro (travas_inicializar): Falha ao alocar as travas dos grupos");
+        return -1;
+    }
+    for (uint32_t i = 0; i < num_grupos; ++i) pthread_mutex_init(&travas_grupos[i], NULL);
+    num_travas_grupos = num_grupos;
+
+    // As travas de inode são recursivas: escrever_inode pode ser chamada por quem já
+    // segura a trava do mesmo inode (ex: definir_blocos_logicos).
+    pthread_mutexattr_t atributos;
+    pthread_mutexattr_init(&atributos);
+    pthread_mutexattr_settype(&atributos, PTHREAD_MUTEX_RECURSIVE);
+    for (uint32_t i = 0; i < TRAVAS_FAIXAS_INODES; ++i) {
+        pthread_mutex_init(&travas_inodes[i], &atributos);
+        pthread_rwlock_init(&travas_diretorios[i], NULL);
+    }
+    pthread_mutexattr_destroy(&atributos);
+
+    travas_prontas = 1;
+    return 0;
+}
+
+/**
+ * @brief Destrói as travas. Nenhuma pode estar adquirida.
+ */
+void travas_finalizar(void) {
+    if (!travas_prontas) return;
+    for (uint32_t i = 0; i < num_travas_grupos; ++i) pthread_mutex_destroy(&travas_grupos[i]);
+    for (uint32_t i = 0; i < TRAVAS_FAIXAS_INODES; ++i) {
+        pthread_mutex_destroy(&travas_inodes[i]);
+        pthread_rwlock_destroy(&travas_diretorios[i]);
+    }
+    free(travas_grupos);
+    travas_grupos = NULL;
+    num_travas_grupos = 0;
+    travas_prontas = 0;
+}
+
+
+/*
+ * =================================================================================
+ * Grupos de Blocos e Superbloco
+ * =================================================================================
+ */
+
+/**
+ * @brief Adquire a trava de um grupo (bitmaps, descritor e tabela de inodes do grupo).
+ */
+void trava_grupo_adquirir(uint32_t grupo) {
+    if (travas_prontas && grupo < num_travas_grupos) pthread_mutex_lock(&travas_grupos[grupo]);
+}
+
+/**
+ * @brief Libera a trava de um grupo.
+ */
+void trava_grupo_liberar(uint32_t grupo) {
+    if (travas_prontas && grupo < num_travas_grupos) pthread_mutex_unlock(&travas_grupos[grupo]);
+}
+
+/**
+ * @brief Adquire as travas de todos os grupos, em ordem crescente (pontos de sincronização).
+ */
+void trava_todos_grupos_adquirir(void) {
+    for (uint32_t i = 0; travas_prontas && i < num_travas_grupos; ++i) pthread_mutex_lock(&travas_grupos[i]);
+}
+
+/**
+ * @brief Libera as travas de todos os grupos.
+ */
+void trava_todos_grupos_liberar(void) {
+    for (uint32_t i = num_travas_grupos; travas_prontas && i > 0; --i) pthread_mutex_unlock(&travas_grupos[i - 1]);
+}
+
+/**
+ * @brief Adquire a trava dos contadores do superbloco.
+ */
+void trava_superbloco_adquirir(void) {
+    if (travas_prontas) pthread_mutex_lock(&trava_sb);
+}
+
+/**
+ * @brief Libera a trava dos contadores do superbloco.
+ */
+void trava_superbloco_liberar(void) {
+    if (travas_prontas) pthread_mutex_unlock(&trava_sb);
+}
+
+
+/*
+ * =================================================================================
+ * Inodes e Diretórios
+ * =================================================================================
+ */
+
+/**
+ * @brief Adquire a trava de um inode (recursiva para a mesma thread).
+ */
+void trava_inode_adquirir(uint32_t inode_num) {
+    if (travas_prontas) pthread_mutex_lock(&travas_inodes[inode_num % TRAVAS_FAIXAS_INODES]);
+}
+
+/**
+ * @brief Libera a trava de um inode.
+ */
+void trava_inode_liberar(uint32_t inode_num) {
+    if (travas_prontas) pthread_mutex_unlock(&travas_inodes[inode_num % TRAVAS_FAIXAS_INODES]);
+}
+
+/**
+ * @brief Adquire a trava de um diretório para leitura (buscas e listagens simultâneas).
+ */
+void trava_diretorio_ler(uint32_t inode_num) {
+    if (travas_prontas) pthread_rwlock_rdlock(&travas_diretorios[inode_num % TRAVAS_FAIXAS_INODES]);
+}
+
+/**
+ * @brief Adquire a trava de um diretório para escrita (inclusão e remoção de entradas).
+ */
+void trava_diretorio_escrever(uint32_t inode_num) {
+    if (travas_prontas) pthread_rwlock_wrlock(&travas_diretorios[inode_num % TRAVAS_FAIXAS_INODES]);
+}
+
+/**
+ * @brief Libera a trava de um diretório, adquirida para leitura ou escrita.
+ */
+void trava_diretorio_liberar(uint32_t inode_num) {
+    if (travas_prontas) pthread_rwlock_unlock(&travas_diretorios[inode_num % TRAVAS_FAIXAS_INODES]);
+}
@@ -0,0 +1,67 @@
+/**
+ * @file       travas.h
+ * @brief      Declaração do modelo de concorrência do núcleo: travas por grupo, por inode e por diretório.
+ *
+ *  @author     Allan Custódio Diniz Marques (L33tSh4rk)
+ *
+ * As funções de systemOp.c podem ser chamadas por várias threads ao mesmo tempo
+ * (ex: os trabalhadores do percurso paralelo de diretórios). Cada tipo de estado
+ * compartilhado tem a sua trava:
+ *
+ *   - grupo de blocos: bitmaps, contadores do descritor e os blocos da tabela de
+ *     inodes do grupo (alterados por leitura-modificação-escrita);
+ *   - superbloco: contadores globais de livres e as marcações de metadados sujos;
+ *   - inode: o mapa de blocos de um inode enquanto ele é alterado e a gravação do
+ *     inode (faixas de travas recursivas, indexadas pelo número do inode);
+ *   - diretório: leitura/escrita (rwlock) das entradas de um diretório, também em
+ *     faixas indexadas pelo número do inode.
+ *
+ * Os caches (cache.c), o pool de buffers e o anel do io_uring têm travas internas.
+ *
+ * Ordem de aquisição, para não haver impasse: inode -> diretório -> cache de inodes
+ * -> grupos (em ordem crescente) -> superbloco -> caches de bitmaps e de nomes ->
+ * cache de blocos -> pool de buffers -> anel do io_uring. Quem altera um diretório
+ * em vários passos (ler o inode pai, incluir a entrada, gravá-lo) segura a trava do
+ * inode pai durante toda a sequência; por ser recursiva, as funções chamadas
+ * podem adquiri-la de novo.
+ *
+ * Data de criação: 16 de outubro de 2026
+ * Data de atualização: 16 de outubro de 2026
+ *
+ */
+
+#ifndef EXT2_TRAVAS_H
+#define EXT2_TRAVAS_H
+
+#include <stdint.h>
+
+// Faixas de travas de inodes e de diretórios (inodes com o mesmo resto dividem a trava).
+#define TRAVAS_FAIXAS_INODES 256
+
+/* Ciclo de vida */
+int travas_inicializar(uint32_t num_grupos);
+void travas_finalizar(void);
+
+/* Grupos de blocos e superbloco */
+void trava_grupo_adquirir(uint32_t grupo);
+void trava_grupo_liberar(uint32_t grupo);
+void trava_todos_grupos_adquirir(void);
+void trava_todos_grupos_liberar(void);
+void trava_superbloco_adquirir(void);
+void trava_superbloco_liberar(void);
+
+/* Inodes e diretórios */
+void trava_inode_adquirir(uint32_t inode_num);
+void trava_inode_liberar(uint32_t inode_num);
+void trava_diretorio_ler(uint32_t inode_num);
+void trava_diretorio_escrever(uint32_t inode_num);
+void trava_diretorio_liberar(uint32_t inode_num);
+
+/**
+ * @brief Soma `valor` a um contador de estatísticas compartilhado entre threads.
+ */
+static inline void contador_somar(uint64_t* contador, uint64_t valor) {
+    __atomic_fetch_add(contador, valor, __ATOMIC_RELAXED);
+}
+
+#endif // EXT2_TRAVAS_H